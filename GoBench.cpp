@@ -0,0 +1,356 @@
+// GoBench.cpp : Headless benchmark for the rules engines.
+//
+// Usage: GoBench [games] [seed]
+//
+// Plays a set of random games once to record their move sequences, then
+// replays every sequence through each board layout (one PlaceStone call,
+// which checks and plays the move, per move) and reports moves per
+// second. Undo is timed the same way by taking every game back to the
+// empty board. The layouts
+// are also checked against each other: legality of every move, the final
+// board, the capture counts and the legality of every point at the end of
+// each game must agree.
+//
+// The area scorers of both layouts are checked against each other and
+// timed on the final positions. Finally the bulk legal-move generators are
+// timed on the position half way through every game and checked against
+// point-by-point legality.
+//
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "GoBitPosition.h"
+#include "GoBoard.h"
+#include "GoPosition.h"
+#include "GoScore.h"
+
+typedef std::vector<std::pair<int, int>> MoveSequence;
+
+// Small xorshift generator; the benchmark only needs repeatable games
+static uint64_t NextRandom(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// A point whose neighbours are all the player's stones (or the edge)
+static bool IsOwnEye(const GoPosition& position, int x, int y, Stone player)
+{
+    const int dx[4] = { -1, 1, 0, 0 };
+    const int dy[4] = { 0, 0, -1, 1 };
+    for (int i = 0; i < 4; ++i)
+    {
+        int adjX = x + dx[i];
+        int adjY = y + dy[i];
+        if (adjX >= 0 && adjX < GoPosition::SIZE && adjY >= 0 && adjY < GoPosition::SIZE && position.At(adjX, adjY) != player)
+            return false;
+    }
+    return true;
+}
+
+// Function to record one random game, stopping when neither side has a
+// move left that does not fill its own eye
+static MoveSequence RecordRandomGame(uint64_t& rng)
+{
+    MoveSequence moves;
+    GoPosition position;
+    int passes = 0;
+    while (passes < 2 && moves.size() < 3 * GoPosition::SIZE * GoPosition::SIZE)
+    {
+        std::vector<int> candidates;
+        for (int i = 0; i < GoPosition::SIZE * GoPosition::SIZE; ++i)
+            if (position.At(i % GoPosition::SIZE, i / GoPosition::SIZE) == EMPTY)
+                candidates.push_back(i);
+
+        bool played = false;
+        while (!candidates.empty())
+        {
+            size_t pick = NextRandom(rng) % candidates.size();
+            int x = candidates[pick] % GoPosition::SIZE;
+            int y = candidates[pick] / GoPosition::SIZE;
+            candidates[pick] = candidates.back();
+            candidates.pop_back();
+
+            if (!IsOwnEye(position, x, y, position.CurrentPlayer()) && position.PlaceStone(x, y))
+            {
+                moves.push_back({ x, y });
+                played = true;
+                break;
+            }
+        }
+
+        if (played)
+        {
+            passes = 0;
+        }
+        else
+        {
+            position.Pass();
+            moves.push_back({ -1, -1 });
+            passes += 1;
+        }
+    }
+    return moves;
+}
+
+// Function to replay every game and time it; returns the number of moves
+template <class Board>
+static long long ReplayGames(const std::vector<MoveSequence>& games, std::vector<Board>& finals, double& seconds)
+{
+    long long moves = 0;
+    finals.clear();
+    finals.reserve(games.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (const MoveSequence& game : games)
+    {
+        Board board;
+        for (const auto& move : game)
+        {
+            if (move.first < 0)
+                board.Pass();
+            else if (!board.PlaceStone(move.first, move.second))
+                board.TogglePlayer(); // never happens while the layouts agree
+            moves += 1;
+        }
+        finals.push_back(board);
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return moves;
+}
+
+// Function to take every game back to the start and time it
+template <class Board>
+static double UndoGames(std::vector<Board>& finals)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (Board& board : finals)
+        while (board.Undo())
+            ;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to check that taking a game back restored the empty board
+template <class Board>
+static bool AllEmpty(const std::vector<Board>& boards)
+{
+    for (const Board& board : boards)
+    {
+        if (board.Hash() != 0 || board.CurrentPlayer() != BLACK || board.BlackScore() != 0 || board.WhiteScore() != 0)
+            return false;
+        for (int x = 0; x < GoPosition::SIZE; ++x)
+            for (int y = 0; y < GoPosition::SIZE; ++y)
+                if (board.At(x, y) != EMPTY)
+                    return false;
+    }
+    return true;
+}
+
+// Function to compare the final positions of both layouts
+static bool SameResults(const std::vector<GoPosition>& arrays, const std::vector<GoBitPosition>& bitboards)
+{
+    for (size_t game = 0; game < arrays.size(); ++game)
+    {
+        const GoPosition& a = arrays[game];
+        const GoBitPosition& b = bitboards[game];
+        if (a.BlackScore() != b.BlackScore() || a.WhiteScore() != b.WhiteScore() ||
+            a.CurrentPlayer() != b.CurrentPlayer())
+        {
+            std::printf("game %zu: scores or player to move differ\n", game);
+            return false;
+        }
+        for (int x = 0; x < GoPosition::SIZE; ++x)
+        {
+            for (int y = 0; y < GoPosition::SIZE; ++y)
+            {
+                if (a.At(x, y) != b.At(x, y) || a.IsValidMove(x, y) != b.IsValidMove(x, y) ||
+                    a.CountLiberties(x, y) != b.CountLiberties(x, y))
+                {
+                    std::printf("game %zu: layouts differ at (%d, %d)\n", game, x, y);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Function to time area scoring; returns nanoseconds per position
+template <class Board>
+static double TimeScoring(const std::vector<Board>& boards, double& checksum)
+{
+    const int rounds = 50;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round)
+        for (const Board& board : boards)
+            checksum += ScoreArea(board, 7.5).Margin();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return 1e9 * seconds / (rounds * boards.size());
+}
+
+// Function to play the first half of every game
+template <class Board>
+static std::vector<Board> MiddleGames(const std::vector<MoveSequence>& games)
+{
+    std::vector<Board> boards(games.size());
+    for (size_t game = 0; game < games.size(); ++game)
+    {
+        for (size_t i = 0; i < games[game].size() / 2; ++i)
+        {
+            const auto& move = games[game][i];
+            if (move.first < 0)
+                boards[game].Pass();
+            else
+                boards[game].PlaceStone(move.first, move.second);
+        }
+    }
+    return boards;
+}
+
+// Function to check every generator against point-by-point legality
+static bool SameLegalMoves(const std::vector<GoPosition>& arrays, const std::vector<GoBitPosition>& bitboards)
+{
+    for (size_t game = 0; game < arrays.size(); ++game)
+    {
+        const GoPosition& a = arrays[game];
+        for (int skipOwnEyes = 0; skipOwnEyes < 2; ++skipOwnEyes)
+        {
+            GoBitboard expected = GoBitboard::Empty();
+            for (int x = 0; x < GoPosition::SIZE; ++x)
+            {
+                for (int y = 0; y < GoPosition::SIZE; ++y)
+                {
+                    int point = GoPosition::Point(x, y);
+                    if (a.IsLegalMove(point) && !(skipOwnEyes && a.IsTrueEye(point, a.CurrentPlayer())))
+                        expected.Set(GoBitboard::Bit(x, y));
+                }
+            }
+
+            GoMoveList list;
+            a.GenerateLegalMoves(list, skipOwnEyes != 0);
+            GoBitboard listed = GoBitboard::Empty();
+            for (int i = 0; i < list.count; ++i)
+                listed.Set(GoBitboard::Bit(GoPosition::PointX(list.moves[i]), GoPosition::PointY(list.moves[i])));
+
+            if (listed != expected || listed.Count() != list.count || a.LegalMoveMask(skipOwnEyes != 0) != expected ||
+                bitboards[game].LegalMoves(skipOwnEyes != 0) != expected)
+            {
+                std::printf("game %zu: legal move generators differ\n", game);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Function to time repeated legal-move sweeps; returns sweeps per second.
+// Each position is swept several times in a row, as a search would.
+template <class Board, class Generate>
+static double TimeSweeps(const std::vector<Board>& boards, Generate generate)
+{
+    const int rounds = 20;
+    long long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Board& board : boards)
+        for (int round = 0; round < rounds; ++round)
+            total += generate(board);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (total < 0)
+        std::printf("\n"); // keeps the sweeps from being optimized away
+    return rounds * boards.size() / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    int gameCount = argc > 1 ? std::atoi(argv[1]) : 200;
+    uint64_t rng = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20241017;
+    if (gameCount <= 0 || rng == 0)
+    {
+        std::fprintf(stderr, "usage: GoBench [games > 0] [seed > 0]\n");
+        return 2;
+    }
+
+    std::vector<MoveSequence> games;
+    for (int i = 0; i < gameCount; ++i)
+        games.push_back(RecordRandomGame(rng));
+
+    std::vector<GoPosition> arrayFinals;
+    std::vector<GoBitPosition> bitboardFinals;
+    double arraySeconds = 0;
+    double bitboardSeconds = 0;
+    long long moves = ReplayGames(games, arrayFinals, arraySeconds);
+    ReplayGames(games, bitboardFinals, bitboardSeconds);
+
+    std::printf("%d random %dx%d games, %lld moves\n", gameCount, GoPosition::SIZE, GoPosition::SIZE, moves);
+    std::printf("GoBoard is built as the %s layout\n", std::is_same<GoBoard, GoBitPosition>::value ? "bitboard" : "array");
+    if (!SameResults(arrayFinals, bitboardFinals))
+        return 1;
+
+    for (size_t game = 0; game < arrayFinals.size(); ++game)
+    {
+        GoAreaScore a = ScoreArea(arrayFinals[game], 7.5);
+        GoAreaScore b = ScoreArea(bitboardFinals[game], 7.5);
+        if (a.blackArea != b.blackArea || a.whiteArea != b.whiteArea)
+        {
+            std::printf("game %zu: area scores differ\n", game);
+            return 1;
+        }
+    }
+    double arrayChecksum = 0;
+    double bitboardChecksum = 0;
+    double arrayScoreNs = TimeScoring(arrayFinals, arrayChecksum);
+    double bitboardScoreNs = TimeScoring(bitboardFinals, bitboardChecksum);
+
+    double arrayUndoSeconds = UndoGames(arrayFinals);
+    double bitboardUndoSeconds = UndoGames(bitboardFinals);
+
+    std::printf("%-10s %12s %14s %14s %12s\n", "layout", "seconds", "moves/sec", "undos/sec", "ns/score");
+    std::printf("%-10s %12.4f %14.0f %14.0f %12.1f\n", "array", arraySeconds, moves / arraySeconds,
+        moves / arrayUndoSeconds, arrayScoreNs);
+    std::printf("%-10s %12.4f %14.0f %14.0f %12.1f\n", "bitboard", bitboardSeconds, moves / bitboardSeconds,
+        moves / bitboardUndoSeconds, bitboardScoreNs);
+    if (arrayChecksum != bitboardChecksum)
+        return 1;
+
+    if (!AllEmpty(arrayFinals) || !AllEmpty(bitboardFinals))
+    {
+        std::printf("undo did not restore the empty board\n");
+        return 1;
+    }
+
+    std::vector<GoPosition> arrayMiddles = MiddleGames<GoPosition>(games);
+    std::vector<GoBitPosition> bitboardMiddles = MiddleGames<GoBitPosition>(games);
+    if (!SameLegalMoves(arrayMiddles, bitboardMiddles))
+        return 1;
+
+    double perPoint = TimeSweeps(arrayMiddles, [](const GoPosition& board) {
+        int count = 0;
+        for (int x = 0; x < GoPosition::SIZE; ++x)
+            for (int y = 0; y < GoPosition::SIZE; ++y)
+                count += board.IsValidMove(x, y);
+        return count;
+    });
+    double arrayList = TimeSweeps(arrayMiddles, [](const GoPosition& board) {
+        GoMoveList list;
+        board.GenerateLegalMoves(list, true);
+        return list.count;
+    });
+    double bitboardMask = TimeSweeps(bitboardMiddles, [](const GoBitPosition& board) {
+        return board.LegalMoves(true).Count();
+    });
+
+    std::printf("%-22s %14s\n", "legal moves", "sweeps/sec");
+    std::printf("%-22s %14.0f\n", "array, point by point", perPoint);
+    std::printf("%-22s %14.0f\n", "array, move list", arrayList);
+    std::printf("%-22s %14.0f\n", "bitboard, mask", bitboardMask);
+
+    std::printf("layouts agree on all %d games\n", gameCount);
+    return 0;
+}
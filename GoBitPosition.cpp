@@ -0,0 +1,377 @@
+// GoBitPosition.cpp : Implements the bitboard Go rules engine.
+//
+#include "GoBitPosition.h"
+
+#include "GoMetrics.h"
+
+// Bit offsets of the four neighbours of a point
+template <int N>
+static const int BIT_OFFSETS[4] = { -1, 1, -GoBitboardT<N>::STRIDE, GoBitboardT<N>::STRIDE };
+
+// Zobrist key of a stone on a bit, using GoPosition's point numbering
+template <int N>
+static uint64_t BitKey(Stone player, int bit)
+{
+    int point = GoGeometry<N>::Point(GoBitboardT<N>::BitX(bit), GoBitboardT<N>::BitY(bit));
+    return ZobristStone(player, point);
+}
+
+template <int N>
+GoBitPositionT<N>::GoBitPositionT(KoRule rule)
+    : koRule(rule)
+{
+    Reset();
+}
+
+// Function to reset the game board and scores
+template <int N>
+void GoBitPositionT<N>::Reset()
+{
+    state.stones[0] = GoBitboardT<N>::Empty();
+    state.stones[1] = GoBitboardT<N>::Empty();
+    state.empty = GoBitboardT<N>::BoardMask();
+    state.blackScore = 0;
+    state.whiteScore = 0;
+    state.hash = 0;
+    state.koBit = -1;
+
+    currentPlayer = BLACK;
+    consecutivePasses = 0;
+
+    frames.clear();
+    history.Clear();
+    RecordPosition();
+}
+
+template <int N>
+void GoBitPositionT<N>::SetKoRule(KoRule rule)
+{
+    koRule = rule;
+    Reset();
+}
+
+template <int N>
+Stone GoBitPositionT<N>::At(int x, int y) const
+{
+    int bit = GoBitboardT<N>::Bit(x, y);
+    if (state.stones[0].Test(bit))
+        return BLACK;
+    if (state.stones[1].Test(bit))
+        return WHITE;
+    return EMPTY;
+}
+
+template <int N>
+int GoBitPositionT<N>::KoPoint() const
+{
+    if (state.koBit < 0)
+        return 0;
+    return GoGeometry<N>::Point(GoBitboardT<N>::BitX(state.koBit), GoBitboardT<N>::BitY(state.koBit));
+}
+
+// Padding bits are never in the empty set, so only the first and last
+// rows need a range check
+template <int N>
+bool GoBitPositionT<N>::HasEmptyNeighbor(const State& board, int bit) const
+{
+    for (int offset : BIT_OFFSETS<N>)
+    {
+        int adj = bit + offset;
+        if (adj >= 0 && adj < GoBitboardT<N>::BITS && board.empty.Test(adj))
+            return true;
+    }
+    return false;
+}
+
+// Function to toggle the current player
+template <int N>
+void GoBitPositionT<N>::TogglePlayer()
+{
+    PushFrame();
+    HandOver();
+}
+
+// Function to handle passing the turn
+template <int N>
+void GoBitPositionT<N>::Pass()
+{
+    PushFrame();
+    consecutivePasses += 1;
+    HandOver();
+}
+
+// Function to give the move to the other player without placing a stone
+template <int N>
+void GoBitPositionT<N>::HandOver()
+{
+    currentPlayer = Opponent(currentPlayer);
+    state.hash ^= ZOBRIST.whiteToMove;
+    state.koBit = -1;
+    RecordPosition();
+}
+
+// Function to save the current state before a change of position
+template <int N>
+void GoBitPositionT<N>::PushFrame()
+{
+    UndoFrame frame;
+    frame.state = state;
+    frame.player = currentPlayer;
+    frame.consecutivePasses = consecutivePasses;
+    frame.recorded = false;
+    frames.push_back(frame);
+}
+
+// Function to take back the last move, pass or turn skip
+template <int N>
+bool GoBitPositionT<N>::Undo()
+{
+    if (frames.empty())
+        return false;
+
+    const UndoFrame& frame = frames.back();
+    if (frame.recorded)
+        history.Remove(koRule == KO_SITUATIONAL_SUPERKO ? state.hash : PositionHash());
+
+    state = frame.state;
+    currentPlayer = frame.player;
+    consecutivePasses = frame.consecutivePasses;
+    frames.pop_back();
+    return true;
+}
+
+// Function to remember the current position for the superko check
+template <int N>
+void GoBitPositionT<N>::RecordPosition()
+{
+    bool inserted = false;
+    if (koRule == KO_POSITIONAL_SUPERKO)
+        inserted = history.Insert(PositionHash());
+    else if (koRule == KO_SITUATIONAL_SUPERKO)
+        inserted = history.Insert(state.hash);
+
+    if (!frames.empty())
+        frames.back().recorded = inserted;
+}
+
+// Function to play the current player's stone on a copy of the state.
+// Returns false if the move is illegal, in which case next is garbage.
+template <int N>
+bool GoBitPositionT<N>::PlayOn(State& next, int bit) const
+{
+    if (!next.empty.Test(bit) || bit == next.koBit)
+        return false;
+
+    Stone opponent = Opponent(currentPlayer);
+    GoBitboardT<N>& own = next.stones[currentPlayer == WHITE];
+    GoBitboardT<N>& enemy = next.stones[opponent == WHITE];
+    GoBitboardT<N> stone = GoBitboardT<N>::Single(bit);
+
+    own |= stone;
+    next.empty = next.empty.AndNot(stone);
+    next.hash ^= BitKey<N>(currentPlayer, bit) ^ ZOBRIST.whiteToMove;
+
+    // Check all adjacent positions for opponent groups without liberties
+    int capturedStones = 0;
+    int capturedBit = -1;
+    for (int offset : BIT_OFFSETS<N>)
+    {
+        int adj = bit + offset;
+        if (adj < 0 || adj >= GoBitboardT<N>::BITS || !enemy.Test(adj))
+            continue;
+
+        // A stone with a free neighbour keeps its group alive
+        if (HasEmptyNeighbor(next, adj))
+            continue;
+
+        GO_METRIC_ADD(METRIC_FLOOD_FILLS, 1);
+        GoBitboardT<N> group = GoBitboardT<N>::Single(adj).FloodFill(enemy);
+        if ((group.Dilate() & next.empty).Any())
+            continue;
+
+        // Capture the stones
+        enemy = enemy.AndNot(group);
+        next.empty |= group;
+        group.ForEach([&](int captured) { next.hash ^= BitKey<N>(opponent, captured); });
+        capturedStones += group.Count();
+        capturedBit = adj;
+    }
+
+    if (currentPlayer == BLACK)
+        next.blackScore += capturedStones;
+    else
+        next.whiteScore += capturedStones;
+
+    // Check if the placed stone has any liberties
+    if (capturedStones == 0 && !HasEmptyNeighbor(next, bit))
+    {
+        GO_METRIC_ADD(METRIC_FLOOD_FILLS, 1);
+        GoBitboardT<N> group = stone.FloodFill(own);
+        if (!(group.Neighbors() & next.empty).Any()) // Suicide move
+            return false;
+    }
+
+    // Taking a single stone with a lone stone that is left in atari sets up a ko
+    next.koBit = -1;
+    if (capturedStones == 1)
+    {
+        int ownNeighbors = 0;
+        int emptyNeighbors = 0;
+        for (int offset : BIT_OFFSETS<N>)
+        {
+            int adj = bit + offset;
+            if (adj < 0 || adj >= GoBitboardT<N>::BITS)
+                continue;
+            ownNeighbors += own.Test(adj);
+            emptyNeighbors += next.empty.Test(adj);
+        }
+        if (ownNeighbors == 0 && emptyNeighbors == 1)
+            next.koBit = capturedBit;
+    }
+
+    if (koRule == KO_POSITIONAL_SUPERKO)
+        return !history.Contains(opponent == WHITE ? next.hash ^ ZOBRIST.whiteToMove : next.hash);
+    if (koRule == KO_SITUATIONAL_SUPERKO)
+        return !history.Contains(next.hash);
+    return true;
+}
+
+// Function to place a stone on the board
+template <int N>
+bool GoBitPositionT<N>::PlaceStone(int x, int y)
+{
+    GO_METRIC_TIME(TIMER_PLAY);
+    State next = state;
+    if (!PlayOn(next, GoBitboardT<N>::Bit(x, y)))
+        return false;
+    GO_METRIC_ADD(METRIC_STONES_PLAYED, 1);
+    GO_METRIC_ADD(METRIC_CAPTURED_STONES,
+        next.blackScore + next.whiteScore - state.blackScore - state.whiteScore);
+
+    PushFrame();
+    state = next;
+    consecutivePasses = 0; // Reset pass count after a valid move
+
+    // Toggle to the next player; the hash already has the new side to move
+    currentPlayer = Opponent(currentPlayer);
+    RecordPosition();
+
+    return true;
+}
+
+// Function to check if a move is valid
+template <int N>
+bool GoBitPositionT<N>::IsValidMove(int x, int y) const
+{
+    GO_METRIC_TIME(TIMER_LEGALITY);
+    int bit = GoBitboardT<N>::Bit(x, y);
+    if (!state.empty.Test(bit) || bit == state.koBit)
+        return false;
+
+    // A free neighbour is a liberty; under simple ko no flood fill is needed
+    if (koRule == KO_SIMPLE && HasEmptyNeighbor(state, bit))
+        return true;
+
+    State next = state;
+    return PlayOn(next, bit);
+}
+
+// Function to count liberties of the group at (x, y)
+template <int N>
+int GoBitPositionT<N>::CountLiberties(int x, int y) const
+{
+    Stone player = At(x, y);
+    if (player == EMPTY)
+        return 0;
+
+    GoBitboardT<N> group = GoBitboardT<N>::Single(GoBitboardT<N>::Bit(x, y)).FloodFill(Stones(player));
+    GO_METRIC_ADD(METRIC_LIBERTY_COUNTS, 1);
+    GO_METRIC_ADD(METRIC_FLOOD_FILLS, 1);
+    GO_METRIC_ADD(METRIC_LIBERTY_STONES, group.Count());
+    return (group.Neighbors() & state.empty).Count();
+}
+
+// Function to list all legal moves as a bitmask
+template <int N>
+GoBitboardT<N> GoBitPositionT<N>::LegalMoves(bool skipOwnEyes) const
+{
+    const GoBitboardT<N>& empty = state.empty;
+    const GoBitboardT<N>& enemy = state.stones[currentPlayer != WHITE];
+
+    // Padding and out-of-range bits are never empty, so the shifted sets
+    // need no masking before the final AND
+    GoBitboardT<N> emptyNeighbor = empty.ShiftUp(1) | empty.ShiftDown(1) |
+        empty.ShiftUp(GoBitboardT<N>::STRIDE) | empty.ShiftDown(GoBitboardT<N>::STRIDE);
+    GoBitboardT<N> open = empty & emptyNeighbor;
+    GoBitboardT<N> enclosed = empty.AndNot(open);
+
+    GoBitboardT<N> legal = GoBitboardT<N>::Empty();
+    if (koRule == KO_SIMPLE)
+    {
+        legal = open;
+    }
+    else
+    {
+        // Without an enemy neighbour the move cannot capture, so its hash
+        // is a single XOR away; the rest are played out on a copy
+        GoBitboardT<N> quiet = open.AndNot(enemy.Dilate());
+        uint64_t sideKey = (koRule == KO_SITUATIONAL_SUPERKO || currentPlayer == WHITE) ? ZOBRIST.whiteToMove : 0;
+        quiet.ForEach([&](int bit) {
+            if (!history.Contains(state.hash ^ BitKey<N>(currentPlayer, bit) ^ sideKey))
+                legal.Set(bit);
+        });
+        enclosed |= open.AndNot(quiet);
+    }
+
+    enclosed.ForEach([&](int bit) {
+        if (skipOwnEyes && IsTrueEye(bit))
+            return;
+        State next = state;
+        if (PlayOn(next, bit))
+            legal.Set(bit);
+    });
+
+    if (state.koBit >= 0)
+        legal.Clear(state.koBit);
+    return legal;
+}
+
+// An empty point surrounded by the current player's stones whose
+// diagonals the opponent does not control
+template <int N>
+bool GoBitPositionT<N>::IsTrueEye(int bit) const
+{
+    const GoBitboardT<N>& own = state.stones[currentPlayer == WHITE];
+    const GoBitboardT<N>& enemy = state.stones[currentPlayer != WHITE];
+    int x = GoBitboardT<N>::BitX(bit);
+    int y = GoBitboardT<N>::BitY(bit);
+
+    for (int offset : BIT_OFFSETS<N>)
+    {
+        int adj = bit + offset;
+        int adjX = GoBitboardT<N>::BitX(adj);
+        bool onBoard = adj >= 0 && adj < GoBitboardT<N>::BITS && adjX < N;
+        if (onBoard && !own.Test(adj))
+            return false;
+    }
+
+    int enemyDiagonals = 0;
+    int edge = 0;
+    for (int dy = -1; dy <= 1; dy += 2)
+    {
+        for (int dx = -1; dx <= 1; dx += 2)
+        {
+            int diagX = x + dx;
+            int diagY = y + dy;
+            if (diagX < 0 || diagX >= N || diagY < 0 || diagY >= N)
+                edge = 1;
+            else if (enemy.Test(GoBitboardT<N>::Bit(diagX, diagY)))
+                enemyDiagonals += 1;
+        }
+    }
+    return enemyDiagonals + edge < 2;
+}
+
+template class GoBitPositionT<9>;
+template class GoBitPositionT<13>;
+template class GoBitPositionT<19>;
@@ -0,0 +1,125 @@
+// GoBitPosition.h : Go rules engine on bitboards.
+//
+// Same rules and the same basic interface as GoPosition, but the board is
+// three GoBitboardT<N> sets (black, white, empty) instead of a per-point array.
+// Groups, liberties and captures are computed with shift-and-mask flood
+// fills on the whole set at once. Moves are played copy-make: the board
+// state is a couple of hundred bytes, so a move is tried on a copy and
+// only committed if it turns out legal, and the replaced state is kept
+// on a stack for Undo().
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GoBitboard.h"
+#include "GoZobrist.h"
+
+template <int N>
+class GoBitPositionT
+{
+public:
+    explicit GoBitPositionT(KoRule rule = KO_POSITIONAL_SUPERKO);
+
+    // Clear the board, scores, pass count and history; Black to move
+    void Reset();
+
+    // Switch repetition rule; resets the position
+    void SetKoRule(KoRule rule);
+    KoRule GetKoRule() const { return koRule; }
+
+    // Stone at column x, row y
+    Stone At(int x, int y) const;
+
+    Stone CurrentPlayer() const { return currentPlayer; }
+
+    // Number of stones captured by each player
+    int BlackScore() const { return state.blackScore; }
+    int WhiteScore() const { return state.whiteScore; }
+
+    // Zobrist hashes, identical to GoPosition's for the same position
+    uint64_t Hash() const { return state.hash; }
+    uint64_t PositionHash() const { return currentPlayer == WHITE ? state.hash ^ ZOBRIST.whiteToMove : state.hash; }
+
+    // Simple ko point as a GoPosition point index, or 0 when there is none
+    int KoPoint() const;
+
+    int ConsecutivePasses() const { return consecutivePasses; }
+    bool IsGameOver() const { return consecutivePasses >= 2; }
+
+    // Check whether the current player may play at (x, y)
+    bool IsValidMove(int x, int y) const;
+
+    // Play the current player's stone at (x, y), capture and hand the turn
+    // over. Returns false and leaves the position unchanged if the move is
+    // illegal.
+    bool PlaceStone(int x, int y);
+
+    // Take back the last move, pass or turn skip; false if there is none
+    bool Undo();
+    bool CanUndo() const { return !frames.empty(); }
+
+    // Pass the turn to the other player
+    void Pass();
+
+    // Hand the turn over without playing or counting a pass
+    void TogglePlayer();
+
+    // Count the distinct liberties of the group containing (x, y)
+    int CountLiberties(int x, int y) const;
+
+    // Every legal point for the current player as a bitmask. Empty points
+    // with an empty neighbour are found for the whole board with four
+    // shifts; only the remaining, enclosed points are tried one by one.
+    // With skipOwnEyes, true eyes of the current player are left out.
+    GoBitboardT<N> LegalMoves(bool skipOwnEyes = false) const;
+
+    // Stone sets, indexed by BLACK or WHITE, and the empty points
+    const GoBitboardT<N>& Stones(Stone player) const { return state.stones[player == WHITE]; }
+    const GoBitboardT<N>& EmptyPoints() const { return state.empty; }
+
+private:
+    // Everything a move changes
+    struct State
+    {
+        GoBitboardT<N> stones[2];
+        GoBitboardT<N> empty;
+        int blackScore;
+        int whiteScore;
+        uint64_t hash;      // includes the side to move
+        int koBit;          // simple ko point for the player to move, -1 if none
+    };
+
+    // State before a move, restored by Undo
+    struct UndoFrame
+    {
+        State state;
+        Stone player;
+        int consecutivePasses;
+        bool recorded;      // the move added its position to the history
+    };
+
+    bool PlayOn(State& next, int bit) const;
+    bool HasEmptyNeighbor(const State& board, int bit) const;
+    bool IsTrueEye(int bit) const;
+    void PushFrame();
+    void HandOver();
+    void RecordPosition();
+
+    State state;
+
+    // Current player
+    Stone currentPlayer;
+
+    // Counter to track consecutive passes
+    int consecutivePasses;
+
+    // Repetition rule and the hashes of earlier positions under superko
+    KoRule koRule;
+    GoHashHistory history;
+
+    std::vector<UndoFrame> frames;
+};
+
+typedef GoBitPositionT<19> GoBitPosition;
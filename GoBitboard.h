@@ -0,0 +1,249 @@
+// GoBitboard.h : Set of board points packed into machine words.
+//
+// Rows are stored one after another with a stride of N + 1 bits;
+// the extra bit at the end of every row is a padding column that is never
+// part of the board. Shifting by one bit moves a point sideways and
+// shifting by a whole stride moves it up or down, so neighbour sets,
+// group extraction and liberty sets are a few word-wide shifts and masks.
+// Anything that spills into the padding column or past the last row is
+// cut off again with BoardMask().
+//
+// All operations are fixed-length loops over WORDS words, which the
+// compiler unrolls and vectorizes.
+//
+#pragma once
+
+#include <cstdint>
+
+#include "GoTypes.h"
+
+template <int N>
+struct GoBitboardT
+{
+    static const int SIZE = N;
+    static const int STRIDE = N + 1;
+    static const int BITS = STRIDE * N;
+    static const int WORDS = (BITS + 63) / 64;
+
+    uint64_t words[WORDS];
+
+    // Bit index of column x, row y
+    static int Bit(int x, int y) { return y * STRIDE + x; }
+    static int BitX(int bit) { return bit % STRIDE; }
+    static int BitY(int bit) { return bit / STRIDE; }
+
+    static GoBitboardT Empty()
+    {
+        GoBitboardT result;
+        for (int i = 0; i < WORDS; ++i)
+            result.words[i] = 0;
+        return result;
+    }
+
+    // All on-board points
+    static const GoBitboardT& BoardMask();
+
+    static GoBitboardT Single(int bit)
+    {
+        GoBitboardT result = Empty();
+        result.Set(bit);
+        return result;
+    }
+
+    bool Test(int bit) const { return (words[bit >> 6] >> (bit & 63)) & 1; }
+    void Set(int bit) { words[bit >> 6] |= uint64_t(1) << (bit & 63); }
+    void Clear(int bit) { words[bit >> 6] &= ~(uint64_t(1) << (bit & 63)); }
+
+    bool Any() const
+    {
+        uint64_t any = 0;
+        for (int i = 0; i < WORDS; ++i)
+            any |= words[i];
+        return any != 0;
+    }
+
+    int Count() const
+    {
+        int count = 0;
+        for (int i = 0; i < WORDS; ++i)
+            count += PopCount(words[i]);
+        return count;
+    }
+
+    // Lowest set bit, or -1 when the set is empty
+    int First() const
+    {
+        for (int i = 0; i < WORDS; ++i)
+            if (words[i])
+                return i * 64 + TrailingZeros(words[i]);
+        return -1;
+    }
+
+    // Function to call f(bit) for every bit in the set, lowest first
+    template <class Function>
+    void ForEach(Function f) const
+    {
+        for (int i = 0; i < WORDS; ++i)
+            for (uint64_t word = words[i]; word; word &= word - 1)
+                f(i * 64 + TrailingZeros(word));
+    }
+
+    // Move every bit up by n positions (towards higher indices)
+    GoBitboardT ShiftUp(int n) const
+    {
+        GoBitboardT result;
+        int wordShift = n >> 6;
+        int bitShift = n & 63;
+        for (int i = WORDS - 1; i >= 0; --i)
+        {
+            int source = i - wordShift;
+            uint64_t word = source >= 0 ? words[source] << bitShift : 0;
+            if (bitShift && source >= 1)
+                word |= words[source - 1] >> (64 - bitShift);
+            result.words[i] = word;
+        }
+        return result;
+    }
+
+    // Move every bit down by n positions (towards lower indices)
+    GoBitboardT ShiftDown(int n) const
+    {
+        GoBitboardT result;
+        int wordShift = n >> 6;
+        int bitShift = n & 63;
+        for (int i = 0; i < WORDS; ++i)
+        {
+            int source = i + wordShift;
+            uint64_t word = source < WORDS ? words[source] >> bitShift : 0;
+            if (bitShift && source + 1 < WORDS)
+                word |= words[source + 1] << (64 - bitShift);
+            result.words[i] = word;
+        }
+        return result;
+    }
+
+    // This set plus every on-board point next to it
+    GoBitboardT Dilate() const
+    {
+        GoBitboardT result = *this | ShiftUp(1) | ShiftDown(1) | ShiftUp(STRIDE) | ShiftDown(STRIDE);
+        return result & BoardMask();
+    }
+
+    // On-board points next to this set but not in it
+    GoBitboardT Neighbors() const
+    {
+        return Dilate().AndNot(*this);
+    }
+
+    // Grow this set through the points of mask until it stops changing;
+    // starting from one stone and the stones of its colour this yields
+    // the stone's whole group
+    GoBitboardT FloodFill(const GoBitboardT& mask) const
+    {
+        GoBitboardT current = *this & mask;
+        for (;;)
+        {
+            GoBitboardT next = current.Dilate() & mask;
+            if (next == current)
+                return current;
+            current = next;
+        }
+    }
+
+    GoBitboardT AndNot(const GoBitboardT& other) const
+    {
+        GoBitboardT result;
+        for (int i = 0; i < WORDS; ++i)
+            result.words[i] = words[i] & ~other.words[i];
+        return result;
+    }
+
+    GoBitboardT operator&(const GoBitboardT& other) const
+    {
+        GoBitboardT result;
+        for (int i = 0; i < WORDS; ++i)
+            result.words[i] = words[i] & other.words[i];
+        return result;
+    }
+
+    GoBitboardT operator|(const GoBitboardT& other) const
+    {
+        GoBitboardT result;
+        for (int i = 0; i < WORDS; ++i)
+            result.words[i] = words[i] | other.words[i];
+        return result;
+    }
+
+    GoBitboardT operator^(const GoBitboardT& other) const
+    {
+        GoBitboardT result;
+        for (int i = 0; i < WORDS; ++i)
+            result.words[i] = words[i] ^ other.words[i];
+        return result;
+    }
+
+    GoBitboardT& operator&=(const GoBitboardT& other) { return *this = *this & other; }
+    GoBitboardT& operator|=(const GoBitboardT& other) { return *this = *this | other; }
+    GoBitboardT& operator^=(const GoBitboardT& other) { return *this = *this ^ other; }
+
+    bool operator==(const GoBitboardT& other) const
+    {
+        uint64_t diff = 0;
+        for (int i = 0; i < WORDS; ++i)
+            diff |= words[i] ^ other.words[i];
+        return diff == 0;
+    }
+
+    bool operator!=(const GoBitboardT& other) const { return !(*this == other); }
+
+    static int PopCount(uint64_t word)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        int count = 0;
+        for (; word; word &= word - 1)
+            ++count;
+        return count;
+#endif
+    }
+
+    static int TrailingZeros(uint64_t word)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        int count = 0;
+        for (; !(word & 1); word >>= 1)
+            ++count;
+        return count;
+#endif
+    }
+};
+
+// Function to build the set of all on-board points
+template <int N>
+constexpr GoBitboardT<N> MakeBoardMask()
+{
+    GoBitboardT<N> mask{};
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            int bit = y * GoBitboardT<N>::STRIDE + x;
+            mask.words[bit >> 6] |= uint64_t(1) << (bit & 63);
+        }
+    }
+    return mask;
+}
+
+template <int N>
+inline constexpr GoBitboardT<N> BOARD_MASK = MakeBoardMask<N>();
+
+template <int N>
+inline const GoBitboardT<N>& GoBitboardT<N>::BoardMask()
+{
+    return BOARD_MASK<N>;
+}
+
+typedef GoBitboardT<19> GoBitboard;
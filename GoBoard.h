@@ -0,0 +1,20 @@
+// GoBoard.h : Build-time choice of board representation.
+//
+// GoBoard is the rules engine used by code that only needs the basic
+// interface shared by both layouts (PlaceStone, IsValidMove, Pass, Undo,
+// At, CountLiberties, the hashes and the score accessors). Configure with
+// -DGO_BITBOARD=ON to switch it from the per-point array of GoPosition
+// to the bitboards of GoBitPosition. GoBoardT<N> is the same choice for
+// an N x N board.
+//
+#pragma once
+
+#ifdef GO_BITBOARD
+#include "GoBitPosition.h"
+template <int N> using GoBoardT = GoBitPositionT<N>;
+#else
+#include "GoPosition.h"
+template <int N> using GoBoardT = GoPositionT<N>;
+#endif
+
+typedef GoBoardT<19> GoBoard;
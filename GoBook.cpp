@@ -0,0 +1,317 @@
+// GoBook.cpp : Implements the opening book.
+//
+#include "GoBook.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "GoDatabase.h"
+#include "GoFeatures.h"
+#include "GoRandom.h"
+
+// File layout: a 32-byte header (magic, version, board size, radix bits,
+// entry count, reserved), the directory of 2^bits + 1 words padded to 8
+// bytes, then the entries
+static const char BOOK_MAGIC[4] = { 'G', 'O', 'B', 'K' };
+static const uint32_t BOOK_VERSION = 1;
+static const int BOOK_HEADER_SIZE = 32;
+static const int MAX_RADIX_BITS = 24;
+
+static std::size_t DirectoryBytes(int bits)
+{
+    return (((std::size_t)4 << bits) + 4 + 7) & ~(std::size_t)7;
+}
+
+// Symmetry that undoes the given one: rotations turn back, mirrorings
+// undo themselves
+static int InverseSymmetry(int symmetry)
+{
+    return symmetry < 4 ? (4 - symmetry) % 4 : symmetry;
+}
+
+// Function to hash the position in each orientation
+template <int N>
+static void OrientedHashes(const GoPositionT<N>& position, uint64_t* hashes)
+{
+    uint64_t side = position.CurrentPlayer() == WHITE ? ZOBRIST.whiteToMove : 0;
+    std::fill(hashes, hashes + SYMMETRY_COUNT, side);
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            int point = GoGeometry<N>::Point(x, y);
+            Stone stone = position.AtPoint(point);
+            if (stone == EMPTY)
+                continue;
+            for (int s = 0; s < SYMMETRY_COUNT; ++s)
+            {
+                int index = FeatureMoveIndex<N>(point, s);
+                hashes[s] ^= ZobristStone(stone, GoGeometry<N>::Point(index % N, index / N));
+            }
+        }
+    }
+}
+
+template <int N>
+uint64_t CanonicalPositionHash(const GoPositionT<N>& position, int& symmetry)
+{
+    uint64_t hashes[SYMMETRY_COUNT];
+    OrientedHashes(position, hashes);
+    symmetry = (int)(std::min_element(hashes, hashes + SYMMETRY_COUNT) - hashes);
+    return hashes[symmetry];
+}
+
+// Function to add a sample for every move of one game that is in book
+// depth; false if the game is left out
+template <int N>
+static bool AddBookGame(const GoDbGame& game, int maxMoves, GoPositionT<N>& position,
+    std::vector<GoBookEntry>& samples)
+{
+    int moves = std::min(maxMoves, game.MoveCount());
+    for (int i = 0; i < moves; ++i)
+    {
+        if (game.Move(i) == MOVE_CODE_SKIP)
+            return false;
+    }
+
+    if (position.GetKoRule() != KO_SIMPLE)
+        position.SetKoRule(KO_SIMPLE);
+    else
+        position.Reset();
+    std::size_t first = samples.size();
+    for (int i = 0; i < moves; ++i)
+    {
+        int code = game.Move(i);
+        if (code == MOVE_CODE_PASS)
+            break;
+
+        // Of the orientations that give the canonical hash, more than one
+        // if the position is symmetric, the one with the smallest move code
+        // picks the move among its symmetric equivalents
+        uint64_t hashes[SYMMETRY_COUNT];
+        OrientedHashes(position, hashes);
+        uint64_t hash = *std::min_element(hashes, hashes + SYMMETRY_COUNT);
+        int point = GoGeometry<N>::Point(code % N, code / N);
+        int canonical = N * N;
+        for (int s = 0; s < SYMMETRY_COUNT; ++s)
+        {
+            if (hashes[s] == hash)
+                canonical = std::min(canonical, FeatureMoveIndex<N>(point, s));
+        }
+
+        Stone mover = position.CurrentPlayer();
+        uint32_t points = game.Winner() == mover ? 2 : game.Winner() == EMPTY ? 1 : 0;
+        GoBookEntry sample = { hash, 1, points, (uint16_t)canonical, { 0, 0, 0 } };
+        samples.push_back(sample);
+        if (code >= N * N || !position.PlaceStone(code % N, code / N))
+        {
+            samples.resize(first);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GoBook::Build(const GoDatabase& database, const char* path, int size, int maxMoves, int minGames)
+{
+    if (size != 9 && size != 13 && size != 19)
+        return false;
+
+    GoPositionT<9> board9(KO_SIMPLE);
+    GoPositionT<13> board13(KO_SIMPLE);
+    GoPositionT<19> board19(KO_SIMPLE);
+    board9.SetUndoEnabled(false);
+    board13.SetUndoEnabled(false);
+    board19.SetUndoEnabled(false);
+
+    std::vector<GoBookEntry> samples;
+    for (uint64_t i = 0; i < database.GameCount(); ++i)
+    {
+        GoDbGame game = database.Game(i);
+        if (game.Size() != size)
+            continue;
+        if (size == 9)
+            AddBookGame(game, maxMoves, board9, samples);
+        else if (size == 13)
+            AddBookGame(game, maxMoves, board13, samples);
+        else
+            AddBookGame(game, maxMoves, board19, samples);
+    }
+
+    // Merge the samples of each position and move, then drop rare moves
+    std::sort(samples.begin(), samples.end(), [](const GoBookEntry& a, const GoBookEntry& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.move < b.move;
+    });
+    std::vector<GoBookEntry> book;
+    for (std::size_t i = 0; i < samples.size();)
+    {
+        GoBookEntry entry = samples[i];
+        std::size_t j = i + 1;
+        for (; j < samples.size() && samples[j].hash == entry.hash && samples[j].move == entry.move; ++j)
+        {
+            entry.games += 1;
+            entry.points += samples[j].points;
+        }
+        if ((int)entry.games >= minGames)
+            book.push_back(entry);
+        i = j;
+    }
+    std::vector<GoBookEntry>().swap(samples);
+    std::sort(book.begin(), book.end(), [](const GoBookEntry& a, const GoBookEntry& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.games != b.games ? a.games > b.games : a.move < b.move;
+    });
+    if (book.size() >= UINT32_MAX)
+        return false;
+
+    // About one position per directory bucket
+    std::size_t positions = 0;
+    for (std::size_t i = 0; i < book.size(); ++i)
+        positions += i == 0 || book[i].hash != book[i - 1].hash;
+    int bits = 1;
+    while (bits < MAX_RADIX_BITS && ((std::size_t)1 << bits) < positions)
+        ++bits;
+    std::vector<uint32_t> buckets(((std::size_t)1 << bits) + 1, 0);
+    std::size_t next = 0;
+    for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket)
+    {
+        while (next < book.size() && (book[next].hash >> (64 - bits)) < bucket)
+            ++next;
+        buckets[bucket] = (uint32_t)next;
+    }
+    buckets.back() = (uint32_t)book.size();
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+    uint8_t header[BOOK_HEADER_SIZE] = { 0 };
+    uint32_t boardSize = (uint32_t)size;
+    uint32_t radix = (uint32_t)bits;
+    uint64_t count = book.size();
+    std::memcpy(header, BOOK_MAGIC, 4);
+    std::memcpy(header + 4, &BOOK_VERSION, 4);
+    std::memcpy(header + 8, &boardSize, 4);
+    std::memcpy(header + 12, &radix, 4);
+    std::memcpy(header + 16, &count, 8);
+    buckets.resize(DirectoryBytes(bits) / 4, 0);
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    ok = ok && std::fwrite(buckets.data(), 4, buckets.size(), file) == buckets.size();
+    ok = ok && std::fwrite(book.data(), sizeof(GoBookEntry), book.size(), file) == book.size();
+    ok = (std::fclose(file) == 0) && ok;
+    return ok;
+}
+
+bool GoBook::Open(const char* path)
+{
+    Close();
+    if (!file.Open(path) || file.Size() < BOOK_HEADER_SIZE || std::memcmp(file.Data(), BOOK_MAGIC, 4) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    uint32_t version, boardSize, bits;
+    uint64_t count;
+    std::memcpy(&version, file.Data() + 4, 4);
+    std::memcpy(&boardSize, file.Data() + 8, 4);
+    std::memcpy(&bits, file.Data() + 12, 4);
+    std::memcpy(&count, file.Data() + 16, 8);
+    if (version != BOOK_VERSION || (boardSize != 9 && boardSize != 13 && boardSize != 19) || bits < 1 ||
+        bits > MAX_RADIX_BITS || file.Size() < BOOK_HEADER_SIZE + DirectoryBytes(bits) ||
+        (file.Size() - BOOK_HEADER_SIZE - DirectoryBytes(bits)) / sizeof(GoBookEntry) < count)
+    {
+        Close();
+        return false;
+    }
+    // Every bucket's range must lie inside the entries: the directory
+    // never decreases and ends at the entry count
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(file.Data() + BOOK_HEADER_SIZE);
+    std::size_t buckets = (std::size_t)1 << bits;
+    bool ordered = words[buckets] == count;
+    for (std::size_t i = 0; i < buckets && ordered; ++i)
+        ordered = words[i] <= words[i + 1];
+    if (!ordered)
+    {
+        Close();
+        return false;
+    }
+    size = (int)boardSize;
+    radixBits = (int)bits;
+    entryCount = count;
+    directory = words;
+    entries = reinterpret_cast<const GoBookEntry*>(file.Data() + BOOK_HEADER_SIZE + DirectoryBytes(bits));
+    return true;
+}
+
+void GoBook::Close()
+{
+    file.Close();
+    size = 0;
+    radixBits = 0;
+    entryCount = 0;
+    directory = nullptr;
+    entries = nullptr;
+}
+
+template <int N>
+int GoBook::FindMoves(const GoPositionT<N>& position, GoBookMove* moves, int capacity) const
+{
+    if (!IsOpen() || N != size)
+        return 0;
+
+    int symmetry;
+    uint64_t hash = CanonicalPositionHash(position, symmetry);
+    int inverse = InverseSymmetry(symmetry);
+    std::size_t bucket = (std::size_t)(hash >> (64 - radixBits));
+    int found = 0;
+    for (uint32_t i = directory[bucket]; i < directory[bucket + 1] && found < capacity; ++i)
+    {
+        const GoBookEntry& entry = entries[i];
+        if (entry.hash < hash)
+            continue;
+        if (entry.hash > hash || entry.move >= N * N)
+            break;
+        int index = FeatureMoveIndex<N>(GoGeometry<N>::Point(entry.move % N, entry.move / N), inverse);
+        moves[found].move = GoGeometry<N>::Point(index % N, index / N);
+        moves[found].games = (int)entry.games;
+        moves[found].winRate = entry.points / (2.0 * entry.games);
+        ++found;
+    }
+    return found;
+}
+
+template <int N>
+int GoBook::ChooseMove(const GoPositionT<N>& position, GoRandom& random) const
+{
+    GoBookMove moves[N * N];
+    int count = FindMoves(position, moves, N * N);
+    long long total = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (!position.IsLegalMove(moves[i].move))
+            moves[i].games = 0;
+        total += moves[i].games;
+    }
+    if (total == 0)
+        return PASS_MOVE;
+
+    long long pick = (long long)(random.Next() % (uint64_t)total);
+    for (int i = 0; i < count; ++i)
+    {
+        pick -= moves[i].games;
+        if (pick < 0)
+            return moves[i].move;
+    }
+    return PASS_MOVE;
+}
+
+template uint64_t CanonicalPositionHash(const GoPositionT<9>&, int&);
+template uint64_t CanonicalPositionHash(const GoPositionT<13>&, int&);
+template uint64_t CanonicalPositionHash(const GoPositionT<19>&, int&);
+template int GoBook::FindMoves(const GoPositionT<9>&, GoBookMove*, int) const;
+template int GoBook::FindMoves(const GoPositionT<13>&, GoBookMove*, int) const;
+template int GoBook::FindMoves(const GoPositionT<19>&, GoBookMove*, int) const;
+template int GoBook::ChooseMove(const GoPositionT<9>&, GoRandom&) const;
+template int GoBook::ChooseMove(const GoPositionT<13>&, GoRandom&) const;
+template int GoBook::ChooseMove(const GoPositionT<19>&, GoRandom&) const;
@@ -0,0 +1,94 @@
+// GoBook.h : Opening book, memory-mapped and shared between processes.
+//
+// A book maps positions of one board size to the moves played from them in
+// a game database, with how often each was played and how well it did.
+// Positions are keyed on a Zobrist hash made canonical over the 8
+// symmetries of the square: the position is hashed in every orientation
+// (see FeatureMoveIndex for their numbering) and the smallest hash wins.
+// Moves are stored as database move codes (y * size + x) in that winning
+// orientation and mapped back on lookup, so the four corners of an opening
+// share their statistics. Passes end the book line, and ko is not part of
+// the key.
+//
+// The file is a 32-byte header, a radix directory and the entries sorted
+// by hash. The directory is the first level of a radix trie over the
+// hash: entry i of its 2^bits + 1 words is the index of the first entry
+// whose hash starts with the bits of i, so a lookup reads one directory
+// word pair and scans the few entries of that bucket. The builder picks
+// bits so that buckets hold about one position. The file is mapped read
+// only and parsed in place: opening it costs nothing, and processes that
+// open the same book share one copy through the operating system's page
+// cache.
+//
+// All numbers are stored little-endian.
+//
+#pragma once
+
+#include <cstdint>
+
+#include "GoMappedFile.h"
+#include "GoPosition.h"
+
+class GoDatabase;
+class GoRandom;
+
+// One move from one position
+struct GoBookEntry
+{
+    uint64_t hash;      // canonical position hash
+    uint32_t games;     // games that played the move here
+    uint32_t points;    // for the player to move: 2 per win, 1 per draw
+    uint16_t move;      // move code in the canonical orientation
+    uint16_t reserved[3];
+};
+
+// A book move, in the layout of the position it was looked up for
+struct GoBookMove
+{
+    int move;
+    int games;
+    double winRate;
+};
+
+// Function to hash a position in all 8 orientations and return the
+// smallest hash; symmetry receives an orientation that gives it
+template <int N>
+uint64_t CanonicalPositionHash(const GoPositionT<N>& position, int& symmetry);
+
+class GoBook
+{
+public:
+    GoBook() : size(0), radixBits(0), entryCount(0), directory(nullptr), entries(nullptr) {}
+
+    // Function to replay the first maxMoves moves of every game of the
+    // given size in a database and write a book of the moves played at
+    // least minGames times. Games with a turn skip (handicap stones) within
+    // that depth are left out; games without a result count as draws.
+    static bool Build(const GoDatabase& database, const char* path, int size, int maxMoves = 30, int minGames = 4);
+
+    bool Open(const char* path);
+    void Close();
+
+    bool IsOpen() const { return entries != nullptr; }
+    int Size() const { return size; }
+    uint64_t EntryCount() const { return entryCount; }
+
+    // Book moves of a position, most played first; at most capacity are
+    // stored and the number stored is returned. Zero if the position is
+    // not in the book or the book is of another size.
+    template <int N>
+    int FindMoves(const GoPositionT<N>& position, GoBookMove* moves, int capacity) const;
+
+    // Function to pick a legal book move at random, in proportion to how
+    // often each was played; PASS_MOVE if the book has none
+    template <int N>
+    int ChooseMove(const GoPositionT<N>& position, GoRandom& random) const;
+
+private:
+    GoMappedFile file;
+    int size;
+    int radixBits;
+    uint64_t entryCount;
+    const uint32_t* directory;
+    const GoBookEntry* entries;
+};
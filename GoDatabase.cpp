@@ -0,0 +1,422 @@
+// GoDatabase.cpp : Implements the binary game database and its index.
+//
+#include "GoDatabase.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "GoSgf.h"
+
+// File layout: a 24-byte file header, the game records (each a 16-byte
+// header and its packed moves, padded to 4 bytes), then the offset table
+// of gameCount + 1 entries, the last one marking the end of the records
+static const char DB_MAGIC[4] = { 'G', 'O', 'D', 'B' };
+static const char INDEX_MAGIC[4] = { 'G', 'O', 'I', 'X' };
+static const uint32_t FORMAT_VERSION = 1;
+static const int FILE_HEADER_SIZE = 24;
+static const int GAME_HEADER_SIZE = 16;
+
+// Function to play one move code
+template <int N>
+static bool PlayCode(GoPositionT<N>& position, int code)
+{
+    if (code == MOVE_CODE_SKIP)
+    {
+        position.TogglePlayer();
+        return true;
+    }
+    if (code == MOVE_CODE_PASS)
+    {
+        position.Pass();
+        return true;
+    }
+    return code < N * N && position.PlaceStone(code % N, code / N);
+}
+
+// Function to start a replay from the empty board under simple ko
+template <int N>
+static void ResetForReplay(GoPositionT<N>& position)
+{
+    if (position.GetKoRule() != KO_SIMPLE)
+        position.SetKoRule(KO_SIMPLE);
+    else
+        position.Reset();
+}
+
+void ReadSgfResult(const char* text, std::size_t length, GoDbGameInfo& info)
+{
+    std::string value(text, length);
+    info.result = DB_RESULT_UNKNOWN;
+    info.winner = EMPTY;
+    info.margin = 0;
+    if (value == "0" || value == "Draw" || value == "Jigo")
+    {
+        info.result = DB_RESULT_DRAW;
+        return;
+    }
+    if (value.size() < 2 || (value[0] != 'B' && value[0] != 'W') || value[1] != '+')
+        return;
+
+    info.winner = value[0] == 'B' ? BLACK : WHITE;
+    std::string how = value.substr(2);
+    if (how.empty())
+        info.result = DB_RESULT_UNKNOWN;
+    else if (how[0] == 'R')
+        info.result = DB_RESULT_RESIGN;
+    else if (how[0] == 'T')
+        info.result = DB_RESULT_TIME;
+    else if (how[0] == 'F')
+        info.result = DB_RESULT_FORFEIT;
+    else
+    {
+        info.result = DB_RESULT_SCORE;
+        info.margin = std::atof(how.c_str());
+    }
+}
+
+GoDbWriter::GoDbWriter()
+    : file(nullptr), failed(false), offset(0), board9(KO_SIMPLE), board13(KO_SIMPLE), board19(KO_SIMPLE)
+{
+    board9.SetUndoEnabled(false);
+    board13.SetUndoEnabled(false);
+    board19.SetUndoEnabled(false);
+}
+
+GoDbWriter::~GoDbWriter()
+{
+    if (file)
+        Close();
+}
+
+bool GoDbWriter::Open(const char* path)
+{
+    if (file)
+        Close();
+    file = std::fopen(path, "wb");
+    failed = file == nullptr;
+    offsets.clear();
+
+    // The header is written again with the final counts by Close
+    uint8_t header[FILE_HEADER_SIZE] = { 0 };
+    offset = FILE_HEADER_SIZE;
+    failed = failed || std::fwrite(header, 1, sizeof(header), file) != sizeof(header);
+    return !failed;
+}
+
+template <int N>
+bool GoDbWriter::Replay(const std::vector<uint16_t>& moves, GoPositionT<N>& position)
+{
+    ResetForReplay(position);
+    for (uint16_t code : moves)
+    {
+        if (!PlayCode(position, code))
+            return false;
+    }
+    return true;
+}
+
+bool GoDbWriter::AddGame(const GoDbGameInfo& info, const std::vector<uint16_t>& moves)
+{
+    if (file == nullptr)
+        return false;
+    bool legal = info.size == 9 ? Replay(moves, board9)
+        : info.size == 13 ? Replay(moves, board13)
+        : info.size == 19 ? Replay(moves, board19) : false;
+    if (!legal)
+        return false;
+
+    uint8_t header[GAME_HEADER_SIZE] = { 0 };
+    uint32_t count = (uint32_t)moves.size();
+    float komi = (float)info.komi;
+    float margin = (float)info.margin;
+    header[0] = (uint8_t)info.size;
+    header[1] = (uint8_t)info.winner;
+    header[2] = (uint8_t)info.result;
+    std::memcpy(header + 4, &count, 4);
+    std::memcpy(header + 8, &komi, 4);
+    std::memcpy(header + 12, &margin, 4);
+
+    // Pack the codes 9 bits apiece, lowest bits first
+    std::size_t bytes = (moves.size() * 9 + 7) / 8;
+    packed.assign((bytes + 3) & ~std::size_t(3), 0);
+    for (std::size_t i = 0; i < moves.size(); ++i)
+    {
+        std::size_t bit = i * 9;
+        unsigned value = (unsigned)moves[i] << (bit & 7);
+        packed[bit >> 3] |= (uint8_t)value;
+        packed[(bit >> 3) + 1] |= (uint8_t)(value >> 8);
+    }
+
+    failed = failed || std::fwrite(header, 1, sizeof(header), file) != sizeof(header);
+    failed = failed || std::fwrite(packed.data(), 1, packed.size(), file) != packed.size();
+    offsets.push_back(offset);
+    offset += sizeof(header) + packed.size();
+    return !failed;
+}
+
+bool GoDbWriter::AddSgfGame(const GoSgfGame& game)
+{
+    GoDbGameInfo info;
+    info.size = game.size;
+    info.komi = game.komi;
+    ReadSgfResult(game.result.data(), game.result.size(), info);
+
+    // A player who moves out of turn is given the turn with a skip
+    codes.clear();
+    Stone toMove = BLACK;
+    for (const GoSgfMove& move : game.moves)
+    {
+        if (move.player != toMove)
+        {
+            codes.push_back(MOVE_CODE_SKIP);
+            toMove = move.player;
+        }
+        if (move.x < 0)
+            codes.push_back(MOVE_CODE_PASS);
+        else if (move.x < game.size && move.y < game.size)
+            codes.push_back((uint16_t)(move.y * game.size + move.x));
+        else
+            return false;
+        toMove = Opponent(toMove);
+    }
+    return AddGame(info, codes);
+}
+
+bool GoDbWriter::Close()
+{
+    if (file == nullptr)
+        return false;
+
+    // Offset table, 8-byte aligned, ending with the end of the records
+    uint8_t padding[8] = { 0 };
+    std::size_t pad = (std::size_t)((8 - offset % 8) % 8);
+    failed = failed || std::fwrite(padding, 1, pad, file) != pad;
+    uint64_t tableOffset = offset + pad;
+    offsets.push_back(offset);
+    failed = failed || std::fwrite(offsets.data(), 8, offsets.size(), file) != offsets.size();
+    offsets.pop_back();
+
+    uint8_t header[FILE_HEADER_SIZE] = { 0 };
+    uint64_t count = offsets.size();
+    std::memcpy(header, DB_MAGIC, 4);
+    std::memcpy(header + 4, &FORMAT_VERSION, 4);
+    std::memcpy(header + 8, &count, 8);
+    std::memcpy(header + 16, &tableOffset, 8);
+    failed = failed || std::fseek(file, 0, SEEK_SET) != 0;
+    failed = failed || std::fwrite(header, 1, sizeof(header), file) != sizeof(header);
+    failed = (std::fclose(file) != 0) || failed;
+    file = nullptr;
+    return !failed;
+}
+
+int GoDbGame::Size() const
+{
+    return header[0];
+}
+
+Stone GoDbGame::Winner() const
+{
+    return (Stone)header[1];
+}
+
+GoDbResult GoDbGame::Result() const
+{
+    return (GoDbResult)header[2];
+}
+
+int GoDbGame::MoveCount() const
+{
+    uint32_t count;
+    std::memcpy(&count, header + 4, 4);
+    return (int)count;
+}
+
+double GoDbGame::Komi() const
+{
+    float komi;
+    std::memcpy(&komi, header + 8, 4);
+    return komi;
+}
+
+double GoDbGame::Margin() const
+{
+    float margin;
+    std::memcpy(&margin, header + 12, 4);
+    return margin;
+}
+
+template <int N>
+bool ReplayDbGame(const GoDbGame& game, GoPositionT<N>& position, int count)
+{
+    if (game.Size() != N)
+        return false;
+    ResetForReplay(position);
+    int moves = count < 0 ? game.MoveCount() : std::min(count, game.MoveCount());
+    for (int i = 0; i < moves; ++i)
+    {
+        if (!PlayCode(position, game.Move(i)))
+            return false;
+    }
+    return true;
+}
+
+template bool ReplayDbGame(const GoDbGame&, GoPositionT<9>&, int);
+template bool ReplayDbGame(const GoDbGame&, GoPositionT<13>&, int);
+template bool ReplayDbGame(const GoDbGame&, GoPositionT<19>&, int);
+
+bool GoDatabase::Open(const char* path)
+{
+    Close();
+    if (!file.Open(path) || file.Size() < FILE_HEADER_SIZE || std::memcmp(file.Data(), DB_MAGIC, 4) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    uint32_t version;
+    uint64_t count;
+    uint64_t tableOffset;
+    std::memcpy(&version, file.Data() + 4, 4);
+    std::memcpy(&count, file.Data() + 8, 8);
+    std::memcpy(&tableOffset, file.Data() + 16, 8);
+    if (version != FORMAT_VERSION || tableOffset % 8 != 0 || tableOffset > file.Size() ||
+        (file.Size() - tableOffset) / 8 < count + 1)
+    {
+        Close();
+        return false;
+    }
+
+    // Every record must lie between the header and the table and be
+    // long enough for its moves
+    table = reinterpret_cast<const uint64_t*>(file.Data() + tableOffset);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t start = table[i];
+        uint64_t end = table[i + 1];
+        uint32_t moves;
+        if (start < FILE_HEADER_SIZE || end < start + GAME_HEADER_SIZE || end > tableOffset || start % 4 != 0)
+        {
+            Close();
+            return false;
+        }
+        std::memcpy(&moves, file.Data() + start + 4, 4);
+        if (end - start - GAME_HEADER_SIZE < ((uint64_t)moves * 9 + 7) / 8)
+        {
+            Close();
+            return false;
+        }
+    }
+    gameCount = count;
+    return true;
+}
+
+void GoDatabase::Close()
+{
+    file.Close();
+    gameCount = 0;
+    table = nullptr;
+}
+
+GoDbGame GoDatabase::Game(uint64_t i) const
+{
+    GoDbGame game;
+    game.header = reinterpret_cast<const uint8_t*>(file.Data()) + table[i];
+    game.moves = game.header + GAME_HEADER_SIZE;
+    return game;
+}
+
+// Function to add the positions of one game, one entry per move that put
+// a stone on the board
+template <int N>
+static bool IndexGame(const GoDbGame& game, uint32_t number, int maxMoves, GoPositionT<N>& position,
+    std::vector<GoDbIndexEntry>& entries)
+{
+    ResetForReplay(position);
+    int moves = maxMoves > 0 ? std::min(maxMoves, game.MoveCount()) : game.MoveCount();
+    for (int i = 0; i < moves; ++i)
+    {
+        int code = game.Move(i);
+        if (!PlayCode(position, code))
+            return false;
+        if (code != MOVE_CODE_PASS && code != MOVE_CODE_SKIP)
+            entries.push_back({ position.PositionHash(), number, (uint32_t)(i + 1) });
+    }
+    return true;
+}
+
+bool GoDbIndex::Build(const GoDatabase& database, const char* path, int maxMoves)
+{
+    GoPositionT<9> board9(KO_SIMPLE);
+    GoPositionT<13> board13(KO_SIMPLE);
+    GoPositionT<19> board19(KO_SIMPLE);
+    board9.SetUndoEnabled(false);
+    board13.SetUndoEnabled(false);
+    board19.SetUndoEnabled(false);
+
+    std::vector<GoDbIndexEntry> entries;
+    for (uint64_t i = 0; i < database.GameCount(); ++i)
+    {
+        GoDbGame game = database.Game(i);
+        bool legal = game.Size() == 9 ? IndexGame(game, (uint32_t)i, maxMoves, board9, entries)
+            : game.Size() == 13 ? IndexGame(game, (uint32_t)i, maxMoves, board13, entries)
+            : game.Size() == 19 ? IndexGame(game, (uint32_t)i, maxMoves, board19, entries) : false;
+        if (!legal)
+            return false;
+    }
+    std::sort(entries.begin(), entries.end(), [](const GoDbIndexEntry& a, const GoDbIndexEntry& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.game != b.game ? a.game < b.game : a.move < b.move;
+    });
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+    uint8_t header[FILE_HEADER_SIZE] = { 0 };
+    uint64_t count = entries.size();
+    uint32_t depth = (uint32_t)std::max(0, maxMoves);
+    std::memcpy(header, INDEX_MAGIC, 4);
+    std::memcpy(header + 4, &FORMAT_VERSION, 4);
+    std::memcpy(header + 8, &count, 8);
+    std::memcpy(header + 16, &depth, 4);
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    ok = ok && std::fwrite(entries.data(), sizeof(GoDbIndexEntry), entries.size(), file) == entries.size();
+    ok = (std::fclose(file) == 0) && ok;
+    return ok;
+}
+
+bool GoDbIndex::Open(const char* path)
+{
+    Close();
+    if (!file.Open(path) || file.Size() < FILE_HEADER_SIZE || std::memcmp(file.Data(), INDEX_MAGIC, 4) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    uint32_t version;
+    uint64_t count;
+    std::memcpy(&version, file.Data() + 4, 4);
+    std::memcpy(&count, file.Data() + 8, 8);
+    if (version != FORMAT_VERSION || (file.Size() - FILE_HEADER_SIZE) / sizeof(GoDbIndexEntry) < count)
+    {
+        Close();
+        return false;
+    }
+    entryCount = count;
+    entries = reinterpret_cast<const GoDbIndexEntry*>(file.Data() + FILE_HEADER_SIZE);
+    return true;
+}
+
+void GoDbIndex::Close()
+{
+    file.Close();
+    entryCount = 0;
+    entries = nullptr;
+}
+
+GoDbIndexRange GoDbIndex::Find(uint64_t hash) const
+{
+    auto range = std::equal_range(entries, entries + entryCount, GoDbIndexEntry{ hash, 0, 0 },
+        [](const GoDbIndexEntry& a, const GoDbIndexEntry& b) { return a.hash < b.hash; });
+    return { range.first, range.second };
+}
@@ -0,0 +1,199 @@
+// GoDatabase.h : Compact binary game records, read in place.
+//
+// A database file holds many games, each as a 16-byte header (board size,
+// komi, result, move count) followed by its moves packed into 9 bits
+// apiece. An offset table at the end of the file points at every game,
+// so the file is memory-mapped and any game is reached in constant time
+// without parsing; a 250-move game takes about 300 bytes.
+//
+// A move code is y * size + x for a stone, MOVE_CODE_PASS for a pass and
+// MOVE_CODE_SKIP for a turn handed over without a pass (a player moving
+// twice in a row, as after handicap stones). Games are replayed with
+// PlaceStone, Pass and TogglePlayer under simple ko, both when they are
+// written, which rejects games with illegal moves, and when they are read.
+//
+// A GoDbIndex maps the Zobrist position hash (stones only, see
+// GoPosition::PositionHash) of every position in the database to the
+// games and move numbers that reached it. It is a separate file of sorted
+// 16-byte entries, also memory-mapped, and a lookup is a binary search.
+// The hash does not include the board size; check Game(game).Size() if the
+// database mixes sizes.
+//
+// All numbers are stored little-endian, the byte order of the machines the
+// engine runs on.
+//
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "GoMappedFile.h"
+#include "GoPosition.h"
+
+struct GoSgfGame;
+
+const int MOVE_CODE_PASS = 510;
+const int MOVE_CODE_SKIP = 511;
+
+// How a game ended
+enum GoDbResult : uint8_t
+{
+    DB_RESULT_UNKNOWN,
+    DB_RESULT_SCORE,        // margin holds the winner's lead
+    DB_RESULT_RESIGN,
+    DB_RESULT_TIME,
+    DB_RESULT_FORFEIT,
+    DB_RESULT_DRAW
+};
+
+// Everything about a game but its moves
+struct GoDbGameInfo
+{
+    int size = 19;
+    double komi = 0;
+    GoDbResult result = DB_RESULT_UNKNOWN;
+    Stone winner = EMPTY;
+    double margin = 0;
+};
+
+// Function to fill in the result fields from an SGF RE value such as
+// "B+R", "W+3.5" or "0"
+void ReadSgfResult(const char* text, std::size_t length, GoDbGameInfo& info);
+
+// Writes a database file game by game
+class GoDbWriter
+{
+public:
+    GoDbWriter();
+    ~GoDbWriter();
+
+    GoDbWriter(const GoDbWriter&) = delete;
+    GoDbWriter& operator=(const GoDbWriter&) = delete;
+
+    bool Open(const char* path);
+
+    // Replay and append a game; false, with nothing written, if the size
+    // is not supported or a move is illegal
+    bool AddGame(const GoDbGameInfo& info, const std::vector<uint16_t>& moves);
+
+    // Convert a parsed SGF record and append it
+    bool AddSgfGame(const GoSgfGame& game);
+
+    // Write the offset table; false if anything could not be written
+    bool Close();
+
+    uint64_t GameCount() const { return offsets.size(); }
+
+private:
+    template <int N>
+    bool Replay(const std::vector<uint16_t>& moves, GoPositionT<N>& position);
+
+    std::FILE* file;
+    bool failed;
+    uint64_t offset;
+    std::vector<uint64_t> offsets;
+    std::vector<uint16_t> codes;
+    std::vector<uint8_t> packed;
+    GoPositionT<9> board9;
+    GoPositionT<13> board13;
+    GoPositionT<19> board19;
+};
+
+// One game in a mapped database; a view, valid while the database is open
+class GoDbGame
+{
+public:
+    GoDbGame() : header(nullptr), moves(nullptr) {}
+
+    int Size() const;
+    double Komi() const;
+    GoDbResult Result() const;
+    Stone Winner() const;
+    double Margin() const;
+    int MoveCount() const;
+
+    // Move code i, 0 <= i < MoveCount()
+    int Move(int i) const
+    {
+        int bit = i * 9;
+        return ((moves[bit >> 3] | (moves[(bit >> 3) + 1] << 8)) >> (bit & 7)) & 511;
+    }
+
+private:
+    friend class GoDatabase;
+
+    const uint8_t* header;
+    const uint8_t* moves;
+};
+
+// Function to replay the first count moves of a game (all of them if
+// count is negative) on a reset position of the game's size. False if the
+// size does not match or a move is illegal.
+template <int N>
+bool ReplayDbGame(const GoDbGame& game, GoPositionT<N>& position, int count = -1);
+
+// Read-only view of a database file
+class GoDatabase
+{
+public:
+    GoDatabase() : gameCount(0), table(nullptr) {}
+
+    // Map the file and check its header and offset table
+    bool Open(const char* path);
+    void Close();
+
+    uint64_t GameCount() const { return gameCount; }
+    GoDbGame Game(uint64_t i) const;
+
+    std::size_t FileSize() const { return file.Size(); }
+
+private:
+    GoMappedFile file;
+    uint64_t gameCount;
+    const uint64_t* table;
+};
+
+// Index entry: position hash and where it occurred
+struct GoDbIndexEntry
+{
+    uint64_t hash;
+    uint32_t game;
+    uint32_t move;      // moves played to reach the position
+};
+
+// Entries of one hash, as a range into the mapped index
+struct GoDbIndexRange
+{
+    const GoDbIndexEntry* first;
+    const GoDbIndexEntry* last;
+
+    const GoDbIndexEntry* begin() const { return first; }
+    const GoDbIndexEntry* end() const { return last; }
+    std::size_t size() const { return last - first; }
+};
+
+class GoDbIndex
+{
+public:
+    GoDbIndex() : entryCount(0), entries(nullptr) {}
+
+    // Function to replay every game of a database and write the index of
+    // its positions, up to maxMoves into each game if maxMoves > 0
+    static bool Build(const GoDatabase& database, const char* path, int maxMoves = 0);
+
+    bool Open(const char* path);
+    void Close();
+
+    uint64_t EntryCount() const { return entryCount; }
+
+    // Every occurrence of a position hash, on any board size; the empty
+    // board, for one, has the same hash on all of them
+    GoDbIndexRange Find(uint64_t hash) const;
+
+private:
+    GoMappedFile file;
+    uint64_t entryCount;
+    const GoDbIndexEntry* entries;
+};
@@ -0,0 +1,262 @@
+// GoDb.cpp : Builds, scans and searches binary game databases.
+//
+// Usage:
+//   GoDb build <out.godb> <sgf file or directory>...
+//   GoDb index <db.godb> [max moves per game]
+//   GoDb scan <db.godb>
+//   GoDb find <db.godb> <game> <move>
+//   GoDb book <db.godb> <out.gobook> [size] [max moves] [min games]
+//
+// build converts SGF records (see GoSgfImporter) into a database, keeping
+// the games that replay legally, in the order the import threads finish
+// them. index writes <db.godb>.idx. scan replays
+// every game and reports games per second. find looks up the position
+// after the given move of the given game (both counted from 1) in the
+// index and lists the games that reached it. book writes an opening book
+// (see GoBook) of the given size, 19 by default, from the first 30 moves
+// of each game, keeping moves played at least 4 times, and lists the book
+// moves of the empty board.
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GoBook.h"
+#include "GoDatabase.h"
+#include "GoSgfImporter.h"
+
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int Build(const char* out, const std::vector<std::string>& paths)
+{
+    GoDbWriter writer;
+    if (!writer.Open(out))
+    {
+        std::fprintf(stderr, "cannot write %s\n", out);
+        return 1;
+    }
+
+    // Records arrive on the importer's worker threads
+    std::mutex mutex;
+    long long rejected = 0;
+    GoSgfImporter importer;
+    importer.SetGameCallback([&](const GoSgfGame& game, const GoSgfReport& report) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!report.IsComplete() || !writer.AddSgfGame(game))
+            rejected += 1;
+    });
+    GoSgfImportStats stats = importer.Import(paths);
+    uint64_t written = writer.GameCount();
+    if (!writer.Close())
+    {
+        std::fprintf(stderr, "error writing %s\n", out);
+        return 1;
+    }
+
+    GoDatabase database;
+    database.Open(out);
+    std::printf("%lld games from %.1f MB of SGF in %.2f s (%.0f games/sec)\n", stats.games, stats.bytes / 1e6,
+        stats.seconds, stats.GamesPerSecond());
+    std::printf("wrote %llu games, %.1f MB, %.0f bytes/game; skipped %lld\n", (unsigned long long)written,
+        database.FileSize() / 1e6, written ? (double)database.FileSize() / written : 0.0, rejected);
+    return 0;
+}
+
+static int Index(const char* path, int maxMoves)
+{
+    GoDatabase database;
+    if (!database.Open(path))
+    {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    std::string indexPath = std::string(path) + ".idx";
+    auto start = std::chrono::steady_clock::now();
+    if (!GoDbIndex::Build(database, indexPath.c_str(), maxMoves))
+    {
+        std::fprintf(stderr, "cannot index %s\n", path);
+        return 1;
+    }
+    GoDbIndex index;
+    index.Open(indexPath.c_str());
+    std::printf("indexed %llu positions of %llu games in %.2f s\n", (unsigned long long)index.EntryCount(),
+        (unsigned long long)database.GameCount(), SecondsSince(start));
+    return 0;
+}
+
+static int Scan(const char* path)
+{
+    GoDatabase database;
+    if (!database.Open(path))
+    {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+
+    GoPositionT<9> board9(KO_SIMPLE);
+    GoPositionT<13> board13(KO_SIMPLE);
+    GoPositionT<19> board19(KO_SIMPLE);
+    board9.SetUndoEnabled(false);
+    board13.SetUndoEnabled(false);
+    board19.SetUndoEnabled(false);
+
+    long long moves = 0;
+    long long blackWins = 0;
+    long long whiteWins = 0;
+    long long failed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < database.GameCount(); ++i)
+    {
+        GoDbGame game = database.Game(i);
+        bool ok = game.Size() == 9 ? ReplayDbGame(game, board9)
+            : game.Size() == 13 ? ReplayDbGame(game, board13) : ReplayDbGame(game, board19);
+        failed += !ok;
+        moves += game.MoveCount();
+        blackWins += game.Winner() == BLACK;
+        whiteWins += game.Winner() == WHITE;
+    }
+    double seconds = SecondsSince(start);
+
+    std::printf("%llu games, %lld moves replayed in %.2f s\n", (unsigned long long)database.GameCount(), moves,
+        seconds);
+    std::printf("%-22s %14.0f\n", "games/sec", seconds > 0 ? database.GameCount() / seconds : 0);
+    std::printf("%-22s %14.0f\n", "moves/sec", seconds > 0 ? moves / seconds : 0);
+    std::printf("Black wins %lld, White wins %lld, failed replays %lld\n", blackWins, whiteWins, failed);
+    return failed > 0 ? 1 : 0;
+}
+
+// Function to replay a game up to a move and return the position hash
+template <int N>
+static uint64_t PositionAfter(const GoDbGame& game, int move)
+{
+    GoPositionT<N> position(KO_SIMPLE);
+    ReplayDbGame(game, position, move);
+    return position.PositionHash();
+}
+
+static int Find(const char* path, long long gameNumber, int move)
+{
+    GoDatabase database;
+    GoDbIndex index;
+    std::string indexPath = std::string(path) + ".idx";
+    if (!database.Open(path) || !index.Open(indexPath.c_str()))
+    {
+        std::fprintf(stderr, "cannot open %s and %s\n", path, indexPath.c_str());
+        return 1;
+    }
+    if (gameNumber < 1 || (uint64_t)gameNumber > database.GameCount())
+    {
+        std::fprintf(stderr, "no game %lld\n", gameNumber);
+        return 1;
+    }
+
+    GoDbGame game = database.Game(gameNumber - 1);
+    uint64_t hash = game.Size() == 9 ? PositionAfter<9>(game, move)
+        : game.Size() == 13 ? PositionAfter<13>(game, move) : PositionAfter<19>(game, move);
+
+    // The index does not tell board sizes apart (the empty board, for one,
+    // hashes the same on all of them), so hits in games of other sizes are
+    // left out
+    auto start = std::chrono::steady_clock::now();
+    GoDbIndexRange range = index.Find(hash);
+    std::vector<GoDbIndexEntry> hits;
+    for (const GoDbIndexEntry& hit : range)
+    {
+        if (database.Game(hit.game).Size() == game.Size())
+            hits.push_back(hit);
+    }
+    double seconds = SecondsSince(start);
+
+    std::printf("position %016llx: %zu occurrences, found in %.3f ms\n", (unsigned long long)hash, hits.size(),
+        1000 * seconds);
+    int shown = 0;
+    for (const GoDbIndexEntry& hit : hits)
+    {
+        if (++shown > 20)
+        {
+            std::printf("...\n");
+            break;
+        }
+        std::printf("game %u, move %u\n", hit.game + 1, hit.move);
+    }
+    return 0;
+}
+
+// Function to print the book moves of the empty board
+template <int N>
+static void ShowBookStart(const GoBook& book)
+{
+    GoPositionT<N> position;
+    GoBookMove moves[N * N];
+    int count = book.FindMoves(position, moves, N * N);
+    for (int i = 0; i < count && i < 10; ++i)
+    {
+        std::printf("  %c%d: %d games, %.1f%% won\n", "ABCDEFGHJKLMNOPQRST"[GoGeometry<N>::PointX(moves[i].move)],
+            N - GoGeometry<N>::PointY(moves[i].move), moves[i].games, 100 * moves[i].winRate);
+    }
+}
+
+static int Book(const char* path, const char* out, int size, int maxMoves, int minGames)
+{
+    GoDatabase database;
+    if (!database.Open(path))
+    {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!GoBook::Build(database, out, size, maxMoves, minGames))
+    {
+        std::fprintf(stderr, "cannot write a %dx%d book to %s\n", size, size, out);
+        return 1;
+    }
+    GoBook book;
+    book.Open(out);
+    std::printf("book of %llu moves in %.2f s; from the empty board:\n", (unsigned long long)book.EntryCount(),
+        SecondsSince(start));
+    if (size == 9)
+        ShowBookStart<9>(book);
+    else if (size == 13)
+        ShowBookStart<13>(book);
+    else
+        ShowBookStart<19>(book);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* command = argc > 1 ? argv[1] : "";
+    if (std::strcmp(command, "build") == 0 && argc > 3)
+    {
+        std::vector<std::string> paths;
+        for (int i = 3; i < argc; ++i)
+            AddSgfPath(argv[i], paths);
+        return Build(argv[2], paths);
+    }
+    if (std::strcmp(command, "index") == 0 && argc > 2)
+        return Index(argv[2], argc > 3 ? std::atoi(argv[3]) : 0);
+    if (std::strcmp(command, "scan") == 0 && argc > 2)
+        return Scan(argv[2]);
+    if (std::strcmp(command, "find") == 0 && argc > 4)
+        return Find(argv[2], std::atoll(argv[3]), std::atoi(argv[4]));
+    if (std::strcmp(command, "book") == 0 && argc > 3)
+    {
+        return Book(argv[2], argv[3], argc > 4 ? std::atoi(argv[4]) : 19, argc > 5 ? std::atoi(argv[5]) : 30,
+            argc > 6 ? std::atoi(argv[6]) : 4);
+    }
+
+    std::fprintf(stderr,
+        "usage: GoDb build <out.godb> <sgf file or directory>...\n"
+        "       GoDb index <db.godb> [max moves per game]\n"
+        "       GoDb scan <db.godb>\n"
+        "       GoDb find <db.godb> <game> <move>\n"
+        "       GoDb book <db.godb> <out.gobook> [size] [max moves] [min games]\n");
+    return 2;
+}
@@ -0,0 +1,75 @@
+// GoEvalQueue.cpp : Implements the batching evaluation queue.
+//
+#include "GoEvalQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "GoFeatures.h"
+
+GoEvalQueue::GoEvalQueue(const GoNetwork& network, int batchSize, double maxWaitSeconds)
+    : network(network), batchSize(std::max(1, batchSize)), maxWait(maxWaitSeconds), positions(0), batches(0)
+{
+}
+
+double GoEvalQueue::AverageBatch() const
+{
+    long long count = batches.load();
+    return count > 0 ? (double)positions.load() / count : 0;
+}
+
+void GoEvalQueue::Evaluate(const uint8_t* planes, float* policy, float& value)
+{
+    Request request = { planes, policy, &value, false, false };
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.push_back(&request);
+    if ((int)pending.size() >= batchSize)
+    {
+        RunBatch(lock);
+        return;
+    }
+
+    auto timeout = std::chrono::duration<double>(maxWait);
+    if (!finished.wait_for(lock, timeout, [&request]() { return request.taken; }))
+        RunBatch(lock);
+    finished.wait(lock, [&request]() { return request.done; });
+}
+
+// Function to evaluate every pending request; called with the lock held,
+// which is released while the network runs
+void GoEvalQueue::RunBatch(std::unique_lock<std::mutex>& lock)
+{
+    std::vector<Request*> batch;
+    batch.swap(pending);
+    for (Request* request : batch)
+        request->taken = true;
+    finished.notify_all();
+    lock.unlock();
+
+    // Scratch arrays of the thread that runs the batch
+    static thread_local std::vector<uint8_t> input;
+    static thread_local std::vector<float> policies;
+    static thread_local std::vector<float> values;
+    int count = (int)batch.size();
+    std::size_t planeBytes = (std::size_t)FEATURE_PLANES * network.Shape().size * network.Shape().size;
+    int policySize = network.PolicySize();
+    input.resize(count * planeBytes);
+    policies.resize((std::size_t)count * policySize);
+    values.resize(count);
+    for (int i = 0; i < count; ++i)
+        std::memcpy(input.data() + i * planeBytes, batch[i]->planes, planeBytes);
+
+    network.Evaluate(input.data(), count, policies.data(), values.data());
+    positions.fetch_add(count);
+    batches.fetch_add(1);
+
+    lock.lock();
+    for (int i = 0; i < count; ++i)
+    {
+        std::memcpy(batch[i]->policy, policies.data() + (std::size_t)i * policySize, policySize * sizeof(float));
+        *batch[i]->value = values[i];
+        batch[i]->done = true;
+    }
+    finished.notify_all();
+}
@@ -0,0 +1,63 @@
+// GoEvalQueue.h : Batches network evaluations from many search threads.
+//
+// A network evaluates a batch of positions much faster per position than
+// one at a time, since the SIMD kernels run over the whole batch. Search
+// threads therefore do not call the network themselves: each one hands its
+// leaf position to the queue and blocks. The request that fills a batch,
+// or the oldest one once it has waited maxWait, takes every pending
+// request and evaluates them together on its own thread; then all of them
+// wake up with their results. There is no dedicated evaluation thread, and
+// while one batch is evaluated the next one fills.
+//
+// For full batches the batch size should not exceed the number of search
+// threads; with fewer threads every evaluation waits out maxWait.
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "GoNetwork.h"
+
+class GoEvalQueue
+{
+public:
+    GoEvalQueue(const GoNetwork& network, int batchSize, double maxWaitSeconds = 0.001);
+
+    const GoNetwork& Network() const { return network; }
+    int BatchSize() const { return batchSize; }
+
+    // Evaluate one position (FEATURE_PLANES * size * size bytes). Fills
+    // Network().PolicySize() probabilities and a value in [-1, 1] for the
+    // player to move. Blocks until the batch holding it has run.
+    void Evaluate(const uint8_t* planes, float* policy, float& value);
+
+    // Totals so far
+    long long Positions() const { return positions.load(); }
+    long long Batches() const { return batches.load(); }
+    double AverageBatch() const;
+
+private:
+    struct Request
+    {
+        const uint8_t* planes;
+        float* policy;
+        float* value;
+        bool taken;
+        bool done;
+    };
+
+    void RunBatch(std::unique_lock<std::mutex>& lock);
+
+    const GoNetwork& network;
+    int batchSize;
+    double maxWait;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::vector<Request*> pending;
+    std::atomic<long long> positions;
+    std::atomic<long long> batches;
+};
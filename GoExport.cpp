@@ -0,0 +1,224 @@
+// GoExport.cpp : Turns a game database into training arrays.
+//
+// Usage: GoExport <db.godb> <out prefix> [-size n] [-sym none|random|all] [-games n] [-batch n]
+//
+// Replays the games of one board size (the size of the first game unless
+// -size is given) and writes a sample for every position before a move:
+//
+//   <prefix>.features.npy   uint8  (count, 16, n, n)   see GoFeatures.h
+//   <prefix>.moves.npy      int16  (count,)            move played, y * n + x, n * n for a pass
+//   <prefix>.results.npy    int8   (count,)            1 win, 0 draw, -1 loss for the player to move
+//
+// -sym random applies one random symmetry per position and -sym all writes
+// all eight. Games without a known winner are skipped. The tool reports
+// how the time splits between replaying, extracting and writing.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "GoDatabase.h"
+#include "GoFeatures.h"
+#include "GoNpy.h"
+#include "GoRandom.h"
+
+enum SymmetryMode { SYMMETRY_NONE, SYMMETRY_RANDOM, SYMMETRY_ALL };
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::duration duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+// Output files and where the time went
+struct Exporter
+{
+    GoNpyWriter features;
+    GoNpyWriter moves;
+    GoNpyWriter results;
+    Clock::duration replayTime = Clock::duration::zero();
+    Clock::duration extractTime = Clock::duration::zero();
+    Clock::duration writeTime = Clock::duration::zero();
+    long long games = 0;
+    long long stopped = 0;      // games cut short at a move that could not be played
+
+    bool Flush(GoFeatureBatch& batch)
+    {
+        auto start = Clock::now();
+        bool ok = features.Write(batch.Features(), batch.Count()) && moves.Write(batch.Moves(), batch.Count()) &&
+            results.Write(batch.Results(), batch.Count());
+        batch.Clear();
+        writeTime += Clock::now() - start;
+        return ok;
+    }
+};
+
+// Function to replay the games of size N and write their samples
+template <int N>
+static bool Export(const GoDatabase& database, Exporter& out, SymmetryMode mode, long long maxGames, int batchSize)
+{
+    GoFeatureBatch batch(N, batchSize);
+    GoPositionT<N> position(KO_SIMPLE);
+    position.SetUndoEnabled(false);
+    GoRandom random(1);
+    int recent[FEATURE_HISTORY];
+    int recentCount = 0;
+
+    for (uint64_t g = 0; g < database.GameCount() && (maxGames <= 0 || out.games < maxGames); ++g)
+    {
+        GoDbGame game = database.Game(g);
+        if (game.Size() != N || (game.Winner() == EMPTY && game.Result() != DB_RESULT_DRAW))
+            continue;
+        out.games += 1;
+
+        position.Reset();
+        recentCount = 0;
+        for (int i = 0; i < game.MoveCount(); ++i)
+        {
+            // A move off the board or against the rules leaves the game out
+            // of step, so the rest of it gets no samples
+            int code = game.Move(i);
+            bool point = code != MOVE_CODE_PASS && code != MOVE_CODE_SKIP;
+            if (point && (code >= N * N || !position.IsLegalMove(GoGeometry<N>::Point(code % N, code / N))))
+            {
+                out.stopped += 1;
+                break;
+            }
+            int move = point ? GoGeometry<N>::Point(code % N, code / N) : PASS_MOVE;
+
+            // A skipped turn is not a decision, so it gets no sample
+            if (code != MOVE_CODE_SKIP)
+            {
+                auto start = Clock::now();
+                Stone winner = game.Winner();
+                int result = winner == EMPTY ? 0 : winner == position.CurrentPlayer() ? 1 : -1;
+                int first = mode == SYMMETRY_RANDOM ? random.Below(SYMMETRY_COUNT) : 0;
+                int symmetries = mode == SYMMETRY_ALL ? SYMMETRY_COUNT : 1;
+                for (int s = 0; s < symmetries; ++s)
+                {
+                    batch.Add(position, recent, recentCount, first + s, move, result);
+                    if (batch.IsFull())
+                    {
+                        out.extractTime += Clock::now() - start;
+                        if (!out.Flush(batch))
+                            return false;
+                        start = Clock::now();
+                    }
+                }
+                out.extractTime += Clock::now() - start;
+            }
+
+            auto start = Clock::now();
+            if (code == MOVE_CODE_SKIP)
+                position.TogglePlayer();
+            else if (!position.TryPlay(move))
+            {
+                out.stopped += 1;
+                break;
+            }
+            recentCount = std::min(recentCount + 1, FEATURE_HISTORY);
+            for (int k = recentCount - 1; k > 0; --k)
+                recent[k] = recent[k - 1];
+            recent[0] = move;
+            out.replayTime += Clock::now() - start;
+        }
+    }
+    return batch.Count() == 0 || out.Flush(batch);
+}
+
+static SymmetryMode ParseSymmetryMode(const char* text, bool& valid)
+{
+    if (std::strcmp(text, "random") == 0)
+        return SYMMETRY_RANDOM;
+    if (std::strcmp(text, "all") == 0)
+        return SYMMETRY_ALL;
+    valid = std::strcmp(text, "none") == 0;
+    return SYMMETRY_NONE;
+}
+
+int main(int argc, char* argv[])
+{
+    bool valid = argc >= 3;
+    int size = 0;
+    SymmetryMode mode = SYMMETRY_NONE;
+    long long maxGames = 0;
+    int batchSize = 4096;
+    for (int i = 3; i < argc && valid; i += 2)
+    {
+        if (i + 1 >= argc)
+            valid = false;
+        else if (std::strcmp(argv[i], "-size") == 0)
+            size = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-sym") == 0)
+            mode = ParseSymmetryMode(argv[i + 1], valid);
+        else if (std::strcmp(argv[i], "-games") == 0)
+            maxGames = std::atoll(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-batch") == 0)
+            batchSize = std::max(1, std::atoi(argv[i + 1]));
+        else
+            valid = false;
+    }
+    if (!valid)
+    {
+        std::fprintf(stderr,
+            "usage: GoExport <db.godb> <out prefix> [-size n] [-sym none|random|all] [-games n] [-batch n]\n");
+        return 2;
+    }
+
+    GoDatabase database;
+    if (!database.Open(argv[1]))
+    {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    if (size == 0 && database.GameCount() > 0)
+        size = database.Game(0).Size();
+    if (size != 9 && size != 13 && size != 19)
+    {
+        std::fprintf(stderr, "no games of a supported size\n");
+        return 1;
+    }
+
+    std::string prefix = argv[2];
+    Exporter out;
+    if (!out.features.Open((prefix + ".features.npy").c_str(), "|u1", { FEATURE_PLANES, size, size }) ||
+        !out.moves.Open((prefix + ".moves.npy").c_str(), "<i2", {}) ||
+        !out.results.Open((prefix + ".results.npy").c_str(), "|i1", {}))
+    {
+        std::fprintf(stderr, "cannot write %s.*.npy\n", prefix.c_str());
+        return 1;
+    }
+
+    auto start = Clock::now();
+    bool ok = size == 9 ? Export<9>(database, out, mode, maxGames, batchSize)
+        : size == 13 ? Export<13>(database, out, mode, maxGames, batchSize)
+        : Export<19>(database, out, mode, maxGames, batchSize);
+    ok = out.features.Close() && ok;
+    ok = out.moves.Close() && ok;
+    ok = out.results.Close() && ok;
+    double seconds = Seconds(Clock::now() - start);
+    if (!ok)
+    {
+        std::fprintf(stderr, "error writing %s.*.npy\n", prefix.c_str());
+        return 1;
+    }
+
+    long long samples = (long long)out.features.Count();
+    double megabytes = samples * (double)FEATURE_PLANES * size * size / 1e6;
+    std::printf("%lld games, %lld samples of %dx%d in %.2f s (%.0f samples/sec, %.1f MB)\n", out.games, samples,
+        size, size, seconds, seconds > 0 ? samples / seconds : 0, megabytes);
+    if (out.stopped > 0)
+        std::printf("%lld games stopped at an unplayable move; their later moves were left out\n", out.stopped);
+    std::printf("%-22s %10.3f s %10.1f ns/sample\n", "replay", Seconds(out.replayTime),
+        samples ? 1e9 * Seconds(out.replayTime) / samples : 0);
+    std::printf("%-22s %10.3f s %10.1f ns/sample\n", "extract", Seconds(out.extractTime),
+        samples ? 1e9 * Seconds(out.extractTime) / samples : 0);
+    std::printf("%-22s %10.3f s %10.1f ns/sample\n", "write", Seconds(out.writeTime),
+        samples ? 1e9 * Seconds(out.writeTime) / samples : 0);
+    return 0;
+}
@@ -0,0 +1,115 @@
+// GoFeatures.cpp : Implements feature plane extraction.
+//
+#include "GoFeatures.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Per-symmetry table from point index to plane index, -1 off the board
+template <int N>
+struct GoSymmetryTable
+{
+    short index[SYMMETRY_COUNT][GoGeometry<N>::POINTS];
+
+    GoSymmetryTable()
+    {
+        for (int s = 0; s < SYMMETRY_COUNT; ++s)
+        {
+            std::fill(index[s], index[s] + GoGeometry<N>::POINTS, (short)-1);
+            for (int y = 0; y < N; ++y)
+            {
+                for (int x = 0; x < N; ++x)
+                {
+                    int tx = s >= 4 ? N - 1 - x : x;
+                    int ty = y;
+                    for (int turn = 0; turn < s % 4; ++turn)
+                    {
+                        // Quarter turn clockwise
+                        int old = tx;
+                        tx = N - 1 - ty;
+                        ty = old;
+                    }
+                    index[s][GoGeometry<N>::Point(x, y)] = (short)(ty * N + tx);
+                }
+            }
+        }
+    }
+};
+
+template <int N>
+static const GoSymmetryTable<N>& SymmetryTable()
+{
+    static const GoSymmetryTable<N> table;
+    return table;
+}
+
+template <int N>
+int FeatureMoveIndex(int move, int symmetry)
+{
+    return move == PASS_MOVE ? N * N : SymmetryTable<N>().index[symmetry][move];
+}
+
+template <int N>
+void ExtractFeatures(const GoPositionT<N>& position, const int* recentMoves, int recentCount, int symmetry,
+    uint8_t* planes)
+{
+    const int area = N * N;
+    const short* index = SymmetryTable<N>().index[symmetry];
+    std::memset(planes, 0, FEATURE_PLANES * area);
+
+    short liberties[GoGeometry<N>::POINTS];
+    position.ChainLiberties(liberties);
+    Stone player = position.CurrentPlayer();
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            int point = GoGeometry<N>::Point(x, y);
+            Stone stone = position.AtPoint(point);
+            if (stone == EMPTY)
+                continue;
+            int side = stone == player ? 0 : 1;
+            int i = index[point];
+            planes[side * area + i] = 1;
+            planes[(2 + 4 * side + std::min<int>(liberties[point], 4) - 1) * area + i] = 1;
+        }
+    }
+
+    if (position.KoPoint() != 0)
+        planes[10 * area + index[position.KoPoint()]] = 1;
+    if (player == BLACK)
+        std::memset(planes + 11 * area, 1, area);
+    for (int k = 0; k < std::min(recentCount, FEATURE_HISTORY); ++k)
+    {
+        if (recentMoves[k] != PASS_MOVE)
+            planes[(12 + k) * area + index[recentMoves[k]]] = 1;
+    }
+}
+
+GoFeatureBatch::GoFeatureBatch(int size, int capacity)
+    : size(size), capacity(capacity), count(0),
+      features(new CacheLine[((std::size_t)capacity * FEATURE_PLANES * size * size + 63) / 64]),
+      moves(new int16_t[capacity]), results(new int8_t[capacity])
+{
+}
+
+template <int N>
+void GoFeatureBatch::Add(const GoPositionT<N>& position, const int* recentMoves, int recentCount, int symmetry,
+    int nextMove, int result)
+{
+    uint8_t* planes = features.get()->bytes + (std::size_t)count * SampleBytes();
+    ExtractFeatures(position, recentMoves, recentCount, symmetry, planes);
+    moves[count] = (int16_t)FeatureMoveIndex<N>(nextMove, symmetry);
+    results[count] = (int8_t)result;
+    count += 1;
+}
+
+template void ExtractFeatures(const GoPositionT<9>&, const int*, int, int, uint8_t*);
+template void ExtractFeatures(const GoPositionT<13>&, const int*, int, int, uint8_t*);
+template void ExtractFeatures(const GoPositionT<19>&, const int*, int, int, uint8_t*);
+template int FeatureMoveIndex<9>(int, int);
+template int FeatureMoveIndex<13>(int, int);
+template int FeatureMoveIndex<19>(int, int);
+template void GoFeatureBatch::Add(const GoPositionT<9>&, const int*, int, int, int, int);
+template void GoFeatureBatch::Add(const GoPositionT<13>&, const int*, int, int, int, int);
+template void GoFeatureBatch::Add(const GoPositionT<19>&, const int*, int, int, int, int);
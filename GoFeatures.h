@@ -0,0 +1,88 @@
+// GoFeatures.h : Input planes for training and running neural networks.
+//
+// ExtractFeatures turns a position into FEATURE_PLANES planes of N x N
+// bytes, each 0 or 1, plane after plane and row after row from the top:
+//
+//   0      stones of the player to move
+//   1      opponent stones
+//   2-5    player-to-move stones in chains of 1, 2, 3 and 4+ liberties
+//   6-9    opponent stones in chains of 1, 2, 3 and 4+ liberties
+//   10     the simple-ko point the player to move may not take
+//   11     all ones when Black is to move
+//   12-15  the last four moves, most recent first (empty for a pass)
+//
+// Liberties come from GoPosition::ChainLiberties, one sweep over the board,
+// so a position costs about as much as playing a move or two.
+//
+// Any of the 8 symmetries of the square can be applied on the way out,
+// for data augmentation, through a precomputed table of point indices:
+// symmetry 0 is the identity, 1 to 3 rotate by 90, 180 and 270 degrees and
+// 4 to 7 mirror left to right before rotating.
+//
+// GoFeatureBatch collects training samples (planes, the move played next
+// and the game result) in preallocated, cache-aligned arrays, laid out as
+// GoNpyWriter writes them.
+//
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "GoPosition.h"
+
+const int FEATURE_PLANES = 16;
+const int FEATURE_HISTORY = 4;
+const int SYMMETRY_COUNT = 8;
+
+// Function to fill FEATURE_PLANES * N * N bytes at planes. recentMoves
+// holds the moves that led to the position, most recent first (PASS_MOVE
+// for a pass); only the first FEATURE_HISTORY are used.
+template <int N>
+void ExtractFeatures(const GoPositionT<N>& position, const int* recentMoves, int recentCount, int symmetry,
+    uint8_t* planes);
+
+// Function to map a move to its index in a plane after a symmetry: y * N
+// + x for a point, N * N for a pass
+template <int N>
+int FeatureMoveIndex(int move, int symmetry);
+
+// Samples of one board size, written in place
+class GoFeatureBatch
+{
+public:
+    GoFeatureBatch(int size, int capacity);
+
+    int Size() const { return size; }
+    int Count() const { return count; }
+    int Capacity() const { return capacity; }
+    bool IsFull() const { return count == capacity; }
+    void Clear() { count = 0; }
+
+    // Bytes of planes per sample
+    int SampleBytes() const { return FEATURE_PLANES * size * size; }
+
+    // Add a sample: the position with a symmetry applied, the move played
+    // from it (see FeatureMoveIndex) and the result for the player to move
+    // (1 win, 0 draw, -1 loss). The batch must not be full.
+    template <int N>
+    void Add(const GoPositionT<N>& position, const int* recentMoves, int recentCount, int symmetry, int nextMove,
+        int result);
+
+    // Arrays of Count() samples; the planes start on a cache line
+    const uint8_t* Features() const { return features.get()->bytes; }
+    const int16_t* Moves() const { return moves.get(); }
+    const int8_t* Results() const { return results.get(); }
+
+private:
+    struct alignas(64) CacheLine
+    {
+        uint8_t bytes[64];
+    };
+
+    int size;
+    int capacity;
+    int count;
+    std::unique_ptr<CacheLine[]> features;
+    std::unique_ptr<int16_t[]> moves;
+    std::unique_ptr<int8_t[]> results;
+};
@@ -0,0 +1,135 @@
+// GoGame.cpp : Implements games on a board size chosen at runtime.
+//
+#include "GoGame.h"
+
+#include "GoBoard.h"
+#include "GoRandom.h"
+
+template <int N>
+class GoGameImpl : public GoGame
+{
+public:
+    GoGameImpl() : book(nullptr) {}
+
+    int Size() const override { return N; }
+
+    int Point(int x, int y) const override { return GoGeometry<N>::Point(x, y); }
+    int PointX(int point) const override { return GoGeometry<N>::PointX(point); }
+    int PointY(int point) const override { return GoGeometry<N>::PointY(point); }
+
+    int HoshiCount() const override { return GoGeometry<N>::HOSHI_COUNT; }
+    int HoshiPoint(int i) const override { return GoGeometry<N>::HoshiPoint(i); }
+
+    void Reset() override
+    {
+        board.Reset();
+        search.Reset();
+    }
+
+    Stone At(int x, int y) const override { return board.At(x, y); }
+    Stone CurrentPlayer() const override { return board.CurrentPlayer(); }
+    int BlackScore() const override { return board.BlackScore(); }
+    int WhiteScore() const override { return board.WhiteScore(); }
+    bool IsGameOver() const override { return board.IsGameOver(); }
+
+    bool PlaceStone(int x, int y) override
+    {
+        if (!board.PlaceStone(x, y))
+            return false;
+        if (!search.Play(GoGeometry<N>::Point(x, y)))
+            Resync();
+        return true;
+    }
+
+    void Pass() override
+    {
+        board.Pass();
+        if (!search.Play(PASS_MOVE))
+            Resync();
+    }
+
+    void TogglePlayer() override
+    {
+        board.TogglePlayer();
+        search.SkipTurn();
+    }
+
+    bool Undo() override
+    {
+        if (!board.Undo())
+            return false;
+        if (!search.Undo())
+            Resync();
+        return true;
+    }
+
+    GoAreaScore ScoreArea(double komi) const override { return ::ScoreArea(board, komi); }
+
+    GoOwnershipMap EstimateOwnership(const GoOwnershipOptions& options) const override
+    {
+        return ::EstimateOwnership(search.Position(), options);
+    }
+
+    const GoSearchOptions& SearchOptions() const override { return search.Options(); }
+    void SetSearchOptions(const GoSearchOptions& options) override { search.SetOptions(options); }
+    int SearchMove(const GoSearchLimits& limits) override { return search.Search(limits); }
+    void StopSearch() override { search.Stop(); }
+    void SetTranspositionTable(GoTransTable* table) override { search.SetTranspositionTable(table); }
+
+    bool SetOpeningBook(const GoBook* value) override
+    {
+        if (value && value->Size() != N)
+            return false;
+        book = value;
+        bookRandom.Seed(search.Options().seed);
+        return true;
+    }
+
+    int BookMove() override { return book ? book->ChooseMove(search.Position(), bookRandom) : PASS_MOVE; }
+
+private:
+    // Function to give the search the board's stones and player to move
+    // when the two copies disagree, as the bitboard layout and GoPosition
+    // could on a move's legality. The ko point, pass count and superko
+    // history before it are lost, so it is a last resort.
+    void Resync()
+    {
+        GoPositionT<N> position(search.Position().GetKoRule());
+        for (int y = 0; y < N; ++y)
+        {
+            for (int x = 0; x < N; ++x)
+            {
+                Stone stone = board.At(x, y);
+                if (stone != BLACK && stone != WHITE)
+                    continue;
+                if (position.CurrentPlayer() != stone)
+                    position.TogglePlayer();
+                position.PlaceStone(x, y);
+            }
+        }
+        if (position.CurrentPlayer() != board.CurrentPlayer())
+            position.TogglePlayer();
+        position.SetUndoEnabled(true);
+        search.SetPosition(position);
+    }
+
+    GoBoardT<N> board;
+    GoSearchT<N> search;
+    const GoBook* book;
+    GoRandom bookRandom;
+};
+
+std::unique_ptr<GoGame> CreateGoGame(int size)
+{
+    switch (size)
+    {
+    case 9:
+        return std::unique_ptr<GoGame>(new GoGameImpl<9>());
+    case 13:
+        return std::unique_ptr<GoGame>(new GoGameImpl<13>());
+    case 19:
+        return std::unique_ptr<GoGame>(new GoGameImpl<19>());
+    default:
+        return nullptr;
+    }
+}
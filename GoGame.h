@@ -0,0 +1,88 @@
+// GoGame.h : A game on a board size chosen at runtime.
+//
+// The engines are templates over the board size, so a front end that lets
+// the user pick the size cannot name one type for "the board". GoGame is
+// that type: an interface with one implementation per size in
+// GO_BOARD_SIZES, created by CreateGoGame. It bundles the position (a
+// GoBoardT<N>) with a computer player (a GoSearchT<N>) whose root follows
+// every move, pass, turn skip and undo made through it; should the root
+// ever refuse one the board accepted, it is set up again from the board's
+// stones.
+//
+// Moves are point indices of the game's own layout, as returned by Point;
+// they are not comparable between games of different sizes.
+//
+#pragma once
+
+#include <memory>
+
+#include "GoBook.h"
+#include "GoOwnership.h"
+#include "GoScore.h"
+#include "GoSearch.h"
+#include "GoTypes.h"
+
+class GoGame
+{
+public:
+    virtual ~GoGame() {}
+
+    // Number of lines on the board
+    virtual int Size() const = 0;
+
+    // Point index of column x, row y, and back
+    virtual int Point(int x, int y) const = 0;
+    virtual int PointX(int point) const = 0;
+    virtual int PointY(int point) const = 0;
+
+    // Star points, as point indices
+    virtual int HoshiCount() const = 0;
+    virtual int HoshiPoint(int i) const = 0;
+
+    // Clear the board, scores and pass count; Black to move
+    virtual void Reset() = 0;
+
+    virtual Stone At(int x, int y) const = 0;
+    virtual Stone CurrentPlayer() const = 0;
+    virtual int BlackScore() const = 0;
+    virtual int WhiteScore() const = 0;
+    virtual bool IsGameOver() const = 0;
+
+    // Same as the GoBoard calls of the same name
+    virtual bool PlaceStone(int x, int y) = 0;
+    virtual void Pass() = 0;
+    virtual void TogglePlayer() = 0;
+    virtual bool Undo() = 0;
+
+    // Tromp-Taylor area score of the current position
+    virtual GoAreaScore ScoreArea(double komi) const = 0;
+
+    // Ownership of every point and the dead stones, from playouts on from
+    // the current position, and the area score without the dead stones;
+    // meant for the end of the game, after both players passed
+    virtual GoOwnershipMap EstimateOwnership(const GoOwnershipOptions& options) const = 0;
+
+    // Computer player. SearchMove searches the current position and returns
+    // the best move, or PASS_MOVE; it may run on another thread as long as
+    // the game is not changed meanwhile, and StopSearch ends it early.
+    virtual const GoSearchOptions& SearchOptions() const = 0;
+    virtual void SetSearchOptions(const GoSearchOptions& options) = 0;
+    virtual int SearchMove(const GoSearchLimits& limits) = 0;
+    virtual void StopSearch() = 0;
+
+    // Transposition table the computer player shares results through; see
+    // GoSearch::SetTranspositionTable
+    virtual void SetTranspositionTable(GoTransTable* table) = 0;
+
+    // Opening book. BookMove returns a legal book move for the current
+    // position, chosen at random in proportion to how often it was played,
+    // or PASS_MOVE if the book has none; front ends ask it before calling
+    // SearchMove. A book of another size is refused. The book must stay
+    // open while it is set; null removes it.
+    virtual bool SetOpeningBook(const GoBook* book) = 0;
+    virtual int BookMove() = 0;
+};
+
+// Function to create a game of the given size; null if the size is not
+// one of GO_BOARD_SIZES
+std::unique_ptr<GoGame> CreateGoGame(int size);
@@ -0,0 +1,140 @@
+// GoGtp.cpp : Plays Go over the Go Text Protocol on stdin and stdout.
+//
+// Usage: GoGtp [-t threads] [-s seconds per move] [-m tree MB] [-book file]... [-tt MB]
+//              [-tt-shared name] [-patterns file|default] [-ladders] [-metrics-json file]
+//              [--no-ponder]
+//
+// Connect it to a GTP controller such as GoGui, Sabaki or gogui-twogtp.
+// The seconds per move apply until the controller sends time_settings.
+// Between moves the engine ponders, keeping the search threads busy while
+// the opponent thinks; --no-ponder leaves them idle instead. Opening books
+// (see GoDb book), one per board size, are played from before searching.
+// -tt gives the search a transposition table of that many megabytes (64 by
+// default with -tt-shared), and -tt-shared puts it in the named shared
+// memory segment, so that engines started with the same name pool their
+// results. -patterns draws the playouts' moves by the 3x3 pattern weights
+// in the file, or the built-in ones (see GoPattern.h). -ladders reads
+// ladders when the tree grows and leaves out escapes that cannot work (see
+// GoTactics.h). -metrics-json writes the engine metrics (see GoMetrics.h) to
+// the file as JSON when the controller quits.
+//
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "GoGtpEngine.h"
+#include "GoMetrics.h"
+#include "GoPattern.h"
+#include "GoTransTable.h"
+
+int main(int argc, char* argv[])
+{
+    GoSearchOptions options;
+    double seconds = 5.0;
+    bool ponder = true;
+    std::vector<std::unique_ptr<GoBook>> books;
+    int tableMegabytes = 0;
+    const char* tableName = nullptr;
+    const char* metricsFile = nullptr;
+    GoPatternWeights patterns;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            seconds = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+        {
+            options.treeMemory = (std::size_t)std::max(1, std::atoi(argv[++i])) << 20;
+        }
+        else if (std::strcmp(argv[i], "-book") == 0 && i + 1 < argc)
+        {
+            books.emplace_back(new GoBook());
+            if (!books.back()->Open(argv[++i]))
+            {
+                std::fprintf(stderr, "cannot open book %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "-tt") == 0 && i + 1 < argc)
+        {
+            tableMegabytes = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "-tt-shared") == 0 && i + 1 < argc)
+        {
+            tableName = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "-patterns") == 0 && i + 1 < argc)
+        {
+            const char* path = argv[++i];
+            if (std::strcmp(path, "default") == 0)
+                patterns.SetDefaults();
+            else if (!patterns.Load(path))
+            {
+                std::fprintf(stderr, "cannot read patterns %s, line %d\n", path, patterns.ErrorLine());
+                return 1;
+            }
+            options.patterns = &patterns;
+        }
+        else if (std::strcmp(argv[i], "-ladders") == 0)
+        {
+            options.readLadders = true;
+        }
+        else if (std::strcmp(argv[i], "-metrics-json") == 0 && i + 1 < argc)
+        {
+            metricsFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--no-ponder") == 0)
+        {
+            ponder = false;
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: GoGtp [-t threads] [-s seconds per move] [-m tree MB] [-book file]... "
+                "[-tt MB] [-tt-shared name] [-patterns file|default] [-ladders] [-metrics-json file] "
+                "[--no-ponder]\n");
+            return 2;
+        }
+    }
+
+    GoTransTable table;
+    if (tableName || tableMegabytes > 0)
+    {
+        std::size_t bytes = (std::size_t)(tableMegabytes > 0 ? tableMegabytes : 64) << 20;
+        if (tableName ? !table.OpenShared(tableName, bytes) : !table.Create(bytes))
+        {
+            std::fprintf(stderr, "cannot set up the transposition table\n");
+            return 1;
+        }
+    }
+
+    GoGtpEngine engine(stdin, stdout);
+    engine.SetSearchOptions(options);
+    engine.SetSecondsPerMove(seconds);
+    engine.SetPondering(ponder);
+    for (const std::unique_ptr<GoBook>& book : books)
+        engine.AddOpeningBook(book.get());
+    if (table.IsOpen())
+        engine.SetTranspositionTable(&table);
+    engine.Run();
+
+    if (metricsFile)
+    {
+        std::FILE* file = std::fopen(metricsFile, "w");
+        if (file == nullptr)
+        {
+            std::fprintf(stderr, "cannot write %s\n", metricsFile);
+            return 1;
+        }
+        std::fprintf(file, "%s\n", MetricsJson(CollectMetrics()).c_str());
+        std::fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,582 @@
+// GoGtpEngine.cpp : Implements the GTP front end.
+//
+#include "GoGtpEngine.h"
+
+#include "GoMetrics.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// Column letters; GTP skips I
+static const char COLUMN_LETTERS[] = "ABCDEFGHJKLMNOPQRST";
+
+// Seconds kept back from every move for the controller's overhead
+static const double TIME_RESERVE = 0.1;
+
+// Moves each player is assumed to have left, at least, when sharing out
+// the main time
+static const int MIN_MOVES_LEFT = 10;
+
+static std::string Lowercase(std::string text)
+{
+    for (char& c : text)
+        c = (char)std::tolower((unsigned char)c);
+    return text;
+}
+
+static bool ParseNumber(const std::string& text, double& value)
+{
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0';
+}
+
+static bool ParseInteger(const std::string& text, long long& value)
+{
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0';
+}
+
+GoGtpEngine::GoGtpEngine(std::FILE* input, std::FILE* output)
+    : input(input), output(output), game(CreateGoGame(19)), table(nullptr), pondering(true), secondsPerMove(5.0),
+      timeControlled(false), inputClosed(false), commandPending(false)
+{
+    RegisterCommands();
+}
+
+void GoGtpEngine::SetSearchOptions(const GoSearchOptions& options)
+{
+    game->SetSearchOptions(options);
+}
+
+void GoGtpEngine::AddOpeningBook(const GoBook* book)
+{
+    books.push_back(book);
+    game->SetOpeningBook(book);
+}
+
+void GoGtpEngine::SetTranspositionTable(GoTransTable* value)
+{
+    table = value;
+    game->SetTranspositionTable(table);
+}
+
+void GoGtpEngine::AddCommand(const std::string& name, const Handler& handler)
+{
+    commands[name] = handler;
+}
+
+// Function to serve commands, pondering whenever none is waiting
+void GoGtpEngine::Run()
+{
+    std::thread reader(&GoGtpEngine::ReadCommands, this);
+    for (;;)
+    {
+        std::string line;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (lines.empty() && !inputClosed && (!pondering || game->IsGameOver()))
+                commandReady.wait(lock, [this]() { return !lines.empty() || inputClosed; });
+            if (lines.empty() && inputClosed)
+                break;
+            if (!lines.empty())
+            {
+                line = std::move(lines.front());
+                lines.pop_front();
+                commandPending.store(!lines.empty() || inputClosed);
+            }
+        }
+        if (line.empty())
+        {
+            Ponder();
+            continue;
+        }
+
+        Command command;
+        if (!ParseCommand(line, command))
+            continue;
+        if (command.name == "quit")
+        {
+            Respond(command, true, "");
+            break;
+        }
+        auto handler = commands.find(command.name);
+        if (handler == commands.end())
+        {
+            Respond(command, false, "unknown command");
+            continue;
+        }
+        std::string response;
+        bool success = handler->second(command.args, response);
+        Respond(command, success, response);
+    }
+    reader.join();
+}
+
+// Function to read lines on the reader thread until quit or end of input.
+// Lines that hold no command are dropped here, so every queued line gets
+// a response.
+void GoGtpEngine::ReadCommands()
+{
+    std::string line;
+    char buffer[1024];
+    bool quit = false;
+    while (!quit && std::fgets(buffer, sizeof buffer, input))
+    {
+        line += buffer;
+        if (line.back() != '\n' && !std::feof(input))
+            continue;
+
+        Command command;
+        if (ParseCommand(line, command))
+        {
+            quit = command.name == "quit";
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+            commandPending.store(true);
+            commandReady.notify_one();
+        }
+        line.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    inputClosed = true;
+    commandPending.store(true);
+    commandReady.notify_one();
+}
+
+// Function to split a line into id, name and arguments. Comments are
+// removed and tabs and other control characters read as spaces; false
+// for a line with no command.
+bool GoGtpEngine::ParseCommand(const std::string& line, Command& command) const
+{
+    std::string text = line.substr(0, line.find('#'));
+    for (char& c : text)
+    {
+        if ((unsigned char)c < 32 || c == 127)
+            c = ' ';
+    }
+
+    std::vector<std::string> words;
+    std::size_t start = text.find_first_not_of(' ');
+    while (start != std::string::npos)
+    {
+        std::size_t end = text.find(' ', start);
+        words.push_back(text.substr(start, end - start));
+        start = end == std::string::npos ? end : text.find_first_not_of(' ', end);
+    }
+    if (words.empty())
+        return false;
+
+    long long id = 0;
+    command.hasId = std::isdigit((unsigned char)words[0][0]) && ParseInteger(words[0], id);
+    command.id = id;
+    if (command.hasId)
+        words.erase(words.begin());
+    if (words.empty())
+        return false;
+    command.name = words[0];
+    command.args.assign(words.begin() + 1, words.end());
+    return true;
+}
+
+void GoGtpEngine::Respond(const Command& command, bool success, const std::string& text)
+{
+    std::string head = success ? "=" : "?";
+    if (command.hasId)
+        head += std::to_string(command.id);
+    std::fprintf(output, "%s%s%s\n\n", head.c_str(), text.empty() ? "" : " ", text.c_str());
+    std::fflush(output);
+}
+
+// Function to search the current position until a command arrives
+void GoGtpEngine::Ponder()
+{
+    GoSearchLimits limits;
+    limits.stop = &commandPending;
+    game->SearchMove(limits);
+}
+
+bool GoGtpEngine::ParseColor(const std::string& text, Stone& color) const
+{
+    std::string name = Lowercase(text);
+    if (name == "b" || name == "black")
+        color = BLACK;
+    else if (name == "w" || name == "white")
+        color = WHITE;
+    else
+        return false;
+    return true;
+}
+
+// Function to read a vertex such as "D4"; x is -1 for a pass. Rows count
+// up from the bottom edge, as seen by Black.
+bool GoGtpEngine::ParseVertex(const std::string& text, int& x, int& y) const
+{
+    std::string name = Lowercase(text);
+    if (name == "pass")
+    {
+        x = -1;
+        y = -1;
+        return true;
+    }
+    if (name.size() < 2)
+        return false;
+
+    const char* column = std::strchr(COLUMN_LETTERS, std::toupper((unsigned char)name[0]));
+    long long row = 0;
+    if (!column || !ParseInteger(name.substr(1), row))
+        return false;
+    x = (int)(column - COLUMN_LETTERS);
+    y = game->Size() - (int)row;
+    return x < game->Size() && row >= 1 && row <= game->Size();
+}
+
+std::string GoGtpEngine::FormatVertex(int move) const
+{
+    if (move == PASS_MOVE)
+        return "pass";
+    return COLUMN_LETTERS[game->PointX(move)] + std::to_string(game->Size() - game->PointY(move));
+}
+
+// Function to choose the thinking time for the next move of a player
+double GoGtpEngine::MoveSeconds(Stone color) const
+{
+    const Clock& clock = clocks[color == WHITE];
+    bool unlimited = clock.byoYomiTime > 0 && clock.byoYomiStones == 0;
+    if (!timeControlled || unlimited)
+        return secondsPerMove;
+
+    double seconds;
+    if (clock.stonesLeft > 0)
+    {
+        // Byo-yomi: split the period evenly over its stones
+        seconds = clock.timeLeft / clock.stonesLeft;
+    }
+    else
+    {
+        // Main time: share it over the moves likely to come, with a
+        // player filling about a third of the empty points
+        int empty = 0;
+        for (int y = 0; y < game->Size(); ++y)
+            for (int x = 0; x < game->Size(); ++x)
+                empty += game->At(x, y) == EMPTY;
+        seconds = clock.timeLeft / std::max(MIN_MOVES_LEFT, empty / 3);
+        if (clock.byoYomiStones > 0)
+            seconds += 0.5 * clock.byoYomiTime / clock.byoYomiStones;
+    }
+    return std::max(0.01, seconds - TIME_RESERVE);
+}
+
+// Function to keep a player's clock between time_left commands, which
+// controllers do not always send
+void GoGtpEngine::ChargeTime(Stone color, double seconds)
+{
+    Clock& clock = clocks[color == WHITE];
+    if (!timeControlled)
+        return;
+
+    clock.timeLeft -= seconds;
+    if (clock.stonesLeft > 0)
+    {
+        clock.stonesLeft -= 1;
+        if (clock.stonesLeft == 0)
+        {
+            clock.timeLeft = clock.byoYomiTime;
+            clock.stonesLeft = clock.byoYomiStones;
+        }
+    }
+    else if (clock.timeLeft <= 0 && clock.byoYomiStones > 0)
+    {
+        clock.timeLeft = clock.byoYomiTime;
+        clock.stonesLeft = clock.byoYomiStones;
+    }
+    clock.timeLeft = std::max(0.0, clock.timeLeft);
+}
+
+void GoGtpEngine::RegisterCommands()
+{
+    using namespace std::placeholders;
+    AddCommand("protocol_version", [](const std::vector<std::string>&, std::string& response) {
+        response = "2";
+        return true;
+    });
+    AddCommand("name", [](const std::vector<std::string>&, std::string& response) {
+        response = "Go_Game";
+        return true;
+    });
+    AddCommand("version", [](const std::vector<std::string>&, std::string& response) {
+        response = "1.0";
+        return true;
+    });
+    AddCommand("known_command", [this](const std::vector<std::string>& args, std::string& response) {
+        response = !args.empty() && (args[0] == "quit" || commands.count(args[0])) ? "true" : "false";
+        return true;
+    });
+    AddCommand("list_commands", [this](const std::vector<std::string>&, std::string& response) {
+        response.clear();
+        for (const auto& command : commands)
+            response += command.first + "\n";
+        response += "quit";
+        return true;
+    });
+    AddCommand("boardsize", std::bind(&GoGtpEngine::BoardSize, this, _1, _2));
+    AddCommand("clear_board", std::bind(&GoGtpEngine::ClearBoard, this, _1, _2));
+    AddCommand("komi", std::bind(&GoGtpEngine::Komi, this, _1, _2));
+    AddCommand("play", std::bind(&GoGtpEngine::Play, this, _1, _2));
+    AddCommand("genmove", std::bind(&GoGtpEngine::GenMove, this, _1, _2));
+    AddCommand("undo", std::bind(&GoGtpEngine::Undo, this, _1, _2));
+    AddCommand("final_score", std::bind(&GoGtpEngine::FinalScore, this, _1, _2));
+    AddCommand("time_settings", std::bind(&GoGtpEngine::TimeSettings, this, _1, _2));
+    AddCommand("time_left", std::bind(&GoGtpEngine::TimeLeft, this, _1, _2));
+    AddCommand("showboard", std::bind(&GoGtpEngine::ShowBoard, this, _1, _2));
+    AddCommand("go_metrics", std::bind(&GoGtpEngine::Metrics, this, _1, _2));
+}
+
+bool GoGtpEngine::BoardSize(const std::vector<std::string>& args, std::string& response)
+{
+    long long size = 0;
+    if (args.empty() || !ParseInteger(args[0], size))
+    {
+        response = "boardsize not an integer";
+        return false;
+    }
+    std::unique_ptr<GoGame> sized = CreateGoGame((int)size);
+    if (!sized)
+    {
+        response = "unacceptable size";
+        return false;
+    }
+    sized->SetSearchOptions(game->SearchOptions());
+    for (const GoBook* book : books)
+        sized->SetOpeningBook(book);
+    sized->SetTranspositionTable(table);
+    game = std::move(sized);
+    undoSkips.clear();
+    return true;
+}
+
+bool GoGtpEngine::ClearBoard(const std::vector<std::string>&, std::string&)
+{
+    game->Reset();
+    undoSkips.clear();
+    for (Clock& clock : clocks)
+        clock.Restart();
+    return true;
+}
+
+// Function to set the komi; a new one drops the search tree (see
+// GoSearch::SetOptions), whose win rates were counted with the old one
+bool GoGtpEngine::Komi(const std::vector<std::string>& args, std::string& response)
+{
+    double komi = 0;
+    if (args.empty() || !ParseNumber(args[0], komi))
+    {
+        response = "syntax error";
+        return false;
+    }
+    GoSearchOptions options = game->SearchOptions();
+    options.komi = komi;
+    game->SetSearchOptions(options);
+    return true;
+}
+
+// Function to play a move for either color. A move out of turn skips the
+// other player's turn first; the skip is undone if the move is illegal,
+// and otherwise taken back by undo together with the move.
+bool GoGtpEngine::Play(const std::vector<std::string>& args, std::string& response)
+{
+    Stone color;
+    int x, y;
+    if (args.size() < 2 || !ParseColor(args[0], color) || !ParseVertex(args[1], x, y))
+    {
+        response = "invalid color or coordinate";
+        return false;
+    }
+
+    bool skipped = game->CurrentPlayer() != color;
+    if (skipped)
+        game->TogglePlayer();
+    if (x < 0)
+    {
+        game->Pass();
+        undoSkips.push_back(skipped);
+        return true;
+    }
+    if (!game->PlaceStone(x, y))
+    {
+        if (skipped)
+            game->Undo();
+        response = "illegal move";
+        return false;
+    }
+    undoSkips.push_back(skipped);
+    return true;
+}
+
+bool GoGtpEngine::GenMove(const std::vector<std::string>& args, std::string& response)
+{
+    Stone color;
+    if (args.empty() || !ParseColor(args[0], color))
+    {
+        response = "invalid color";
+        return false;
+    }
+    bool skipped = game->CurrentPlayer() != color;
+    if (skipped)
+        game->TogglePlayer();
+
+    auto start = std::chrono::steady_clock::now();
+    GoSearchLimits limits;
+    limits.seconds = MoveSeconds(color);
+    int move = game->BookMove();
+    if (move == PASS_MOVE)
+        move = game->SearchMove(limits);
+    if (move == PASS_MOVE)
+        game->Pass();
+    else
+        game->PlaceStone(game->PointX(move), game->PointY(move));
+    undoSkips.push_back(skipped);
+    ChargeTime(color, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    response = FormatVertex(move);
+    return true;
+}
+
+// Function to take back the last move, and the turn skip that came with
+// it if it was played out of turn
+bool GoGtpEngine::Undo(const std::vector<std::string>&, std::string& response)
+{
+    if (!game->Undo())
+    {
+        response = "cannot undo";
+        return false;
+    }
+    if (!undoSkips.empty())
+    {
+        if (undoSkips.back())
+            game->Undo();
+        undoSkips.pop_back();
+    }
+    return true;
+}
+
+// Function to score the game by area with the stones playouts find dead
+// taken off, as the desktop client does (see GoOwnership.h)
+bool GoGtpEngine::FinalScore(const std::vector<std::string>&, std::string& response)
+{
+    GoOwnershipOptions options;
+    options.komi = game->SearchOptions().komi;
+    options.patterns = game->SearchOptions().patterns;
+    GoAreaScore score = game->EstimateOwnership(options).score;
+    double margin = score.Margin();
+    if (margin == 0)
+    {
+        response = "0";
+        return true;
+    }
+    char text[32];
+    std::snprintf(text, sizeof text, "%c+%g", margin > 0 ? 'B' : 'W', std::abs(margin));
+    response = text;
+    return true;
+}
+
+// Function to set the time control of both players: main time, then
+// byo-yomi periods of the given seconds for the given number of stones
+bool GoGtpEngine::TimeSettings(const std::vector<std::string>& args, std::string& response)
+{
+    double mainTime, byoYomiTime;
+    long long byoYomiStones;
+    if (args.size() < 3 || !ParseNumber(args[0], mainTime) || !ParseNumber(args[1], byoYomiTime) ||
+        !ParseInteger(args[2], byoYomiStones) || mainTime < 0 || byoYomiTime < 0 || byoYomiStones < 0)
+    {
+        response = "syntax error";
+        return false;
+    }
+
+    timeControlled = true;
+    for (Clock& clock : clocks)
+    {
+        clock.mainTime = mainTime;
+        clock.byoYomiTime = byoYomiTime;
+        clock.byoYomiStones = (int)byoYomiStones;
+        clock.Restart();
+    }
+    return true;
+}
+
+bool GoGtpEngine::TimeLeft(const std::vector<std::string>& args, std::string& response)
+{
+    Stone color;
+    double seconds;
+    long long stones;
+    if (args.size() < 3 || !ParseColor(args[0], color) || !ParseNumber(args[1], seconds) ||
+        !ParseInteger(args[2], stones))
+    {
+        response = "syntax error";
+        return false;
+    }
+    Clock& clock = clocks[color == WHITE];
+    clock.timeLeft = seconds;
+    clock.stonesLeft = (int)stones;
+    return true;
+}
+
+bool GoGtpEngine::ShowBoard(const std::vector<std::string>&, std::string& response)
+{
+    int size = game->Size();
+    std::string letters = "  ";
+    for (int x = 0; x < size; ++x)
+    {
+        letters += ' ';
+        letters += COLUMN_LETTERS[x];
+    }
+
+    response = "\n" + letters + "\n";
+    for (int y = 0; y < size; ++y)
+    {
+        char row[8];
+        std::snprintf(row, sizeof row, "%2d", size - y);
+        response += row;
+        for (int x = 0; x < size; ++x)
+        {
+            Stone stone = game->At(x, y);
+            response += ' ';
+            response += stone == BLACK ? 'X' : stone == WHITE ? 'O' : '.';
+        }
+        response += ' ';
+        response += row;
+        response += '\n';
+    }
+    response += letters;
+    return true;
+}
+
+bool GoGtpEngine::Metrics(const std::vector<std::string>& args, std::string& response)
+{
+    std::string mode = args.empty() ? "text" : args[0];
+    if (mode == "reset")
+    {
+        ResetMetrics();
+        response.clear();
+        return true;
+    }
+    if (mode == "json")
+    {
+        response = MetricsJson(CollectMetrics());
+        return true;
+    }
+    if (mode != "text")
+    {
+        response = "go_metrics takes text, json or reset";
+        return false;
+    }
+    response = "\n" + MetricsText(CollectMetrics());
+    return true;
+}
@@ -0,0 +1,136 @@
+// GoGtpEngine.h : Go Text Protocol front end for the computer player.
+//
+// GoGtpEngine speaks GTP version 2 to a controller (a GUI, a tournament
+// manager or another engine) over a pair of streams, normally stdin and
+// stdout. A reader thread parses the incoming lines into commands and
+// queues them; the engine thread runs them one at a time and writes the
+// responses in order.
+//
+// While no command is waiting the engine ponders: it keeps searching the
+// current position, usually with the opponent to move, so the tree already
+// holds statistics for the reply when the opponent's move arrives. A
+// queued command ends the ponder search through the stop flag of
+// GoSearchLimits. `play` then keeps the subtree of the move played (see
+// GoSearch::Play) and drops the rest, and `genmove` searches on from there.
+//
+// genmove plays from the opening book (see GoBook) while the position is
+// in it and searches only once it is not; books of each board size can be
+// added, and the one matching the current size is used.
+//
+// `go_metrics` reports the engine's counters and timings (see GoMetrics.h)
+// as text, or as JSON with `go_metrics json`; `go_metrics reset` zeroes
+// them. Without GO_METRICS it says so.
+//
+// Extra commands are added with AddCommand and show up in list_commands.
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GoGame.h"
+
+class GoGtpEngine
+{
+public:
+    GoGtpEngine(std::FILE* input, std::FILE* output);
+
+    // Settings; call before Run
+    void SetPondering(bool enabled) { pondering = enabled; }
+    void SetSecondsPerMove(double seconds) { secondsPerMove = seconds; }
+    void SetSearchOptions(const GoSearchOptions& options);
+    void AddOpeningBook(const GoBook* book);
+    void SetTranspositionTable(GoTransTable* table);
+
+    // A command handler gets the arguments after the command name and sets
+    // the response text; it returns false to send the text as an error
+    typedef std::function<bool(const std::vector<std::string>& args, std::string& response)> Handler;
+    void AddCommand(const std::string& name, const Handler& handler);
+
+    // The game commands act on; replaced by boardsize
+    GoGame& Game() { return *game; }
+
+    // Serve commands until quit or the end of the input
+    void Run();
+
+private:
+    struct Command
+    {
+        bool hasId;
+        long long id;
+        std::string name;
+        std::vector<std::string> args;
+    };
+
+    // Time control from time_settings and time_left, for one player
+    struct Clock
+    {
+        double mainTime = 0;
+        double byoYomiTime = 0;
+        int byoYomiStones = 0;
+        double timeLeft = 0;
+        int stonesLeft = 0;     // stones to play in this byo-yomi period; 0 in main time
+
+        // Function to set the clock back to the start of the game
+        void Restart()
+        {
+            timeLeft = mainTime > 0 ? mainTime : byoYomiTime;
+            stonesLeft = mainTime > 0 ? 0 : byoYomiStones;
+        }
+    };
+
+    void ReadCommands();
+    bool ParseCommand(const std::string& line, Command& command) const;
+    void Respond(const Command& command, bool success, const std::string& text);
+    void Ponder();
+
+    bool ParseColor(const std::string& text, Stone& color) const;
+    bool ParseVertex(const std::string& text, int& x, int& y) const;
+    std::string FormatVertex(int move) const;
+    double MoveSeconds(Stone color) const;
+    void ChargeTime(Stone color, double seconds);
+    void RegisterCommands();
+
+    bool BoardSize(const std::vector<std::string>& args, std::string& response);
+    bool ClearBoard(const std::vector<std::string>& args, std::string& response);
+    bool Komi(const std::vector<std::string>& args, std::string& response);
+    bool Play(const std::vector<std::string>& args, std::string& response);
+    bool GenMove(const std::vector<std::string>& args, std::string& response);
+    bool Undo(const std::vector<std::string>& args, std::string& response);
+    bool FinalScore(const std::vector<std::string>& args, std::string& response);
+    bool TimeSettings(const std::vector<std::string>& args, std::string& response);
+    bool TimeLeft(const std::vector<std::string>& args, std::string& response);
+    bool ShowBoard(const std::vector<std::string>& args, std::string& response);
+    bool Metrics(const std::vector<std::string>& args, std::string& response);
+
+    std::FILE* input;
+    std::FILE* output;
+    std::unique_ptr<GoGame> game;
+    std::map<std::string, Handler> commands;
+    std::vector<const GoBook*> books;
+    GoTransTable* table;
+    bool pondering;
+    double secondsPerMove;
+    bool timeControlled;
+    Clock clocks[2];            // Black, White
+
+    // For every move made by play and genmove, whether it was out of turn
+    // and skipped the other player's turn first, which undo takes back too
+    std::vector<bool> undoSkips;
+
+    // Filled by the reader thread. commandPending is set while the queue
+    // is not empty and serves as the stop flag of ponder searches.
+    std::mutex mutex;
+    std::condition_variable commandReady;
+    std::deque<std::string> lines;
+    bool inputClosed;
+    std::atomic<bool> commandPending;
+};
@@ -0,0 +1,189 @@
+// GoInfluence.cpp : Implements the influence map and its worker.
+//
+#include "GoInfluence.h"
+
+#include <chrono>
+#include <cstdlib>
+
+#include "GoGame.h"
+
+GoInfluence::GoInfluence(int size, int radius)
+    : size(0), radius(radius > 0 ? radius : 1), blackArea(0), whiteArea(0)
+{
+    for (int dy = -this->radius; dy <= this->radius; ++dy)
+    {
+        int width = this->radius - std::abs(dy);
+        for (int dx = -width; dx <= width; ++dx)
+            reach.push_back({ dx, dy, this->radius + 1 - std::abs(dx) - std::abs(dy) });
+    }
+    Reset(size);
+}
+
+void GoInfluence::Reset(int size)
+{
+    this->size = size > 0 ? size : 0;
+    std::size_t cells = (std::size_t)this->size * this->size;
+    stones.assign(cells, EMPTY);
+    influence.assign(cells, 0);
+    owners.assign(cells, EMPTY);
+    blackArea = 0;
+    whiteArea = 0;
+}
+
+int GoInfluence::Update(const Stone* stones)
+{
+    int changed = 0;
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            std::size_t cell = (std::size_t)y * size + x;
+            Stone stone = stones[cell] == BLACK || stones[cell] == WHITE ? stones[cell] : EMPTY;
+            Stone& last = this->stones[cell];
+            if (stone == last)
+                continue;
+            Spread(x, y, last, -1);
+            last = stone;
+            Spread(x, y, stone, 1);
+            Judge(cell);
+            changed += 1;
+        }
+    }
+    return changed;
+}
+
+void GoInfluence::Recompute(const Stone* stones)
+{
+    Reset(size);
+    Update(stones);
+}
+
+// Function to add (sign 1) or take off (sign -1) the influence of a stone
+// on (x, y) and re-judge the points it reaches
+void GoInfluence::Spread(int x, int y, Stone stone, int sign)
+{
+    if (stone != BLACK && stone != WHITE)
+        return;
+    int amount = stone == BLACK ? sign : -sign;
+    for (const Reach& r : reach)
+    {
+        int px = x + r.dx;
+        int py = y + r.dy;
+        if (px < 0 || px >= size || py < 0 || py >= size)
+            continue;
+        std::size_t cell = (std::size_t)py * size + px;
+        influence[cell] += amount * r.weight;
+        Judge(cell);
+    }
+}
+
+// Function to decide who owns a point and keep the area counts with it
+void GoInfluence::Judge(std::size_t cell)
+{
+    Stone owner = stones[cell];
+    if (owner == EMPTY)
+        owner = influence[cell] > 0 ? BLACK : influence[cell] < 0 ? WHITE : EMPTY;
+    Stone& last = owners[cell];
+    if (owner == last)
+        return;
+    blackArea += (owner == BLACK) - (last == BLACK);
+    whiteArea += (owner == WHITE) - (last == WHITE);
+    last = owner;
+}
+
+GoInfluenceWorker::GoInfluenceWorker(double komi, int radius)
+    : komi(komi), influence(0, radius), pendingSize(0), hasPending(false), busy(false), stopping(false)
+{
+    thread = std::thread(&GoInfluenceWorker::Run, this);
+}
+
+GoInfluenceWorker::~GoInfluenceWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        changed.notify_all();
+    }
+    thread.join();
+}
+
+void GoInfluenceWorker::SetReadyCallback(std::function<void()> ready)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->ready = std::move(ready);
+}
+
+void GoInfluenceWorker::Submit(int size, const Stone* stones)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.assign(stones, stones + (std::size_t)size * size);
+    pendingSize = size;
+    hasPending = true;
+    changed.notify_all();
+}
+
+void GoInfluenceWorker::Submit(const GoGame& game)
+{
+    int size = game.Size();
+    std::vector<Stone> stones((std::size_t)size * size);
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+            stones[(std::size_t)y * size + x] = game.At(x, y);
+    }
+    Submit(size, stones.data());
+}
+
+void GoInfluenceWorker::Wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return !hasPending && !busy; });
+}
+
+GoInfluenceMap GoInfluenceWorker::Latest() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return latest;
+}
+
+// Function to map the latest board handed over until told to stop
+void GoInfluenceWorker::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        changed.wait(lock, [this]() { return hasPending || stopping; });
+        if (stopping)
+            return;
+        std::vector<Stone> stones;
+        stones.swap(pending);
+        int size = pendingSize;
+        hasPending = false;
+        busy = true;
+        lock.unlock();
+
+        // A board of another size starts from empty; others only update
+        // around what changed
+        auto start = std::chrono::steady_clock::now();
+        if (size != influence.Size())
+            influence.Reset(size);
+        GoInfluenceMap map;
+        map.pointsChanged = influence.Update(stones.data());
+        map.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        map.size = size;
+        map.influence = influence.Influences();
+        map.owners = influence.Owners();
+        map.score = influence.Score(komi);
+
+        lock.lock();
+        map.serial = latest.serial + 1;
+        latest = std::move(map);
+        busy = false;
+        std::function<void()> callback = ready;
+        lock.unlock();
+        if (callback)
+            callback();
+        lock.lock();
+        changed.notify_all();
+    }
+}
@@ -0,0 +1,141 @@
+// GoInfluence.h : Live influence map and score estimate, kept up to date
+// move by move.
+//
+// Every stone spreads influence over the points within radius steps of
+// it (Manhattan distance), radius + 1 - d at distance d, positive for
+// Black and negative for White. An empty point belongs to the colour with
+// the larger sum, a stone to its own colour, and the estimate is the area
+// count of those owners; a point whose sum is 0 belongs to nobody. This
+// is a quick reading of who surrounds what, with no notion of life and
+// death or of walls blocking influence, not a final score (see
+// GoOwnership.h for that).
+//
+// GoInfluence keeps the stones it last saw. Update compares them with the
+// new ones and, for each point that changed (the move, its captures, the
+// stones an undo put back), takes the old stone's influence off the points
+// around it and adds the new one's, re-judging only those points; a move
+// touches about 2 * radius * (radius + 1) + 1 points, whatever the board.
+//
+// GoInfluenceWorker runs a GoInfluence on its own thread for front ends
+// that must not block: Submit hands over the stones and returns, and the
+// worker calls back once the new map is ready. Submits that arrive while
+// it is busy replace each other, so it always works on the latest board.
+//
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "GoScore.h"
+#include "GoTypes.h"
+
+class GoGame;
+
+// A finished influence map, as the worker hands it out
+struct GoInfluenceMap
+{
+    int size = 0;
+    std::vector<int> influence;     // by point, row by row; positive for Black
+    std::vector<Stone> owners;      // BLACK, WHITE or EMPTY for nobody
+    GoAreaScore score = { 0, 0, 0 };
+    int pointsChanged = 0;          // stones that changed since the map before
+    long long serial = 0;           // maps made so far, this one included
+    double seconds = 0;             // time Update took
+
+    int Influence(int x, int y) const { return influence[(std::size_t)y * size + x]; }
+    Stone Owner(int x, int y) const { return owners[(std::size_t)y * size + x]; }
+};
+
+class GoInfluence
+{
+public:
+    explicit GoInfluence(int size = 19, int radius = 4);
+
+    // Start over on an empty board of the given size
+    void Reset(int size);
+
+    // Bring the map up to the stones given, size * size of them row by row,
+    // by updating around the points that changed; returns how many did
+    int Update(const Stone* stones);
+
+    // Compute the map for the stones given from scratch
+    void Recompute(const Stone* stones);
+
+    int Size() const { return size; }
+    int Radius() const { return radius; }
+    int Influence(int x, int y) const { return influence[(std::size_t)y * size + x]; }
+    Stone Owner(int x, int y) const { return owners[(std::size_t)y * size + x]; }
+    const std::vector<int>& Influences() const { return influence; }
+    const std::vector<Stone>& Owners() const { return owners; }
+
+    // Area count of the owners
+    GoAreaScore Score(double komi) const { return { blackArea, whiteArea, komi }; }
+
+private:
+    // Point the influence reaches, relative to the stone, and its weight
+    struct Reach
+    {
+        int dx;
+        int dy;
+        int weight;
+    };
+
+    void Spread(int x, int y, Stone stone, int sign);
+    void Judge(std::size_t cell);
+
+    int size;
+    int radius;
+    std::vector<Reach> reach;
+    std::vector<Stone> stones;
+    std::vector<int> influence;
+    std::vector<Stone> owners;
+    int blackArea;
+    int whiteArea;
+};
+
+class GoInfluenceWorker
+{
+public:
+    explicit GoInfluenceWorker(double komi = 7.5, int radius = 4);
+
+    // Drops any pending board and stops the thread
+    ~GoInfluenceWorker();
+
+    GoInfluenceWorker(const GoInfluenceWorker&) = delete;
+    GoInfluenceWorker& operator=(const GoInfluenceWorker&) = delete;
+
+    // Called on the worker thread after each new map; set it before the
+    // first Submit
+    void SetReadyCallback(std::function<void()> ready);
+
+    // Hand over the stones of a board, size * size of them row by row, or
+    // those of a game, and return at once
+    void Submit(int size, const Stone* stones);
+    void Submit(const GoGame& game);
+
+    // Wait until every board handed over has been mapped
+    void Wait();
+
+    // The latest map; size 0 before the first
+    GoInfluenceMap Latest() const;
+
+private:
+    void Run();
+
+    double komi;
+    GoInfluence influence;
+    std::function<void()> ready;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<Stone> pending;
+    int pendingSize;
+    bool hasPending;
+    bool busy;
+    bool stopping;
+    GoInfluenceMap latest;
+    std::thread thread;
+};
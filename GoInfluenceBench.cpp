@@ -0,0 +1,144 @@
+// GoInfluenceBench.cpp : Influence map benchmark and incremental check.
+//
+// Usage: GoInfluenceBench [-size n] [-games g] [-radius r] [-seed s]
+//
+// Plays g random games (20 by default) on an n x n board (19 by default)
+// and, after every move, brings one influence map of radius r (4) up to
+// date incrementally and computes another from scratch. It reports the
+// time per move of each, the stones changed per move and the number of
+// moves after which the two maps differ, which must be 0. Then it hands
+// every position of one more game to a GoInfluenceWorker and reports the
+// time from Submit to the finished map.
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "GoInfluence.h"
+#include "GoPosition.h"
+#include "GoRandom.h"
+
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to copy the stones of a position row by row
+template <int N>
+static void CopyStones(const GoPositionT<N>& position, std::vector<Stone>& stones)
+{
+    stones.resize(N * N);
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+            stones[y * N + x] = position.At(x, y);
+    }
+}
+
+// Function to play one random move, or pass when there is none
+template <int N>
+static void PlayRandomMove(GoPositionT<N>& position, GoRandom& random)
+{
+    GoMoveListT<N> moves;
+    position.GenerateLegalMoves(moves, true);
+    if (moves.count == 0)
+        position.Pass();
+    else
+        position.TryPlay(moves.moves[random.Below(moves.count)]);
+}
+
+struct GameTotals
+{
+    long long moves;
+    long long changed;
+    long long differing;
+    double incrementalSeconds;
+    double fullSeconds;
+    long long submitted;
+    double workerSeconds;
+};
+
+template <int N>
+static GameTotals RunGames(int games, int radius, uint64_t seed)
+{
+    GameTotals totals = GameTotals();
+    GoRandom random(seed);
+    std::vector<Stone> stones;
+    GoInfluence full(N, radius);
+    for (int game = 0; game < games; ++game)
+    {
+        GoPositionT<N> position(KO_SIMPLE);
+        GoInfluence incremental(N, radius);
+        for (int move = 0; move < 3 * N * N && !position.IsGameOver(); ++move)
+        {
+            PlayRandomMove(position, random);
+            CopyStones(position, stones);
+
+            auto start = std::chrono::steady_clock::now();
+            totals.changed += incremental.Update(stones.data());
+            totals.incrementalSeconds += SecondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            full.Recompute(stones.data());
+            totals.fullSeconds += SecondsSince(start);
+
+            GoAreaScore a = incremental.Score(0), b = full.Score(0);
+            totals.moves += 1;
+            totals.differing += incremental.Influences() != full.Influences() ||
+                incremental.Owners() != full.Owners() || a.blackArea != b.blackArea || a.whiteArea != b.whiteArea;
+        }
+    }
+
+    // One more game through the worker, waiting for each map
+    GoInfluenceWorker worker(7.5, radius);
+    GoPositionT<N> position(KO_SIMPLE);
+    for (int move = 0; move < 3 * N * N && !position.IsGameOver(); ++move)
+    {
+        PlayRandomMove(position, random);
+        CopyStones(position, stones);
+        auto start = std::chrono::steady_clock::now();
+        worker.Submit(N, stones.data());
+        worker.Wait();
+        totals.workerSeconds += SecondsSince(start);
+        totals.submitted += 1;
+    }
+    return totals;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = 19;
+    int games = 20;
+    int radius = 4;
+    uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-size") == 0)
+            size = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-games") == 0)
+            games = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-radius") == 0)
+            radius = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-seed") == 0)
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    if ((size != 9 && size != 13 && size != 19) || games < 1 || radius < 1)
+    {
+        std::fprintf(stderr, "usage: GoInfluenceBench [-size 9|13|19] [-games g] [-radius r] [-seed s]\n");
+        return 2;
+    }
+
+    GameTotals totals = size == 9 ? RunGames<9>(games, radius, seed) :
+        size == 13 ? RunGames<13>(games, radius, seed) : RunGames<19>(games, radius, seed);
+    long long moves = totals.moves > 0 ? totals.moves : 1;
+    long long submitted = totals.submitted > 0 ? totals.submitted : 1;
+    std::printf("%d random games of %dx%d, radius %d, %lld moves\n", games, size, size, radius, totals.moves);
+    std::printf("%-24s %10.2f us\n", "incremental update", 1e6 * totals.incrementalSeconds / moves);
+    std::printf("%-24s %10.2f us\n", "full recompute", 1e6 * totals.fullSeconds / moves);
+    std::printf("%-24s %10.2f\n", "stones changed per move", (double)totals.changed / moves);
+    std::printf("%-24s %10.2f us\n", "worker round trip", 1e6 * totals.workerSeconds / submitted);
+    std::printf("%-24s %10lld\n", "maps differing", totals.differing);
+    return totals.differing == 0 ? 0 : 1;
+}
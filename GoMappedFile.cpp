@@ -0,0 +1,117 @@
+// GoMappedFile.cpp : Implements read-only file mappings.
+//
+#include "GoMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+GoMappedFile::GoMappedFile()
+    : data(nullptr), size(0), open(false)
+#ifdef _WIN32
+    , file(INVALID_HANDLE_VALUE), mapping(nullptr)
+#endif
+{
+}
+
+GoMappedFile::~GoMappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool GoMappedFile::Open(const char* path)
+{
+    Close();
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length))
+    {
+        Close();
+        return false;
+    }
+    size = (std::size_t)length.QuadPart;
+    open = true;
+    if (size == 0)
+        return true;
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (data == nullptr)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void GoMappedFile::Close()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    data = nullptr;
+    mapping = nullptr;
+    file = INVALID_HANDLE_VALUE;
+    size = 0;
+    open = false;
+}
+
+#else
+
+bool GoMappedFile::Open(const char* path)
+{
+    Close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+    size = (std::size_t)info.st_size;
+    if (size > 0)
+    {
+        void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED)
+        {
+            ::close(fd);
+            size = 0;
+            return false;
+        }
+        // The file is read front to back once
+        madvise(view, size, MADV_SEQUENTIAL);
+        data = (const char*)view;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    open = true;
+    return true;
+}
+
+void GoMappedFile::Close()
+{
+    if (data)
+        munmap((void*)data, size);
+    data = nullptr;
+    size = 0;
+    open = false;
+}
+
+#endif
@@ -0,0 +1,40 @@
+// GoMappedFile.h : Read-only memory-mapped file.
+//
+// Maps a whole file into the address space so it can be parsed in place:
+// pages are read on demand by the operating system and shared with its
+// file cache, with no copy into a user buffer. Uses mmap on POSIX systems
+// and a file mapping object on Windows.
+//
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+class GoMappedFile
+{
+public:
+    GoMappedFile();
+    ~GoMappedFile();
+
+    GoMappedFile(const GoMappedFile&) = delete;
+    GoMappedFile& operator=(const GoMappedFile&) = delete;
+
+    // Map the file; false if it cannot be opened or mapped. An empty file
+    // maps to an empty view.
+    bool Open(const char* path);
+    void Close();
+
+    bool IsOpen() const { return open; }
+    const char* Data() const { return data; }
+    std::size_t Size() const { return size; }
+    std::string_view Text() const { return std::string_view(data, size); }
+
+private:
+    const char* data;
+    std::size_t size;
+    bool open;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+};
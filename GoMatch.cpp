@@ -0,0 +1,165 @@
+// GoMatch.cpp : Plays a self-play match between two search settings.
+//
+// Usage: GoMatch [options]
+//   -n games        games to play (100)
+//   -j threads      games at once (one per core)
+//   -size n         board size, 9, 13 or 19 (9)
+//   -komi k         komi (7)
+//   -seed s         match seed (1)
+//   -opening n      random opening moves (4)
+//   -resign r       resign below this win rate, 0 never (0.1)
+//   -same-colors    the first player always takes Black
+//   -p1 n, -p2 n    playouts per move of the first and second player (1000)
+//   -c1 c, -c2 c    exploration constants (0.7)
+//   -puct1, -puct2  select with PUCT instead of UCT
+//   -ladders1, -ladders2
+//                   read ladders and drop hopeless escapes (see GoTactics.h)
+//   -patterns1 file, -patterns2 file
+//                   pattern-weighted playouts, with the weights in the file
+//                   or the built-in ones for "default" (see GoPattern.h)
+//   -db file        write the games to a binary database (see GoDatabase.h)
+//   -sgf file       write the games to one SGF collection
+//
+// Prints the first player's score with its 95% confidence interval, the
+// Elo difference it implies, the results by colour and the average game
+// length. The same options always give the same games.
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "GoDatabase.h"
+#include "GoMatchRunner.h"
+#include "GoPattern.h"
+
+static void PrintUsage()
+{
+    std::fprintf(stderr,
+        "usage: GoMatch [-n games] [-j threads] [-size n] [-komi k] [-seed s] [-opening n] [-resign r]\n"
+        "               [-same-colors] [-p1 n] [-p2 n] [-c1 c] [-c2 c] [-puct1] [-puct2] [-ladders1] [-ladders2]\n"
+        "               [-patterns1 file] [-patterns2 file] [-db file] [-sgf file]\n");
+}
+
+int main(int argc, char* argv[])
+{
+    GoMatchOptions options;
+    GoMatchPlayer players[2];
+    GoPatternWeights patterns[2];
+    const char* dbPath = nullptr;
+    const char* sgfPath = nullptr;
+    for (int p = 0; p < 2; ++p)
+    {
+        players[p].name = p == 0 ? "first" : "second";
+        players[p].options.treeMemory = 32 << 20;
+        players[p].limits.playouts = 1000;
+    }
+
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        int player = arg[0] && arg[std::strlen(arg) - 1] == '2' ? 1 : 0;
+        if (std::strcmp(arg, "-same-colors") == 0)
+            options.alternateColors = false;
+        else if (std::strcmp(arg, "-puct1") == 0 || std::strcmp(arg, "-puct2") == 0)
+            players[player].options.rule = SELECT_PUCT;
+        else if (std::strcmp(arg, "-ladders1") == 0 || std::strcmp(arg, "-ladders2") == 0)
+            players[player].options.readLadders = true;
+        else if (!hasValue)
+            valid = false;
+        else if (std::strcmp(arg, "-n") == 0)
+            options.games = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "-j") == 0)
+            options.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "-size") == 0)
+            options.size = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "-komi") == 0)
+            options.komi = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "-seed") == 0)
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(arg, "-opening") == 0)
+            options.openingMoves = std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "-resign") == 0)
+            options.resignWinRate = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "-p1") == 0 || std::strcmp(arg, "-p2") == 0)
+            players[player].limits.playouts = std::atoll(argv[++i]);
+        else if (std::strcmp(arg, "-c1") == 0 || std::strcmp(arg, "-c2") == 0)
+            players[player].options.exploration = std::atof(argv[++i]);
+        else if (std::strcmp(arg, "-patterns1") == 0 || std::strcmp(arg, "-patterns2") == 0)
+        {
+            const char* path = argv[++i];
+            if (std::strcmp(path, "default") == 0)
+                patterns[player].SetDefaults();
+            else if (!patterns[player].Load(path))
+            {
+                std::fprintf(stderr, "cannot read patterns %s, line %d\n", path, patterns[player].ErrorLine());
+                return 1;
+            }
+            players[player].options.patterns = &patterns[player];
+        }
+        else if (std::strcmp(arg, "-db") == 0)
+            dbPath = argv[++i];
+        else if (std::strcmp(arg, "-sgf") == 0)
+            sgfPath = argv[++i];
+        else
+            valid = false;
+    }
+    if (!valid || (options.size != 9 && options.size != 13 && options.size != 19))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    GoDbWriter writer;
+    std::FILE* sgf = nullptr;
+    if (dbPath && !writer.Open(dbPath))
+    {
+        std::fprintf(stderr, "cannot write %s\n", dbPath);
+        return 1;
+    }
+    if (sgfPath && !(sgf = std::fopen(sgfPath, "wb")))
+    {
+        std::fprintf(stderr, "cannot write %s\n", sgfPath);
+        return 1;
+    }
+
+    GoMatchRunner runner(options, players[0], players[1]);
+    std::string text;
+    runner.SetGameCallback([&](const GoMatchGame& game) {
+        GoSgfGame record = runner.SgfRecord(game);
+        if (dbPath)
+            writer.AddSgfGame(record);
+        if (sgf)
+        {
+            text.clear();
+            const std::string& first = players[0].name;
+            const std::string& second = players[1].name;
+            WriteSgfGame(record, text, game.firstIsBlack ? first : second, game.firstIsBlack ? second : first);
+            std::fwrite(text.data(), 1, text.size(), sgf);
+        }
+    });
+    GoMatchStats stats = runner.Run();
+    if (sgf)
+        std::fclose(sgf);
+    if (dbPath && !writer.Close())
+    {
+        std::fprintf(stderr, "error writing %s\n", dbPath);
+        return 1;
+    }
+
+    double score = stats.Score();
+    double margin = stats.ScoreMargin();
+    std::printf("%d games of %dx%d in %.1f s (%.0f games/hour)\n", stats.games, options.size, options.size,
+        stats.seconds, stats.seconds > 0 ? 3600 * stats.games / stats.seconds : 0);
+    std::printf("first player: %d wins, %d losses, %d draws\n", stats.wins, stats.losses, stats.draws);
+    std::printf("%-22s %7.1f%% +- %.1f%%\n", "score", 100 * score, 100 * margin);
+    std::printf("%-22s %+7.0f  [%+.0f, %+.0f]\n", "Elo difference", stats.EloDifference(),
+        GoMatchStats::Elo(score - margin), GoMatchStats::Elo(score + margin));
+    std::printf("%-22s %d/%d as Black, %d/%d as White\n", "wins by colour", stats.winsAsBlack, stats.gamesAsBlack,
+        stats.wins - stats.winsAsBlack, stats.games - stats.gamesAsBlack);
+    std::printf("%-22s %7.1f moves\n", "average length", stats.AverageLength());
+    std::printf("%-22s %7d\n", "resignations", stats.resignations);
+    return 0;
+}
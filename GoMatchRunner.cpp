@@ -0,0 +1,180 @@
+// GoMatchRunner.cpp : Implements engine-versus-engine matches.
+//
+#include "GoMatchRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+
+#include "GoPlayout.h"
+#include "GoRandom.h"
+#include "GoScore.h"
+#include "GoWorkPool.h"
+
+double GoMatchStats::Score() const
+{
+    return games > 0 ? (wins + 0.5 * draws) / games : 0.5;
+}
+
+// Function to get the 95% margin of the score from the spread of the
+// game results (1, 1/2 or 0 points each)
+double GoMatchStats::ScoreMargin() const
+{
+    if (games < 2)
+        return 0.5;
+    double score = Score();
+    double variance = (wins * (1 - score) * (1 - score) + draws * (0.5 - score) * (0.5 - score) +
+        losses * score * score) / (games - 1);
+    return 1.96 * std::sqrt(variance / games);
+}
+
+double GoMatchStats::Elo(double score)
+{
+    // Keep a clean sweep finite
+    score = std::min(std::max(score, 0.001), 0.999);
+    return -400 * std::log10(1 / score - 1);
+}
+
+GoMatchRunner::GoMatchRunner(const GoMatchOptions& options, const GoMatchPlayer& first, const GoMatchPlayer& second)
+    : options(options), players{ first, second }
+{
+}
+
+GoMatchStats GoMatchRunner::Run()
+{
+    auto start = std::chrono::steady_clock::now();
+    GoMatchStats stats;
+    std::mutex mutex;
+    {
+        GoWorkPool pool(options.threads);
+        for (int i = 0; i < options.games; ++i)
+        {
+            pool.Submit([this, i, &stats, &mutex](int) {
+                GoMatchGame game;
+                game.index = i;
+                game.firstIsBlack = !options.alternateColors || i % 2 == 0;
+                if (options.size == 9)
+                    PlayGame<9>(game);
+                else if (options.size == 13)
+                    PlayGame<13>(game);
+                else
+                    PlayGame<19>(game);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.games += 1;
+                stats.wins += game.FirstWon();
+                stats.draws += game.winner == EMPTY;
+                stats.losses += game.winner != EMPTY && !game.FirstWon();
+                stats.gamesAsBlack += game.firstIsBlack;
+                stats.winsAsBlack += game.firstIsBlack && game.FirstWon();
+                stats.resignations += game.resigned;
+                stats.moves += game.moveCount;
+                if (gameCallback)
+                    gameCallback(game);
+            });
+        }
+        pool.Wait();
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+// Function to play one game between the two players
+template <int N>
+void GoMatchRunner::PlayGame(GoMatchGame& game) const
+{
+    const GoMatchPlayer& black = players[game.firstIsBlack ? 0 : 1];
+    const GoMatchPlayer& white = players[game.firstIsBlack ? 1 : 0];
+
+    // Each player searches on its own, with a seed of its own per game
+    GoSearchOptions blackOptions = black.options;
+    GoSearchOptions whiteOptions = white.options;
+    blackOptions.komi = whiteOptions.komi = options.komi;
+    blackOptions.seed = options.seed * 0x100000001B3ull + 2 * (uint64_t)game.index;
+    whiteOptions.seed = blackOptions.seed + 1;
+    GoSearchT<N> blackSearch(blackOptions);
+    GoSearchT<N> whiteSearch(whiteOptions);
+    GoPositionT<N> board;
+    board.SetUndoEnabled(false);
+
+    game.winner = EMPTY;
+    game.resigned = false;
+    game.margin = 0;
+    game.moveCount = 0;
+    game.moves.clear();
+    auto play = [&](int move) {
+        GoSgfMove record = { board.CurrentPlayer(), -1, -1, false };
+        if (move != PASS_MOVE)
+        {
+            record.x = (signed char)GoGeometry<N>::PointX(move);
+            record.y = (signed char)GoGeometry<N>::PointY(move);
+        }
+        board.TryPlay(move);
+        blackSearch.Play(move);
+        whiteSearch.Play(move);
+        game.moves.push_back(record);
+    };
+
+    // Both games of a pair get the same opening
+    int pair = options.alternateColors ? game.index / 2 : game.index;
+    GoRandom random(options.seed ^ (0x9E3779B97F4A7C15ull * (uint64_t)(pair + 1)));
+    GoMoveListT<N> legal;
+    for (int i = 0; i < options.openingMoves; ++i)
+    {
+        board.GenerateLegalMoves(legal, true);
+        if (legal.count == 0)
+            break;
+        play(legal.moves[random.Below(legal.count)]);
+    }
+
+    while (!board.IsGameOver() && game.moveCount < GoPlayoutT<N>::MAX_MOVES)
+    {
+        Stone player = board.CurrentPlayer();
+        GoSearchT<N>& search = player == BLACK ? blackSearch : whiteSearch;
+        int move = search.Search(player == BLACK ? black.limits : white.limits);
+
+        // A root that could not be expanded has no move statistics, however
+        // many visits it took over
+        if (options.resignWinRate > 0 && search.RootVisits() >= options.resignVisits)
+        {
+            std::vector<GoMoveStats> stats = search.RootStats();
+            if (!stats.empty() && stats.front().winRate < options.resignWinRate)
+            {
+                game.winner = Opponent(player);
+                game.resigned = true;
+                break;
+            }
+        }
+        play(move);
+        game.moveCount += 1;
+    }
+
+    char result[32];
+    if (!game.resigned)
+    {
+        GoAreaScore score = ScoreArea(board, options.komi);
+        game.margin = score.Margin();
+        game.winner = score.Winner();
+        if (game.winner == EMPTY)
+            std::snprintf(result, sizeof result, "0");
+        else
+            std::snprintf(result, sizeof result, "%c+%g", game.winner == BLACK ? 'B' : 'W', std::fabs(game.margin));
+    }
+    else
+    {
+        std::snprintf(result, sizeof result, "%c+R", game.winner == BLACK ? 'B' : 'W');
+    }
+    game.result = result;
+}
+
+GoSgfGame GoMatchRunner::SgfRecord(const GoMatchGame& game) const
+{
+    GoSgfGame record;
+    record.size = options.size;
+    record.komi = options.komi;
+    record.result = game.result;
+    record.moves = game.moves;
+    return record;
+}
@@ -0,0 +1,110 @@
+// GoMatchRunner.h : Engine-versus-engine matches on all cores.
+//
+// A match plays many games between two search configurations, each game
+// a job on a GoWorkPool with both players searching on that job's thread,
+// so as many games run at once as there are threads and long games do not
+// hold up the short ones.
+//
+// Every game is reproducible from the match seed and its index. With
+// colour alternation the first player takes Black in even games and White
+// in odd ones, and each such pair starts from the same randomized opening
+// (a few random legal moves), so neither player profits from a lucky
+// opening. Games end after two passes, a resignation or the playout move
+// cap, and are scored by area.
+//
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "GoSearch.h"
+#include "GoSgf.h"
+
+// One side of a match
+struct GoMatchPlayer
+{
+    std::string name;
+    GoSearchOptions options;    // threads per player are normally 1
+    GoSearchLimits limits;      // per move
+};
+
+struct GoMatchOptions
+{
+    int size = 9;
+    double komi = 7;
+    int games = 100;
+    int threads = 0;            // games at once; zero means one per core
+    uint64_t seed = 1;
+    bool alternateColors = true;
+    int openingMoves = 4;       // random moves before the players take over
+    double resignWinRate = 0.1; // a player resigns below this root win rate; 0 never
+    int resignVisits = 200;     // root visits needed before resigning
+};
+
+// Outcome and record of one game
+struct GoMatchGame
+{
+    int index;
+    bool firstIsBlack;
+    Stone winner;               // EMPTY for a draw
+    bool resigned;
+    double margin;              // area score margin for Black, if not resigned
+    int moveCount;              // moves after the opening, passes included
+    std::string result;         // SGF RE value
+    std::vector<GoSgfMove> moves;
+
+    // Whether the first player won
+    bool FirstWon() const { return winner == (firstIsBlack ? BLACK : WHITE); }
+};
+
+// Totals of a match, from the first player's point of view
+struct GoMatchStats
+{
+    int games = 0;
+    int wins = 0;
+    int losses = 0;
+    int draws = 0;
+    int winsAsBlack = 0;
+    int gamesAsBlack = 0;
+    int resignations = 0;
+    long long moves = 0;
+    double seconds = 0;
+
+    // Points per game, draws counting half, and its 95% margin of error
+    double Score() const;
+    double ScoreMargin() const;
+
+    // Elo difference implied by a score, and by Score()
+    static double Elo(double score);
+    double EloDifference() const { return Elo(Score()); }
+
+    double AverageLength() const { return games > 0 ? (double)moves / games : 0; }
+};
+
+class GoMatchRunner
+{
+public:
+    GoMatchRunner(const GoMatchOptions& options, const GoMatchPlayer& first, const GoMatchPlayer& second);
+
+    // Called for every finished game, one call at a time but on the pool's
+    // threads and in the order the games finish
+    typedef std::function<void(const GoMatchGame& game)> GameCallback;
+    void SetGameCallback(const GameCallback& callback) { gameCallback = callback; }
+
+    // Play the whole match and return the totals
+    GoMatchStats Run();
+
+    // The SGF record of a finished game; its result is a view of
+    // game.result
+    GoSgfGame SgfRecord(const GoMatchGame& game) const;
+
+private:
+    template <int N>
+    void PlayGame(GoMatchGame& game) const;
+
+    GoMatchOptions options;
+    GoMatchPlayer players[2];
+    GameCallback gameCallback;
+};
@@ -0,0 +1,261 @@
+// GoMetrics.cpp : Implements merging and reporting of the engine metrics.
+//
+#include "GoMetrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+static const char* const METRIC_NAMES[METRIC_COUNT] = {
+    "stones_played", "captures", "captured_stones", "merges", "merged_stones", "flood_fills", "liberty_counts",
+    "liberty_stones", "playout_moves", "expansions"
+};
+
+static const char* const TIMER_NAMES[TIMER_COUNT] = { "play", "legality", "playout", "search_iteration" };
+
+// Blocks of live threads, the totals of finished ones, and the clock
+// readings the time-stamp counter is calibrated against
+struct MetricsRegistry
+{
+    std::mutex mutex;
+    std::vector<GoMetricsBlock*> live;
+    GoMetricsBlock retired{};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point reset = start;
+#ifdef GO_METRICS
+    uint64_t startTicks = MetricsTicks();
+#endif
+};
+
+static MetricsRegistry& Registry()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+// Started with the program, so the calibration interval is long by the
+// time anyone asks
+static MetricsRegistry& registryAtStartup = Registry();
+
+// Function to add one block's counts to a snapshot
+static void AddBlock(GoMetricsSnapshot& total, const GoMetricsBlock& block)
+{
+    for (int m = 0; m < METRIC_COUNT; ++m)
+        total.counts[m] += block.counts[m].load(std::memory_order_relaxed);
+    for (int t = 0; t < TIMER_COUNT; ++t)
+    {
+        total.calls[t] += block.calls[t].load(std::memory_order_relaxed);
+        total.sampledTicks[t] += block.sampledTicks[t].load(std::memory_order_relaxed);
+        for (int b = 0; b < METRIC_HISTOGRAM_BUCKETS; ++b)
+            total.samples[t][b] += block.samples[t][b].load(std::memory_order_relaxed);
+    }
+}
+
+// Function to set every count of a block, to zero or to a snapshot's
+static void StoreBlock(GoMetricsBlock& block, const GoMetricsSnapshot& values)
+{
+    for (int m = 0; m < METRIC_COUNT; ++m)
+        block.counts[m].store(values.counts[m], std::memory_order_relaxed);
+    for (int t = 0; t < TIMER_COUNT; ++t)
+    {
+        block.calls[t].store(values.calls[t], std::memory_order_relaxed);
+        block.sampledTicks[t].store(values.sampledTicks[t], std::memory_order_relaxed);
+        for (int b = 0; b < METRIC_HISTOGRAM_BUCKETS; ++b)
+            block.samples[t][b].store(values.samples[t][b], std::memory_order_relaxed);
+    }
+}
+
+#ifdef GO_METRICS
+
+// Hands a thread's counts to the registry when the thread ends
+struct MetricsOwner
+{
+    GoMetricsBlock* block = nullptr;
+
+    ~MetricsOwner()
+    {
+        if (block == nullptr)
+            return;
+        MetricsRegistry& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        GoMetricsSnapshot total;
+        AddBlock(total, registry.retired);
+        AddBlock(total, *block);
+        StoreBlock(registry.retired, total);
+        registry.live.erase(std::find(registry.live.begin(), registry.live.end(), block));
+        delete block;
+        goMetricsBlock = nullptr;
+    }
+};
+
+GoMetricsBlock& RegisterMetricsBlock()
+{
+    static thread_local MetricsOwner owner;
+    GoMetricsBlock* block = new GoMetricsBlock();
+    MetricsRegistry& registry = Registry();
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.live.push_back(block);
+    }
+    owner.block = block;
+    goMetricsBlock = block;
+    return *block;
+}
+
+void RecordMetricsSample(GoMetricsBlock& block, GoTimer timer, uint64_t ticks)
+{
+    int bucket = 0;
+    while (bucket < METRIC_HISTOGRAM_BUCKETS - 1 && (ticks >> (bucket + 1)) != 0)
+        ++bucket;
+    std::atomic<uint64_t>& count = block.samples[timer][bucket];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic<uint64_t>& sum = block.sampledTicks[timer];
+    sum.store(sum.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+}
+
+#endif
+
+const char* MetricName(GoMetric metric)
+{
+    return METRIC_NAMES[metric];
+}
+
+const char* TimerName(GoTimer timer)
+{
+    return TIMER_NAMES[timer];
+}
+
+GoMetricsSnapshot CollectMetrics()
+{
+    GoMetricsSnapshot snapshot;
+    MetricsRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    AddBlock(snapshot, registry.retired);
+    for (const GoMetricsBlock* block : registry.live)
+        AddBlock(snapshot, *block);
+
+    auto now = std::chrono::steady_clock::now();
+    snapshot.seconds = std::chrono::duration<double>(now - registry.reset).count();
+#ifdef GO_METRICS
+    snapshot.enabled = true;
+
+    // Ticks per second over the program's life so far; wait for a few
+    // milliseconds if it has only just started
+    double elapsed = std::chrono::duration<double>(now - registry.start).count();
+    while (elapsed < 0.005)
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - registry.start).count();
+    snapshot.ticksPerSecond = (MetricsTicks() - registry.startTicks) / elapsed;
+#endif
+    return snapshot;
+}
+
+void ResetMetrics()
+{
+    MetricsRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    GoMetricsSnapshot zero;
+    StoreBlock(registry.retired, zero);
+    for (GoMetricsBlock* block : registry.live)
+        StoreBlock(*block, zero);
+    registry.reset = std::chrono::steady_clock::now();
+}
+
+uint64_t GoMetricsSnapshot::SampleCount(GoTimer timer) const
+{
+    uint64_t count = 0;
+    for (int b = 0; b < METRIC_HISTOGRAM_BUCKETS; ++b)
+        count += samples[timer][b];
+    return count;
+}
+
+double GoMetricsSnapshot::MeanNanoseconds(GoTimer timer) const
+{
+    uint64_t count = SampleCount(timer);
+    return count ? sampledTicks[timer] / (double)count / ticksPerSecond * 1e9 : 0;
+}
+
+double GoMetricsSnapshot::PercentileNanoseconds(GoTimer timer, double fraction) const
+{
+    uint64_t count = SampleCount(timer);
+    if (count == 0)
+        return 0;
+    uint64_t seen = 0;
+    int bucket = 0;
+    for (; bucket < METRIC_HISTOGRAM_BUCKETS - 1; ++bucket)
+    {
+        seen += samples[timer][bucket];
+        if (seen >= fraction * count)
+            break;
+    }
+    return (double)(2ull << bucket) / ticksPerSecond * 1e9;
+}
+
+std::string MetricsJson(const GoMetricsSnapshot& snapshot)
+{
+    std::string json;
+    char text[256];
+    std::snprintf(text, sizeof(text), "{\"enabled\":%s,\"seconds\":%.3f,\"counters\":{",
+        snapshot.enabled ? "true" : "false", snapshot.seconds);
+    json += text;
+    for (int m = 0; m < METRIC_COUNT; ++m)
+    {
+        std::snprintf(text, sizeof(text), "%s\"%s\":%llu", m ? "," : "", METRIC_NAMES[m],
+            (unsigned long long)snapshot.counts[m]);
+        json += text;
+    }
+    json += "},\"timers\":{";
+    for (int t = 0; t < TIMER_COUNT; ++t)
+    {
+        GoTimer timer = (GoTimer)t;
+        std::snprintf(text, sizeof(text),
+            "%s\"%s\":{\"calls\":%llu,\"samples\":%llu,\"mean_ns\":%.1f,\"p50_ns\":%.0f,\"p90_ns\":%.0f,"
+            "\"p99_ns\":%.0f,\"buckets\":[",
+            t ? "," : "", TIMER_NAMES[t], (unsigned long long)snapshot.calls[t],
+            (unsigned long long)snapshot.SampleCount(timer), snapshot.MeanNanoseconds(timer),
+            snapshot.PercentileNanoseconds(timer, 0.5), snapshot.PercentileNanoseconds(timer, 0.9),
+            snapshot.PercentileNanoseconds(timer, 0.99));
+        json += text;
+
+        // Bucket b counts samples of 2^b to 2^(b+1) ticks; trailing empty
+        // buckets are left out
+        int last = METRIC_HISTOGRAM_BUCKETS;
+        while (last > 0 && snapshot.samples[t][last - 1] == 0)
+            --last;
+        for (int b = 0; b < last; ++b)
+        {
+            std::snprintf(text, sizeof(text), "%s%llu", b ? "," : "", (unsigned long long)snapshot.samples[t][b]);
+            json += text;
+        }
+        json += "]}";
+    }
+    std::snprintf(text, sizeof(text), "},\"ticks_per_second\":%.0f}", snapshot.ticksPerSecond);
+    json += text;
+    return json;
+}
+
+std::string MetricsText(const GoMetricsSnapshot& snapshot)
+{
+    if (!snapshot.enabled)
+        return "metrics not compiled in (build with GO_METRICS)";
+
+    std::string lines;
+    char text[256];
+    std::snprintf(text, sizeof(text), "over %.1f s", snapshot.seconds);
+    lines += text;
+    for (int m = 0; m < METRIC_COUNT; ++m)
+    {
+        std::snprintf(text, sizeof(text), "\n%-18s %14llu", METRIC_NAMES[m], (unsigned long long)snapshot.counts[m]);
+        lines += text;
+    }
+    for (int t = 0; t < TIMER_COUNT; ++t)
+    {
+        GoTimer timer = (GoTimer)t;
+        std::snprintf(text, sizeof(text), "\n%-18s %14llu calls, mean %.0f ns, p50 %.0f ns, p99 %.0f ns",
+            TIMER_NAMES[t], (unsigned long long)snapshot.calls[t], snapshot.MeanNanoseconds(timer),
+            snapshot.PercentileNanoseconds(timer, 0.5), snapshot.PercentileNanoseconds(timer, 0.99));
+        lines += text;
+    }
+    return lines;
+}
@@ -0,0 +1,194 @@
+// GoNetBench.cpp : Network inference benchmark.
+//
+// Usage: GoNetBench [-size n] [-blocks b] [-channels c] [-load file] [-save file] [-seconds s] [-threads t]
+//
+// Evaluates random positions with a network read from a weights file or,
+// without -load, one of random weights of the given shape (19x19, 4
+// blocks, 32 channels by default), which -save writes out. It checks that
+// the AVX2 and scalar kernels agree, then reports positions per second
+// for batch sizes 1 to 64 with each kernel, and finally runs a tree
+// search on the given number of threads through a GoEvalQueue, showing
+// the batch sizes the queue actually formed.
+//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "GoEvalQueue.h"
+#include "GoFeatures.h"
+#include "GoRandom.h"
+#include "GoSearch.h"
+
+static const int MAX_BATCH = 64;
+
+// Function to fill planes with positions from random games of N x N
+template <int N>
+static void MakePositions(std::vector<uint8_t>& planes, int count, uint64_t seed)
+{
+    GoRandom random(seed);
+    GoPositionT<N> position;
+    GoMoveListT<N> legal;
+    planes.resize((std::size_t)count * FEATURE_PLANES * N * N);
+    for (int i = 0; i < count; ++i)
+    {
+        position.Reset();
+        int moves = random.Below(N * N);
+        int recent[FEATURE_HISTORY] = {};
+        for (int m = 0; m < moves; ++m)
+        {
+            position.GenerateLegalMoves(legal, true);
+            if (legal.count == 0)
+                break;
+            int move = legal.moves[random.Below(legal.count)];
+            position.TryPlay(move);
+            std::copy_backward(recent, recent + FEATURE_HISTORY - 1, recent + FEATURE_HISTORY);
+            recent[0] = move;
+        }
+        ExtractFeatures(position, recent, std::min(moves, FEATURE_HISTORY), 0,
+            planes.data() + (std::size_t)i * FEATURE_PLANES * N * N);
+    }
+}
+
+// Function to time evaluations of one batch size; positions per second
+static double Throughput(const GoNetwork& network, const std::vector<uint8_t>& planes, int batch, double seconds)
+{
+    std::vector<float> policy((std::size_t)batch * network.PolicySize());
+    std::vector<float> values(batch);
+    long long positions = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < seconds)
+    {
+        network.Evaluate(planes.data(), batch, policy.data(), values.data());
+        positions += batch;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return positions / elapsed;
+}
+
+// Function to search the empty board with network priors and values
+template <int N>
+static void RunSearch(const GoNetwork& network, int threads, double seconds)
+{
+    GoEvalQueue queue(network, threads);
+    GoSearchOptions options;
+    options.threads = threads;
+    options.rule = SELECT_PUCT;
+    options.expandVisits = 1;
+    GoSearchT<N> search(options);
+    search.SetEvaluator(&queue);
+
+    GoSearchLimits limits;
+    limits.seconds = seconds;
+    search.Search(limits);
+    std::printf("search on %d threads: %.0f playouts/sec, %lld evaluations in %lld batches (%.1f per batch)\n",
+        threads, search.LastPlayouts() / search.LastSeconds(), queue.Positions(), queue.Batches(),
+        queue.AverageBatch());
+}
+
+int main(int argc, char* argv[])
+{
+    GoNetworkShape shape;
+    const char* loadPath = nullptr;
+    const char* savePath = nullptr;
+    double seconds = 0.5;
+    int threads = 4;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-size") == 0)
+            shape.size = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-blocks") == 0)
+            shape.blocks = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-channels") == 0)
+            shape.channels = (std::atoi(argv[i + 1]) + 3) / 4 * 4;
+        else if (std::strcmp(argv[i], "-load") == 0)
+            loadPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "-save") == 0)
+            savePath = argv[i + 1];
+        else if (std::strcmp(argv[i], "-seconds") == 0)
+            seconds = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-threads") == 0)
+            threads = std::max(1, std::atoi(argv[i + 1]));
+    }
+
+    GoNetwork network;
+    if (loadPath)
+    {
+        if (!network.Load(loadPath))
+        {
+            std::fprintf(stderr, "cannot load %s\n", loadPath);
+            return 1;
+        }
+        shape = network.Shape();
+    }
+    else
+    {
+        if (shape.size != 9 && shape.size != 13 && shape.size != 19)
+        {
+            std::fprintf(stderr, "board size must be 9, 13 or 19\n");
+            return 2;
+        }
+        network.Randomize(shape, 1);
+    }
+    if (savePath && !network.Save(savePath))
+    {
+        std::fprintf(stderr, "cannot write %s\n", savePath);
+        return 1;
+    }
+
+    std::vector<uint8_t> planes;
+    if (shape.size == 9)
+        MakePositions<9>(planes, MAX_BATCH, 7);
+    else if (shape.size == 13)
+        MakePositions<13>(planes, MAX_BATCH, 7);
+    else
+        MakePositions<19>(planes, MAX_BATCH, 7);
+
+    std::printf("%dx%d network, %d blocks of %d channels; AVX2/FMA %s\n", shape.size, shape.size, shape.blocks,
+        shape.channels, GoNetwork::HasAvx2() ? "available" : "not available");
+
+    bool avx2 = GoNetwork::HasAvx2();
+    if (avx2)
+    {
+        // Both kernels on the same batch
+        std::vector<float> policyA((std::size_t)MAX_BATCH * network.PolicySize()), policyB(policyA.size());
+        std::vector<float> valueA(MAX_BATCH), valueB(MAX_BATCH);
+        network.Evaluate(planes.data(), MAX_BATCH, policyA.data(), valueA.data());
+        network.SetUseAvx2(false);
+        network.Evaluate(planes.data(), MAX_BATCH, policyB.data(), valueB.data());
+        network.SetUseAvx2(true);
+        double difference = 0;
+        for (std::size_t i = 0; i < policyA.size(); ++i)
+            difference = std::max(difference, (double)std::fabs(policyA[i] - policyB[i]));
+        for (int i = 0; i < MAX_BATCH; ++i)
+            difference = std::max(difference, (double)std::fabs(valueA[i] - valueB[i]));
+        std::printf("largest difference between kernels: %.2g\n", difference);
+    }
+
+    std::printf("%-8s %16s %16s\n", "batch", "AVX2 pos/sec", "scalar pos/sec");
+    for (int batch = 1; batch <= MAX_BATCH; batch *= 2)
+    {
+        double fast = 0;
+        if (avx2)
+        {
+            network.SetUseAvx2(true);
+            fast = Throughput(network, planes, batch, seconds);
+        }
+        network.SetUseAvx2(false);
+        double scalar = Throughput(network, planes, batch, seconds);
+        std::printf("%-8d %16.0f %16.0f\n", batch, fast, scalar);
+    }
+    network.SetUseAvx2(avx2);
+
+    if (shape.size == 9)
+        RunSearch<9>(network, threads, 2 * seconds);
+    else if (shape.size == 13)
+        RunSearch<13>(network, threads, 2 * seconds);
+    else
+        RunSearch<19>(network, threads, 2 * seconds);
+    return 0;
+}
@@ -0,0 +1,467 @@
+// GoNetwork.cpp : Implements network inference with AVX2 and scalar kernels.
+//
+#include "GoNetwork.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "GoFeatures.h"
+#include "GoRandom.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GO_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GO_TARGET_AVX2
+#else
+#define GO_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+static const char NETWORK_MAGIC[4] = { 'G', 'O', 'N', 'N' };
+static const uint32_t NETWORK_VERSION = 1;
+
+// Output channels a convolution kernel produces at once, and floats of a
+// board run it handles per step
+static const int CHANNEL_BLOCK = 4;
+static const int RUN_BLOCK = 16;
+
+// Activation layout of one batch: boards of (size + 2)^2 floats, each
+// with a zero frame, one after the other in every channel. Every channel
+// has slack before and after its boards, so the taps of a 3x3 kernel
+// never read outside the buffer.
+struct GoNetwork::Workspace
+{
+    int size = 0;
+    int batch = 0;
+    int channels = 0;
+    int width = 0;              // size + 2
+    int area = 0;               // width * width
+    int length = 0;             // batch * area, rounded up to RUN_BLOCK
+    int slack = 0;
+    int stride = 0;             // floats from one channel to the next
+    int offsets3[9];
+    int offsets1[1];
+    std::vector<float> mask;    // 1 on board points, 0 on frames and padding
+    std::vector<float> input;
+    std::vector<float> x;
+    std::vector<float> t;
+    std::vector<float> u;
+    std::vector<float> dense;
+
+    void Prepare(int size, int batch, int channels)
+    {
+        if (size == this->size && batch == this->batch && channels == this->channels)
+            return;
+        this->size = size;
+        this->batch = batch;
+        this->channels = channels;
+        width = size + 2;
+        area = width * width;
+        length = (batch * area + RUN_BLOCK - 1) / RUN_BLOCK * RUN_BLOCK;
+        slack = (width + 1 + RUN_BLOCK - 1) / RUN_BLOCK * RUN_BLOCK;
+        stride = slack + length + slack;
+        for (int dy = -1, k = 0; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx)
+                offsets3[k++] = dy * width + dx;
+        offsets1[0] = 0;
+
+        mask.assign(length, 0.0f);
+        for (int b = 0; b < batch; ++b)
+            for (int y = 1; y <= size; ++y)
+                for (int x = 1; x <= size; ++x)
+                    mask[b * area + y * width + x] = 1.0f;
+
+        // Frames and slack are never written, so they stay zero
+        input.assign((std::size_t)FEATURE_PLANES * stride, 0.0f);
+        std::size_t activations = (std::size_t)std::max(channels, CHANNEL_BLOCK) * stride;
+        x.assign(activations, 0.0f);
+        t.assign(activations, 0.0f);
+        u.assign(activations, 0.0f);
+    }
+
+    // Start of channel c's boards in a buffer
+    float* Channel(std::vector<float>& buffer, int c) { return buffer.data() + (std::size_t)c * stride + slack; }
+    const float* Channel(const std::vector<float>& buffer, int c) const
+    {
+        return buffer.data() + (std::size_t)c * stride + slack;
+    }
+};
+
+// Function to run a convolution over a batch, four output channels and
+// sixteen floats at a time; the portable version
+static void ConvolveScalar(const float* weights, const float* biases, int inputs, int outputs, int taps,
+    const int* offsets, const float* input, int stride, int length, const float* mask, const float* residual,
+    bool relu, float* output)
+{
+    for (int co = 0; co < outputs; co += CHANNEL_BLOCK)
+    {
+        for (int i = 0; i < length; i += RUN_BLOCK)
+        {
+            float acc[CHANNEL_BLOCK][RUN_BLOCK];
+            for (int j = 0; j < CHANNEL_BLOCK; ++j)
+                for (int e = 0; e < RUN_BLOCK; ++e)
+                    acc[j][e] = biases[co + j];
+
+            for (int ci = 0; ci < inputs; ++ci)
+            {
+                const float* in = input + (std::size_t)ci * stride + i;
+                for (int k = 0; k < taps; ++k)
+                {
+                    const float* tap = in + offsets[k];
+                    for (int j = 0; j < CHANNEL_BLOCK; ++j)
+                    {
+                        float w = weights[((std::size_t)(co + j) * inputs + ci) * taps + k];
+                        for (int e = 0; e < RUN_BLOCK; ++e)
+                            acc[j][e] += w * tap[e];
+                    }
+                }
+            }
+
+            for (int j = 0; j < CHANNEL_BLOCK; ++j)
+            {
+                std::size_t base = (std::size_t)(co + j) * stride + i;
+                for (int e = 0; e < RUN_BLOCK; ++e)
+                {
+                    float v = acc[j][e] + (residual ? residual[base + e] : 0.0f);
+                    if (relu)
+                        v = std::max(v, 0.0f);
+                    output[base + e] = v * mask[i + e];
+                }
+            }
+        }
+    }
+}
+
+static float DotScalar(const float* a, const float* b, int n)
+{
+    float sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+#ifdef GO_X86
+
+// Function to run a convolution with AVX2 and FMA: eight accumulators
+// (four channels times two vectors) stay in registers over all inputs and
+// taps
+GO_TARGET_AVX2
+static void ConvolveAvx2(const float* weights, const float* biases, int inputs, int outputs, int taps,
+    const int* offsets, const float* input, int stride, int length, const float* mask, const float* residual,
+    bool relu, float* output)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    for (int co = 0; co < outputs; co += CHANNEL_BLOCK)
+    {
+        const float* w0 = weights + (std::size_t)(co + 0) * inputs * taps;
+        const float* w1 = weights + (std::size_t)(co + 1) * inputs * taps;
+        const float* w2 = weights + (std::size_t)(co + 2) * inputs * taps;
+        const float* w3 = weights + (std::size_t)(co + 3) * inputs * taps;
+        for (int i = 0; i < length; i += RUN_BLOCK)
+        {
+            __m256 a0 = _mm256_set1_ps(biases[co + 0]), b0 = a0;
+            __m256 a1 = _mm256_set1_ps(biases[co + 1]), b1 = a1;
+            __m256 a2 = _mm256_set1_ps(biases[co + 2]), b2 = a2;
+            __m256 a3 = _mm256_set1_ps(biases[co + 3]), b3 = a3;
+
+            for (int ci = 0; ci < inputs; ++ci)
+            {
+                const float* in = input + (std::size_t)ci * stride + i;
+                int w = ci * taps;
+                for (int k = 0; k < taps; ++k, ++w)
+                {
+                    const float* tap = in + offsets[k];
+                    __m256 lo = _mm256_loadu_ps(tap);
+                    __m256 hi = _mm256_loadu_ps(tap + 8);
+                    __m256 v = _mm256_broadcast_ss(w0 + w);
+                    a0 = _mm256_fmadd_ps(v, lo, a0);
+                    b0 = _mm256_fmadd_ps(v, hi, b0);
+                    v = _mm256_broadcast_ss(w1 + w);
+                    a1 = _mm256_fmadd_ps(v, lo, a1);
+                    b1 = _mm256_fmadd_ps(v, hi, b1);
+                    v = _mm256_broadcast_ss(w2 + w);
+                    a2 = _mm256_fmadd_ps(v, lo, a2);
+                    b2 = _mm256_fmadd_ps(v, hi, b2);
+                    v = _mm256_broadcast_ss(w3 + w);
+                    a3 = _mm256_fmadd_ps(v, lo, a3);
+                    b3 = _mm256_fmadd_ps(v, hi, b3);
+                }
+            }
+
+            __m256 lowMask = _mm256_loadu_ps(mask + i);
+            __m256 highMask = _mm256_loadu_ps(mask + i + 8);
+            __m256 acc[CHANNEL_BLOCK][2] = { { a0, b0 }, { a1, b1 }, { a2, b2 }, { a3, b3 } };
+            for (int j = 0; j < CHANNEL_BLOCK; ++j)
+            {
+                float* out = output + (std::size_t)(co + j) * stride + i;
+                __m256 lo = acc[j][0];
+                __m256 hi = acc[j][1];
+                if (residual)
+                {
+                    const float* skip = residual + (std::size_t)(co + j) * stride + i;
+                    lo = _mm256_add_ps(lo, _mm256_loadu_ps(skip));
+                    hi = _mm256_add_ps(hi, _mm256_loadu_ps(skip + 8));
+                }
+                if (relu)
+                {
+                    lo = _mm256_max_ps(lo, zero);
+                    hi = _mm256_max_ps(hi, zero);
+                }
+                _mm256_storeu_ps(out, _mm256_mul_ps(lo, lowMask));
+                _mm256_storeu_ps(out + 8, _mm256_mul_ps(hi, highMask));
+            }
+        }
+    }
+}
+
+GO_TARGET_AVX2
+static float DotAvx2(const float* a, const float* b, int n)
+{
+    __m256 sum = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    float total = _mm_cvtss_f32(half);
+    for (; i < n; ++i)
+        total += a[i] * b[i];
+    return total;
+}
+
+#endif
+
+bool GoNetwork::HasAvx2()
+{
+#if !defined(GO_X86)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+GoNetwork::GoNetwork()
+    : useAvx2(HasAvx2())
+{
+}
+
+// Function to size every layer for the shape
+void GoNetwork::Allocate()
+{
+    int points = shape.size * shape.size;
+    auto size = [](Layer& layer, int inputs, int outputs, int taps) {
+        layer.inputs = inputs;
+        layer.outputs = outputs;
+        layer.taps = taps;
+        int rows = taps > 0 ? (outputs + CHANNEL_BLOCK - 1) / CHANNEL_BLOCK * CHANNEL_BLOCK : outputs;
+        layer.weights.assign((std::size_t)rows * inputs * std::max(taps, 1), 0.0f);
+        layer.biases.assign(rows, 0.0f);
+    };
+
+    size(stem, FEATURE_PLANES, shape.channels, 9);
+    tower.resize(2 * shape.blocks);
+    for (Layer& layer : tower)
+        size(layer, shape.channels, shape.channels, 9);
+    size(policyConv, shape.channels, 2, 1);
+    size(policyDense, 2 * points, points + 1, 0);
+    size(valueConv, shape.channels, 1, 1);
+    size(valueDense1, points, shape.valueHidden, 0);
+    size(valueDense2, shape.valueHidden, 1, 0);
+}
+
+// Layers in weights file order
+std::vector<GoNetwork::Layer*> GoNetwork::Layers()
+{
+    std::vector<Layer*> layers = { &stem };
+    for (Layer& layer : tower)
+        layers.push_back(&layer);
+    layers.insert(layers.end(), { &policyConv, &policyDense, &valueConv, &valueDense1, &valueDense2 });
+    return layers;
+}
+
+void GoNetwork::Randomize(const GoNetworkShape& value, uint64_t seed)
+{
+    shape = value;
+    Allocate();
+    GoRandom random(seed);
+    for (Layer* layer : Layers())
+    {
+        // Uniform with the variance that keeps ReLU activations in scale
+        int fanIn = layer->inputs * std::max(layer->taps, 1);
+        float scale = std::sqrt(6.0f / fanIn);
+        std::size_t stored = (std::size_t)layer->outputs * fanIn;
+        for (std::size_t i = 0; i < stored; ++i)
+            layer->weights[i] = scale * (float)((random.Next() >> 11) * (1.0 / 9007199254740992.0) * 2 - 1);
+    }
+}
+
+bool GoNetwork::Load(const char* path)
+{
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file)
+        return false;
+
+    char magic[4];
+    uint32_t header[7];
+    bool ok = std::fread(magic, 1, 4, file) == 4 && std::memcmp(magic, NETWORK_MAGIC, 4) == 0 &&
+        std::fread(header, sizeof header, 1, file) == 1 && header[0] == NETWORK_VERSION &&
+        (header[1] == 9 || header[1] == 13 || header[1] == 19) && header[2] == FEATURE_PLANES && header[3] <= 64 &&
+        header[4] > 0 && header[4] <= 512 && header[4] % CHANNEL_BLOCK == 0 && header[5] > 0 && header[5] <= 4096;
+    if (ok)
+    {
+        shape.size = (int)header[1];
+        shape.blocks = (int)header[3];
+        shape.channels = (int)header[4];
+        shape.valueHidden = (int)header[5];
+        Allocate();
+        for (Layer* layer : Layers())
+        {
+            std::size_t stored = (std::size_t)layer->outputs * layer->inputs * std::max(layer->taps, 1);
+            ok = ok && std::fread(layer->weights.data(), sizeof(float), stored, file) == stored &&
+                std::fread(layer->biases.data(), sizeof(float), layer->outputs, file) == (std::size_t)layer->outputs;
+        }
+        ok = ok && std::fgetc(file) == EOF;
+    }
+    std::fclose(file);
+    if (!ok)
+        stem.weights.clear();
+    return ok;
+}
+
+bool GoNetwork::Save(const char* path) const
+{
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+
+    uint32_t header[7] = { NETWORK_VERSION, (uint32_t)shape.size, FEATURE_PLANES, (uint32_t)shape.blocks,
+        (uint32_t)shape.channels, (uint32_t)shape.valueHidden, 0 };
+    bool ok = std::fwrite(NETWORK_MAGIC, 1, 4, file) == 4 && std::fwrite(header, sizeof header, 1, file) == 1;
+    for (Layer* layer : const_cast<GoNetwork*>(this)->Layers())
+    {
+        std::size_t stored = (std::size_t)layer->outputs * layer->inputs * std::max(layer->taps, 1);
+        ok = ok && std::fwrite(layer->weights.data(), sizeof(float), stored, file) == stored &&
+            std::fwrite(layer->biases.data(), sizeof(float), layer->outputs, file) == (std::size_t)layer->outputs;
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+void GoNetwork::Convolve(const Layer& layer, const float* input, float* output, const float* residual, bool relu,
+    const Workspace& work) const
+{
+    const int* offsets = layer.taps == 9 ? work.offsets3 : work.offsets1;
+    int outputs = (int)layer.biases.size();
+#ifdef GO_X86
+    if (useAvx2)
+    {
+        ConvolveAvx2(layer.weights.data(), layer.biases.data(), layer.inputs, outputs, layer.taps, offsets, input,
+            work.stride, work.length, work.mask.data(), residual, relu, output);
+        return;
+    }
+#endif
+    ConvolveScalar(layer.weights.data(), layer.biases.data(), layer.inputs, outputs, layer.taps, offsets, input,
+        work.stride, work.length, work.mask.data(), residual, relu, output);
+}
+
+void GoNetwork::Dense(const Layer& layer, const float* input, float* output) const
+{
+    for (int o = 0; o < layer.outputs; ++o)
+    {
+        const float* row = layer.weights.data() + (std::size_t)o * layer.inputs;
+#ifdef GO_X86
+        if (useAvx2)
+        {
+            output[o] = layer.biases[o] + DotAvx2(row, input, layer.inputs);
+            continue;
+        }
+#endif
+        output[o] = layer.biases[o] + DotScalar(row, input, layer.inputs);
+    }
+}
+
+void GoNetwork::Evaluate(const uint8_t* planes, int count, float* policy, float* values) const
+{
+    static thread_local Workspace work;
+    const int n = shape.size;
+    const int points = n * n;
+    work.Prepare(n, count, shape.channels);
+
+    // Spread the byte planes over the framed float layout
+    for (int f = 0; f < FEATURE_PLANES; ++f)
+    {
+        float* channel = work.Channel(work.input, f);
+        for (int b = 0; b < count; ++b)
+        {
+            const uint8_t* plane = planes + ((std::size_t)b * FEATURE_PLANES + f) * points;
+            float* board = channel + b * work.area + work.width + 1;
+            for (int y = 0; y < n; ++y)
+                for (int x = 0; x < n; ++x)
+                    board[y * work.width + x] = plane[y * n + x];
+        }
+    }
+
+    // The convolutions read and write whole channel buffers starting at
+    // channel 0's boards
+    auto start = [&](std::vector<float>& buffer) { return work.Channel(buffer, 0); };
+    Convolve(stem, start(work.input), start(work.x), nullptr, true, work);
+    for (int block = 0; block < shape.blocks; ++block)
+    {
+        Convolve(tower[2 * block], start(work.x), start(work.t), nullptr, true, work);
+        Convolve(tower[2 * block + 1], start(work.t), start(work.u), start(work.x), true, work);
+        std::swap(work.x, work.u);
+    }
+    Convolve(policyConv, start(work.x), start(work.t), nullptr, true, work);
+    Convolve(valueConv, start(work.x), start(work.u), nullptr, true, work);
+
+    work.dense.resize(2 * points + shape.valueHidden);
+    float* features = work.dense.data();
+    float* hidden = features + 2 * points;
+    for (int b = 0; b < count; ++b)
+    {
+        // Policy: both channels' board points, then the logits and softmax
+        for (int c = 0; c < 2; ++c)
+        {
+            const float* board = work.Channel(work.t, c) + b * work.area + work.width + 1;
+            for (int y = 0; y < n; ++y)
+                for (int x = 0; x < n; ++x)
+                    features[c * points + y * n + x] = board[y * work.width + x];
+        }
+        float* out = policy + (std::size_t)b * (points + 1);
+        Dense(policyDense, features, out);
+        float largest = *std::max_element(out, out + points + 1);
+        float sum = 0;
+        for (int i = 0; i <= points; ++i)
+        {
+            out[i] = std::exp(out[i] - largest);
+            sum += out[i];
+        }
+        for (int i = 0; i <= points; ++i)
+            out[i] /= sum;
+
+        // Value
+        const float* board = work.Channel(work.u, 0) + b * work.area + work.width + 1;
+        for (int y = 0; y < n; ++y)
+            for (int x = 0; x < n; ++x)
+                features[y * n + x] = board[y * work.width + x];
+        Dense(valueDense1, features, hidden);
+        for (int i = 0; i < shape.valueHidden; ++i)
+            hidden[i] = std::max(hidden[i], 0.0f);
+        float value;
+        Dense(valueDense2, hidden, &value);
+        values[b] = std::tanh(value);
+    }
+}
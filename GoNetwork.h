@@ -0,0 +1,108 @@
+// GoNetwork.h : CPU inference for a small policy/value network.
+//
+// The network is a residual convolutional tower in the AlphaGo Zero mould,
+// sized for a CPU:
+//
+//   stem      3x3 convolution from the FEATURE_PLANES input planes (see
+//             GoFeatures.h) to C channels, ReLU
+//   tower     B residual blocks of two 3x3 convolutions, ReLU after the
+//             first and after adding the block's input to the second
+//   policy    1x1 convolution to 2 channels, ReLU, fully connected to
+//             N * N + 1 move logits (the last one is the pass), softmax
+//   value     1x1 convolution to 1 channel, ReLU, fully connected to H,
+//             ReLU, fully connected to 1, tanh
+//
+// Batch normalization is folded into the convolution weights and biases
+// when a trained network is exported, so there are no BN layers here.
+//
+// Activations of a whole batch are stored channel by channel, each
+// channel holding the batch's boards one after the other, every board
+// framed by a ring of zeros. A 3x3 convolution is then, for each of its
+// nine taps, a multiply-add of one long contiguous run of floats shifted
+// by a constant, which the AVX2/FMA kernel does eight floats at a time for
+// four output channels at once. The frame is zeroed again after every
+// layer. The AVX2 kernel is chosen at run time if the processor has it;
+// otherwise a portable scalar kernel with the same loop structure runs.
+//
+// Weights file: the bytes "GONN", then seven 32-bit little-endian
+// integers (version 1, board size, input planes, blocks B, channels C,
+// value hidden size H, reserved 0) and then every weight and bias as a
+// 32-bit float, in the order of the list above; convolution weights are
+// [out][in][tap] and fully connected weights [out][in], over the N * N
+// board points in row order.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct GoNetworkShape
+{
+    int size = 19;
+    int blocks = 4;
+    int channels = 32;
+    int valueHidden = 64;
+};
+
+class GoNetwork
+{
+public:
+    GoNetwork();
+
+    // Read a weights file; false if it cannot be read or does not fit the
+    // format
+    bool Load(const char* path);
+    bool Save(const char* path) const;
+
+    // Fill the weights with small random values; for benchmarks and for
+    // trying the plumbing before a trained network exists
+    void Randomize(const GoNetworkShape& shape, uint64_t seed);
+
+    const GoNetworkShape& Shape() const { return shape; }
+    bool IsLoaded() const { return !stem.weights.empty(); }
+
+    // Policy entries per position: every point plus the pass
+    int PolicySize() const { return shape.size * shape.size + 1; }
+
+    // Evaluate count positions of FEATURE_PLANES * size * size bytes each,
+    // one after the other at planes. policy receives count * PolicySize()
+    // move probabilities and values count values in [-1, 1] for the
+    // player to move. Safe to call from several threads at once.
+    void Evaluate(const uint8_t* planes, int count, float* policy, float* values) const;
+
+    // Whether the AVX2/FMA kernels are in use; they can be switched off to
+    // compare against the scalar ones
+    static bool HasAvx2();
+    bool UsesAvx2() const { return useAvx2; }
+    void SetUseAvx2(bool enabled) { useAvx2 = enabled && HasAvx2(); }
+
+private:
+    // Convolution or fully connected layer; output channels of a
+    // convolution are padded to a multiple of 4 with zero weights
+    struct Layer
+    {
+        int inputs;
+        int outputs;
+        int taps;
+        std::vector<float> weights;
+        std::vector<float> biases;
+    };
+
+    struct Workspace;
+
+    void Allocate();
+    std::vector<Layer*> Layers();
+    void Convolve(const Layer& layer, const float* input, float* output, const float* residual, bool relu,
+        const Workspace& work) const;
+    void Dense(const Layer& layer, const float* input, float* output) const;
+
+    GoNetworkShape shape;
+    Layer stem;
+    std::vector<Layer> tower;
+    Layer policyConv;
+    Layer policyDense;
+    Layer valueConv;
+    Layer valueDense1;
+    Layer valueDense2;
+    bool useAvx2;
+};
@@ -0,0 +1,48 @@
+// GoNodeArena.cpp : Implements the tree node arena.
+//
+#include "GoNodeArena.h"
+
+#include <new>
+
+#include "GoSearch.h"
+
+GoNodeArena::GoNodeArena(std::size_t capacity)
+    : nodes(nullptr), capacity(0), used(0)
+{
+    Resize(capacity);
+}
+
+GoNodeArena::~GoNodeArena()
+{
+    ::operator delete(nodes);
+}
+
+void GoNodeArena::Resize(std::size_t value)
+{
+    // Nodes are trivially destructible, so the old block is released as is.
+    // The new one is left untouched until nodes are handed out, so unused
+    // capacity costs address space only.
+    ::operator delete(nodes);
+    nodes = value ? static_cast<GoNode*>(::operator new(value * sizeof(GoNode))) : nullptr;
+    capacity = value;
+    Reset();
+}
+
+// Function to hand out count consecutive nodes
+GoNode* GoNodeArena::Allocate(int count)
+{
+    std::size_t first = used.fetch_add(count, std::memory_order_relaxed);
+    if (first + count > capacity)
+        return nullptr; // leaves used above capacity; Used() clamps it
+
+    GoNode* block = nodes + first;
+    for (int i = 0; i < count; ++i)
+        new (block + i) GoNode();
+    return block;
+}
+
+std::size_t GoNodeArena::Used() const
+{
+    std::size_t value = used.load(std::memory_order_relaxed);
+    return value < capacity ? value : capacity;
+}
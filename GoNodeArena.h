@@ -0,0 +1,44 @@
+// GoNodeArena.h : Bump allocator for search tree nodes.
+//
+// The arena reserves one block for a fixed number of nodes up front and
+// hands out child arrays from it by bumping an atomic counter, so worker
+// threads expand nodes concurrently without locks and without touching
+// the general-purpose heap. Nodes are never freed one by one: Reset()
+// reclaims the whole arena at once. When the arena is full, Allocate()
+// fails and the caller leaves the node unexpanded, which bounds the tree's
+// memory.
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+struct GoNode;
+
+class GoNodeArena
+{
+public:
+    explicit GoNodeArena(std::size_t capacity = 0);
+    ~GoNodeArena();
+
+    GoNodeArena(const GoNodeArena&) = delete;
+    GoNodeArena& operator=(const GoNodeArena&) = delete;
+
+    // Drop all nodes and make room for capacity nodes
+    void Resize(std::size_t capacity);
+
+    // Drop all nodes; O(1)
+    void Reset() { used.store(0, std::memory_order_relaxed); }
+
+    // Default-constructed nodes, or nullptr when the arena is full. Safe to
+    // call from several threads at once.
+    GoNode* Allocate(int count);
+
+    std::size_t Used() const;
+    std::size_t Capacity() const { return capacity; }
+
+private:
+    GoNode* nodes;
+    std::size_t capacity;
+    std::atomic<std::size_t> used;
+};
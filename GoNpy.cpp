@@ -0,0 +1,82 @@
+// GoNpy.cpp : Implements the .npy writer.
+//
+#include "GoNpy.h"
+
+#include <cstdlib>
+#include <cstring>
+
+GoNpyWriter::GoNpyWriter()
+    : file(nullptr), failed(false), itemBytes(0), count(0)
+{
+}
+
+GoNpyWriter::~GoNpyWriter()
+{
+    Close();
+}
+
+bool GoNpyWriter::Open(const char* path, const char* type, const std::vector<int>& itemShape)
+{
+    Close();
+    file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+    failed = false;
+    this->type = type;
+    this->itemShape = itemShape;
+    itemBytes = std::strtoul(type + 2, nullptr, 10);
+    for (int extent : itemShape)
+        itemBytes *= extent;
+    count = 0;
+    return WriteHeader();
+}
+
+// Function to write the version 1.0 header for the current count
+bool GoNpyWriter::WriteHeader()
+{
+    std::string shape = "(" + std::to_string(count) + ",";
+    for (std::size_t i = 0; i < itemShape.size(); ++i)
+        shape += (i ? ", " : " ") + std::to_string(itemShape[i]);
+    shape += ")";
+    std::string header = "{'descr': '" + type + "', 'fortran_order': False, 'shape': " + shape + ", }";
+
+    // Magic, version and header length take 10 bytes; the header text is
+    // padded with spaces and ends in a newline
+    const int textBytes = HEADER_BYTES - 10;
+    if ((int)header.size() >= textBytes)
+        return false;
+    header.resize(textBytes - 1, ' ');
+    header += '\n';
+
+    char prefix[10] = { '\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0, (char)(textBytes & 0xff), (char)(textBytes >> 8) };
+    if (std::fseek(file, 0, SEEK_SET) != 0 || std::fwrite(prefix, 1, 10, file) != 10 ||
+        std::fwrite(header.data(), 1, header.size(), file) != header.size())
+    {
+        failed = true;
+        return false;
+    }
+    return std::fseek(file, 0, SEEK_END) == 0;
+}
+
+bool GoNpyWriter::Write(const void* data, std::size_t items)
+{
+    if (!file || failed)
+        return false;
+    if (std::fwrite(data, itemBytes, items, file) != items)
+    {
+        failed = true;
+        return false;
+    }
+    count += items;
+    return true;
+}
+
+bool GoNpyWriter::Close()
+{
+    if (!file)
+        return false;
+    bool ok = !failed && WriteHeader();
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
@@ -0,0 +1,49 @@
+// GoNpy.h : Streaming writer for NumPy .npy array files.
+//
+// An .npy file is a short text header (element type and shape) followed
+// by the raw array in C order, so numpy.load(path, mmap_mode='r') maps it
+// without copying. GoNpyWriter appends items, arrays of a fixed shape, as
+// they are produced and fills in the item count when it is closed. The
+// header is padded to a fixed 128 bytes, which keeps the data aligned and
+// leaves room for any count.
+//
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class GoNpyWriter
+{
+public:
+    GoNpyWriter();
+    ~GoNpyWriter();
+
+    GoNpyWriter(const GoNpyWriter&) = delete;
+    GoNpyWriter& operator=(const GoNpyWriter&) = delete;
+
+    // Create the file for items of the given shape. type is a NumPy type
+    // string such as "|u1", "|i1", "<i2" or "<f4".
+    bool Open(const char* path, const char* type, const std::vector<int>& itemShape);
+
+    // Append count items, stored one after the other at data
+    bool Write(const void* data, std::size_t count);
+
+    // Write the final header; false if anything could not be written
+    bool Close();
+
+    uint64_t Count() const { return count; }
+
+    static const int HEADER_BYTES = 128;
+
+private:
+    bool WriteHeader();
+
+    std::FILE* file;
+    bool failed;
+    std::string type;
+    std::vector<int> itemShape;
+    std::size_t itemBytes;
+    uint64_t count;
+};
@@ -0,0 +1,129 @@
+// GoOwnership.cpp : Implements the playout ownership map.
+//
+#include "GoOwnership.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "GoBitboard.h"
+#include "GoPlayout.h"
+#include "GoPosition.h"
+#include "GoWorkPool.h"
+
+// Playouts per job; small enough to keep every core busy to the end
+static const int PLAYOUTS_PER_JOB = 16;
+
+template <int N>
+GoOwnershipMap EstimateOwnership(const GoPositionT<N>& position, const GoOwnershipOptions& options)
+{
+    const int CELLS = N * N;
+    auto start = std::chrono::steady_clock::now();
+    int playouts = std::max(1, options.playouts);
+
+    // The playouts resume a game that both players have passed
+    GoPositionT<N> resumed(position.GetKoRule());
+    resumed.CopyPosition(position);
+    resumed.ResumePlay();
+
+    // Every worker has its own playout and counts of the playouts in which
+    // Black (first half) and White (second half) own each point
+    GoWorkPool pool(options.threads);
+    std::vector<std::unique_ptr<GoPlayoutT<N>>> engines;
+    std::vector<std::vector<int>> counts(pool.ThreadCount(), std::vector<int>(2 * CELLS, 0));
+    for (int t = 0; t < pool.ThreadCount(); ++t)
+    {
+        engines.emplace_back(new GoPlayoutT<N>(options.seed, options.komi));
+        engines.back()->SetPatterns(options.patterns);
+    }
+    for (int first = 0; first < playouts; first += PLAYOUTS_PER_JOB)
+    {
+        pool.Submit([&, first](int worker) {
+            GoPlayoutT<N>& playout = *engines[worker];
+            int* count = counts[worker].data();
+            Stone owners[N * N];
+            int last = std::min(first + PLAYOUTS_PER_JOB, playouts);
+            for (int i = first; i < last; ++i)
+            {
+                playout.Seed(options.seed ^ (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ull);
+                playout.Run(resumed);
+                AreaOwners(playout.Position(), owners);
+                for (int cell = 0; cell < CELLS; ++cell)
+                {
+                    if (owners[cell] == BLACK)
+                        count[cell] += 1;
+                    else if (owners[cell] == WHITE)
+                        count[CELLS + cell] += 1;
+                }
+            }
+        });
+    }
+    pool.Wait();
+
+    std::vector<int> black(CELLS, 0);
+    std::vector<int> white(CELLS, 0);
+    for (const std::vector<int>& count : counts)
+    {
+        for (int cell = 0; cell < CELLS; ++cell)
+        {
+            black[cell] += count[cell];
+            white[cell] += count[CELLS + cell];
+        }
+    }
+
+    GoOwnershipMap map;
+    map.size = N;
+    map.playouts = playouts;
+    map.ownership.resize(CELLS);
+    map.dead.assign(CELLS, 0);
+    for (int cell = 0; cell < CELLS; ++cell)
+        map.ownership[cell] = (float)(black[cell] - white[cell]) / playouts;
+
+    // Judge each chain once, from its head, by how much more often the
+    // opponent owned its stones than its colour did
+    GoBitboardT<N> blackAlive = GoBitboardT<N>::Empty();
+    GoBitboardT<N> whiteAlive = GoBitboardT<N>::Empty();
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            int point = GoGeometry<N>::Point(x, y);
+            Stone stone = position.AtPoint(point);
+            if ((stone != BLACK && stone != WHITE) || position.ChainHead(point) != point)
+                continue;
+
+            long long held = 0;
+            int size = 0;
+            int current = point;
+            do
+            {
+                int cell = GoGeometry<N>::PointY(current) * N + GoGeometry<N>::PointX(current);
+                held += stone == BLACK ? black[cell] - white[cell] : white[cell] - black[cell];
+                size += 1;
+                current = position.NextStone(current);
+            } while (current != point);
+            bool dead = held < -options.deadMargin * size * playouts;
+
+            do
+            {
+                int cx = GoGeometry<N>::PointX(current);
+                int cy = GoGeometry<N>::PointY(current);
+                if (dead)
+                    map.dead[cy * N + cx] = 1;
+                else
+                    (stone == BLACK ? blackAlive : whiteAlive).Set(GoBitboardT<N>::Bit(cx, cy));
+                current = position.NextStone(current);
+            } while (current != point);
+            if (dead)
+                (stone == BLACK ? map.deadBlack : map.deadWhite) += size;
+        }
+    }
+
+    map.score = ScoreArea(blackAlive, whiteAlive, options.komi);
+    map.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return map;
+}
+
+template GoOwnershipMap EstimateOwnership(const GoPositionT<9>&, const GoOwnershipOptions&);
+template GoOwnershipMap EstimateOwnership(const GoPositionT<13>&, const GoOwnershipOptions&);
+template GoOwnershipMap EstimateOwnership(const GoPositionT<19>&, const GoOwnershipOptions&);
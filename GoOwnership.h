@@ -0,0 +1,58 @@
+// GoOwnership.h : Dead stones at the end of a game, judged by playouts.
+//
+// When both players pass, stones that could not escape capture are often
+// left on the board, and area scoring (see GoScore.h) counts them alive.
+// EstimateOwnership plays many random games on from the final position
+// (see GoPlayout.h), spread over all cores, and counts for every point how
+// often each player owns it by area at the end. A point's ownership is the
+// share of playouts in which Black owns it minus the share in which White
+// does, from +1 to -1. A chain is dead when the opponent owns its stones in
+// more playouts than its own colour does, by more than deadMargin of them,
+// and the score is the area score of the board with the dead chains taken
+// off. Random playouts let an invader live now and then even in a small
+// territory, so a dead chain is rarely lost in every playout.
+//
+// Every playout is seeded from the options' seed and its own index, so the
+// map does not depend on the number of threads or on timing. A thousand
+// playouts settle the status of the groups of a finished 19x19 game; the
+// ownership of points in seki or unsettled fights stays near 0.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GoScore.h"
+#include "GoTypes.h"
+
+class GoPatternWeights;
+template <int N> class GoPositionT;
+
+struct GoOwnershipOptions
+{
+    int playouts = 1000;
+    int threads = 0;                // zero means one per core
+    double komi = 7.5;
+    uint64_t seed = 1;
+    double deadMargin = 0.2;        // share of playouts the opponent must lead by
+    const GoPatternWeights* patterns = nullptr; // playout pattern weights, uniform playouts without
+};
+
+struct GoOwnershipMap
+{
+    int size = 0;
+    std::vector<float> ownership;   // by point, row by row: +1 Black's in every playout, -1 White's
+    std::vector<uint8_t> dead;      // 1 on the stones of dead chains
+    int deadBlack = 0;              // dead stones of each colour
+    int deadWhite = 0;
+    GoAreaScore score = { 0, 0, 0 }; // area score with the dead stones taken off
+    int playouts = 0;
+    double seconds = 0;
+
+    float Ownership(int x, int y) const { return ownership[(std::size_t)y * size + x]; }
+    bool IsDead(int x, int y) const { return dead[(std::size_t)y * size + x] != 0; }
+};
+
+// Defined in GoOwnership.cpp for the sizes in GO_BOARD_SIZES
+template <int N>
+GoOwnershipMap EstimateOwnership(const GoPositionT<N>& position, const GoOwnershipOptions& options);
@@ -0,0 +1,147 @@
+// GoOwnershipBench.cpp : End-of-game dead stone estimation benchmark.
+//
+// Usage: GoOwnershipBench [-size n] [-playouts k] [-runs r] [-j threads] [-moves m] [-seed s] [-sgf file]
+//
+// Takes a finished game, either the main line of the first game in an SGF
+// file or m random moves (one per point by default) on an n x n board (19
+// by default), and estimates its dead stones r times (5) with k playouts
+// each (1000) and different seeds. It prints the time, dead stones and
+// score of every run, how many runs found the same dead stones as the
+// first, and the board of the first run: X and O for live stones, x and o
+// for dead ones, and + and - for empty points Black or White owns in most
+// playouts.
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "GoMappedFile.h"
+#include "GoOwnership.h"
+#include "GoRandom.h"
+#include "GoSgf.h"
+
+// Function to play m random moves, none filling an own eye, and pass
+// twice, which leaves a board of many small groups, some of them dead
+template <int N>
+static void PlayRandomGame(GoPositionT<N>& position, int moves, uint64_t seed)
+{
+    GoRandom random(seed);
+    for (int move = 0; move < moves; ++move)
+    {
+        GoMoveListT<N> legal;
+        position.GenerateLegalMoves(legal, true);
+        if (legal.count == 0)
+            position.Pass();
+        else
+            position.TryPlay(legal.moves[random.Below(legal.count)]);
+    }
+    position.Pass();
+    position.Pass();
+}
+
+// Function to replay the first game of an SGF file; false if it cannot
+// be read or is for another board size
+template <int N>
+static bool ReadSgfGame(const char* path, GoPositionT<N>& position)
+{
+    GoMappedFile file;
+    std::vector<std::string_view> trees;
+    GoSgfGame game;
+    if (!file.Open(path) || !FindSgfGames(std::string_view(file.Data(), file.Size()), trees) || trees.empty() ||
+        !ParseSgfGame(trees[0], game) || game.size != N)
+        return false;
+    GoHashHistory seen;
+    GoSgfReport report;
+    ReplaySgfGame(game, position, seen, report);
+    return true;
+}
+
+template <int N>
+static int RunBench(const char* sgfPath, const GoOwnershipOptions& base, int runs, int moves)
+{
+    GoPositionT<N> position;
+    if (sgfPath)
+    {
+        if (!ReadSgfGame(sgfPath, position))
+        {
+            std::fprintf(stderr, "cannot read a %dx%d game from %s\n", N, N, sgfPath);
+            return 1;
+        }
+    }
+    else
+        PlayRandomGame(position, moves < 0 ? N * N : moves, base.seed);
+
+    GoAreaScore raw = ScoreArea(position, base.komi);
+    std::printf("%dx%d, %d playouts per estimate, area score as it stands %+.1f\n", N, N, base.playouts,
+        raw.Margin());
+
+    GoOwnershipMap first;
+    int same = 0;
+    for (int run = 0; run < runs; ++run)
+    {
+        GoOwnershipOptions options = base;
+        options.seed = base.seed + run;
+        GoOwnershipMap map = EstimateOwnership(position, options);
+        std::printf("run %d: %8.3f s %4d dead Black %4d dead White, score %+.1f\n", run, map.seconds,
+            map.deadBlack, map.deadWhite, map.score.Margin());
+        if (run == 0)
+            first = map;
+        same += map.dead == first.dead;
+    }
+    std::printf("%d of %d runs found the same dead stones\n\n", same, runs);
+
+    for (int y = 0; y < N; ++y)
+    {
+        std::string row;
+        for (int x = 0; x < N; ++x)
+        {
+            Stone stone = position.At(x, y);
+            float owner = first.Ownership(x, y);
+            if (stone == BLACK || stone == WHITE)
+                row += first.IsDead(x, y) ? (stone == BLACK ? 'x' : 'o') : (stone == BLACK ? 'X' : 'O');
+            else
+                row += owner > 0.5f ? '+' : owner < -0.5f ? '-' : '.';
+            row += ' ';
+        }
+        std::printf("%s\n", row.c_str());
+    }
+    return same == runs ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = 19;
+    int runs = 5;
+    int moves = -1;
+    const char* sgfPath = nullptr;
+    GoOwnershipOptions options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-size") == 0)
+            size = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-playouts") == 0)
+            options.playouts = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-runs") == 0)
+            runs = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-j") == 0)
+            options.threads = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-moves") == 0)
+            moves = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-seed") == 0)
+            options.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "-sgf") == 0)
+            sgfPath = argv[i + 1];
+    }
+    if ((size != 9 && size != 13 && size != 19) || runs < 1 || options.playouts < 1)
+    {
+        std::fprintf(stderr, "usage: GoOwnershipBench [-size 9|13|19] [-playouts k] [-runs r] [-j threads] [-moves m] "
+            "[-seed s] [-sgf file]\n");
+        return 2;
+    }
+    if (size == 9)
+        return RunBench<9>(sgfPath, options, runs, moves);
+    if (size == 13)
+        return RunBench<13>(sgfPath, options, runs, moves);
+    return RunBench<19>(sgfPath, options, runs, moves);
+}
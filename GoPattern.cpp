@@ -0,0 +1,215 @@
+// GoPattern.cpp : Implements pattern weight tables.
+//
+#include "GoPattern.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// Built-in rules. Later rules win, so the atari ones come last and hold
+// whatever else is around.
+static const char DEFAULT_PATTERNS[] =
+    "# Empty surroundings, and the first line in them\n"
+    "... ... ...  0.5\n"
+    "... ... +++  0.2\n"
+    "# Hane and cuts\n"
+    "XOX ... ???  6\n"
+    "XO. ... ?.?  6\n"
+    "XO? X.. ?.?  6\n"
+    "XO? O.? ???  5\n"
+    "# Blocking on the edge\n"
+    "?X? O.? +++  4\n"
+    "# Take a chain in atari, save one of ours\n"
+    "?o? ?.? ???  40\n"
+    "?x? ?.? ???  12\n";
+
+// Direction of each code field, in the order of GoGeometry's
+// NEIGHBOR_OFFSETS then DIAGONAL_OFFSETS
+static const int FIELD_DX[8] = { -1, 1, 0, 0, -1, 1, -1, 1 };
+static const int FIELD_DY[8] = { 0, 0, -1, 1, -1, -1, 1, 1 };
+
+// Function to find the field of a direction
+static int FieldOf(int dx, int dy)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        if (FIELD_DX[i] == dx && FIELD_DY[i] == dy)
+            return i;
+    }
+    return -1;
+}
+
+// Function to map a code to its image under one of the eight symmetries:
+// bit 2 transposes, bit 0 mirrors left to right, bit 1 top to bottom
+static int TransformCode(int code, int symmetry)
+{
+    int result = code & ~(PATTERN_CODES - 1);
+    for (int i = 0; i < 8; ++i)
+    {
+        int dx = FIELD_DX[i], dy = FIELD_DY[i];
+        if (symmetry & 4)
+        {
+            int swap = dx;
+            dx = dy;
+            dy = swap;
+        }
+        if (symmetry & 1)
+            dx = -dx;
+        if (symmetry & 2)
+            dy = -dy;
+        int field = FieldOf(dx, dy);
+        result |= ((code >> (2 * i)) & 3) << (2 * field);
+        if (i < 4 && (code >> (PATTERN_ATARI_SHIFT + i)) & 1)
+            result |= 1 << (PATTERN_ATARI_SHIFT + field);
+    }
+    return result;
+}
+
+GoPatternWeights::GoPatternWeights()
+    : weights(PATTERN_CODES, ONE), ruleCount(0), errorLine(0)
+{
+}
+
+void GoPatternWeights::Clear()
+{
+    weights.assign(PATTERN_CODES, ONE);
+    ruleCount = 0;
+}
+
+bool GoPatternWeights::Parse(const std::string& text)
+{
+    std::istringstream lines(text);
+    std::string line;
+    int number = 0;
+    while (std::getline(lines, line))
+    {
+        number += 1;
+        if (!ParseRule(line))
+        {
+            errorLine = number;
+            return false;
+        }
+    }
+    errorLine = 0;
+    return true;
+}
+
+bool GoPatternWeights::Load(const char* path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        errorLine = 0;
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return Parse(text.str());
+}
+
+void GoPatternWeights::SetDefaults()
+{
+    Clear();
+    Parse(DEFAULT_PATTERNS);
+}
+
+// Function to apply one line; blank lines and comments are fine
+bool GoPatternWeights::ParseRule(const std::string& line)
+{
+    std::istringstream fields(line.substr(0, line.find('#')));
+    std::string rows[3];
+    std::string weightText;
+    if (!(fields >> rows[0]))
+        return true;
+    if (!(fields >> rows[1] >> rows[2] >> weightText) || rows[0].size() != 3 || rows[1].size() != 3 ||
+        rows[2].size() != 3 || rows[1][1] != '.')
+        return false;
+    std::string rest;
+    if (fields >> rest)
+        return false;
+
+    char* end = nullptr;
+    double value = std::strtod(weightText.c_str(), &end);
+    if (*end != '\0' || !(value >= 0))
+        return false;
+    // Clamped before rounding, so that huge weights cannot overflow
+    value = std::min(value, (double)MAX_WEIGHT / ONE);
+    uint32_t weight = (uint32_t)std::lround(value * ONE);
+
+    // The codes each field may take: a color, and for neighbours an atari
+    // flag on top
+    int options[8][6];
+    int optionCount[8] = {};
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            if (r == 1 && c == 1)
+                continue;
+            int field = FieldOf(c - 1, r - 1);
+            int atari = field < 4 ? 1 << (PATTERN_ATARI_SHIFT + field) : 0;
+            int* option = options[field];
+            int& count = optionCount[field];
+            int shift = 2 * field;
+            switch (rows[r][c])
+            {
+            case '.':
+                option[count++] = EMPTY << shift;
+                break;
+            case '+':
+                option[count++] = OFFBOARD << shift;
+                break;
+            case 'X':
+            case 'O':
+            case '?':
+                if (rows[r][c] != 'O')
+                {
+                    option[count++] = BLACK << shift;
+                    if (atari)
+                        option[count++] = BLACK << shift | atari;
+                }
+                if (rows[r][c] != 'X')
+                {
+                    option[count++] = WHITE << shift;
+                    if (atari)
+                        option[count++] = WHITE << shift | atari;
+                }
+                if (rows[r][c] == '?')
+                {
+                    option[count++] = EMPTY << shift;
+                    option[count++] = OFFBOARD << shift;
+                }
+                break;
+            case 'x':
+            case 'o':
+                if (!atari)
+                    return false;
+                option[count++] = (rows[r][c] == 'x' ? BLACK : WHITE) << shift | atari;
+                break;
+            default:
+                return false;
+            }
+        }
+    }
+
+    // Every combination of the options, in every orientation
+    int choice[8] = {};
+    for (;;)
+    {
+        int code = 0;
+        for (int field = 0; field < 8; ++field)
+            code |= options[field][choice[field]];
+        for (int symmetry = 0; symmetry < 8; ++symmetry)
+            weights[TransformCode(code, symmetry)] = weight;
+
+        int field = 0;
+        while (field < 8 && ++choice[field] == optionCount[field])
+            choice[field++] = 0;
+        if (field == 8)
+            break;
+    }
+    ruleCount += 1;
+    return true;
+}
@@ -0,0 +1,82 @@
+// GoPattern.h : Weights of 3x3 patterns for the playout policy.
+//
+// A point's pattern is the color of each of its eight surrounding points
+// (empty, Black, White or off the board) plus, for the four neighbours
+// holding a stone, whether that stone's chain is in atari: a 20-bit code,
+// laid out as described at PATTERN_ATARI_SHIFT in GoTypes.h. GoPosition
+// keeps the codes up to date as stones come and go.
+//
+// GoPatternWeights maps every code to a weight for playing on the middle
+// point, with Black to move; White's weights are the same table read with
+// the colors swapped. The playouts (see GoPlayout.h) draw moves with
+// probability in proportion to these weights. Every pattern starts at 1.
+//
+// Weights are read from text, one rule per line:
+//
+//     # comment
+//     ?o? ?.? ???  40     (capture a chain in atari)
+//     XO. ... ???  4
+//
+// The three groups are the rows of the pattern, top to bottom, and the
+// number is the weight. In the rows, '.' is an empty point, 'X' a stone of
+// the player to move and 'O' an opponent stone, in atari or not; 'x' and
+// 'o' are such stones whose chain is in atari (neighbours only), '+' is
+// off the board and '?' anything. The middle is always '.'. A rule covers
+// its pattern in all eight orientations and overrides the rules before it.
+// Weights are kept in steps of 1/256 up to 4096; a weight of 0 keeps the
+// playouts from ever playing there.
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GoTypes.h"
+
+// Function to give the same pattern seen by the other player
+inline int SwapPatternColors(int code)
+{
+    return (code & ~0xFFFF) | ((code & 0x5555) << 1) | ((code >> 1) & 0x5555);
+}
+
+class GoPatternWeights
+{
+public:
+    // Fixed-point weight of 1, and the largest weight
+    static constexpr uint32_t ONE = 256;
+    static constexpr uint32_t MAX_WEIGHT = 4096 * ONE;
+
+    // Every pattern weighs 1
+    GoPatternWeights();
+
+    // Set every pattern back to 1
+    void Clear();
+
+    // Apply the rules in a text, or in a file; false on a line that cannot
+    // be read, whose number ErrorLine() then gives (0 if the file could
+    // not be opened). Rules before the bad line stay applied.
+    bool Parse(const std::string& text);
+    bool Load(const char* path);
+    int ErrorLine() const { return errorLine; }
+
+    // Replace the weights by a small built-in set: captures, escapes from
+    // atari and a few common shapes
+    void SetDefaults();
+
+    // Weight of playing in the middle of a pattern, for the given player
+    uint32_t Weight(int code, Stone player) const
+    {
+        return weights[player == BLACK ? code : SwapPatternColors(code)];
+    }
+
+    // Number of rules applied since the last Clear
+    int RuleCount() const { return ruleCount; }
+
+private:
+    bool ParseRule(const std::string& line);
+
+    std::vector<uint32_t> weights;
+    int ruleCount;
+    int errorLine;
+};
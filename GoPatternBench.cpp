@@ -0,0 +1,135 @@
+// GoPatternBench.cpp : Pattern-weighted playouts against uniform ones.
+//
+// Usage: GoPatternBench [-size n] [-playouts k] [-patterns file] [-games g] [-p n] [-j threads] [-seed s]
+//
+// Runs k playouts (2000 by default) from the empty n x n board (9 by
+// default) with uniformly random moves and again with moves drawn by
+// pattern weight, and reports playouts per second, the average game length
+// and Black's win rate of each. Then it plays a match of g games (100;
+// 0 skips it) between two searches of n playouts per move (1000) that
+// differ only in their playouts, on all cores, and reports the pattern
+// player's score and the Elo difference it implies.
+//
+// The weights are the built-in ones (GoPatternWeights::SetDefaults) unless
+// a file of rules is given.
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "GoMatchRunner.h"
+#include "GoPlayout.h"
+
+struct PlayoutTotals
+{
+    double seconds;
+    long long moves;
+    int blackWins;
+};
+
+// Function to time playouts from the empty board
+template <int N>
+static PlayoutTotals RunPlayouts(int playouts, uint64_t seed, const GoPatternWeights* patterns)
+{
+    GoPlayoutT<N> playout(seed);
+    playout.SetPatterns(patterns);
+    GoPositionT<N> start;
+    PlayoutTotals totals = PlayoutTotals();
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < playouts; ++i)
+    {
+        GoPlayoutResult result = playout.Run(start);
+        totals.moves += result.moves;
+        totals.blackWins += result.Winner() == BLACK;
+    }
+    totals.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return totals;
+}
+
+template <int N>
+static void ComparePlayouts(int playouts, uint64_t seed, const GoPatternWeights& patterns)
+{
+    const char* names[2] = { "uniform", "patterns" };
+    for (int i = 0; i < 2; ++i)
+    {
+        PlayoutTotals totals = RunPlayouts<N>(playouts, seed, i == 0 ? nullptr : &patterns);
+        std::printf("%-10s %10.0f playouts/s %8.1f moves %8.1f%% Black wins\n", names[i],
+            playouts / totals.seconds, (double)totals.moves / playouts, 100.0 * totals.blackWins / playouts);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int size = 9;
+    int playouts = 2000;
+    int games = 100;
+    long long searchPlayouts = 1000;
+    int threads = 0;
+    uint64_t seed = 1;
+    const char* patternPath = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-size") == 0)
+            size = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-playouts") == 0)
+            playouts = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-patterns") == 0)
+            patternPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "-games") == 0)
+            games = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-p") == 0)
+            searchPlayouts = std::atoll(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-j") == 0)
+            threads = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-seed") == 0)
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    if ((size != 9 && size != 13 && size != 19) || playouts < 1)
+    {
+        std::fprintf(stderr, "usage: GoPatternBench [-size 9|13|19] [-playouts k] [-patterns file] [-games g] "
+            "[-p n] [-j threads] [-seed s]\n");
+        return 2;
+    }
+
+    GoPatternWeights patterns;
+    if (!patternPath)
+        patterns.SetDefaults();
+    else if (!patterns.Load(patternPath))
+    {
+        std::fprintf(stderr, "cannot read %s, line %d\n", patternPath, patterns.ErrorLine());
+        return 1;
+    }
+
+    std::printf("%dx%d, %d playouts, %d pattern rules\n", size, size, playouts, patterns.RuleCount());
+    if (size == 9)
+        ComparePlayouts<9>(playouts, seed, patterns);
+    else if (size == 13)
+        ComparePlayouts<13>(playouts, seed, patterns);
+    else
+        ComparePlayouts<19>(playouts, seed, patterns);
+    if (games <= 0)
+        return 0;
+
+    GoMatchOptions options;
+    options.size = size;
+    options.games = games;
+    options.threads = threads;
+    options.seed = seed;
+    GoMatchPlayer players[2];
+    for (int p = 0; p < 2; ++p)
+    {
+        players[p].name = p == 0 ? "patterns" : "uniform";
+        players[p].options.treeMemory = 32 << 20;
+        players[p].options.patterns = p == 0 ? &patterns : nullptr;
+        players[p].limits.playouts = searchPlayouts;
+    }
+    GoMatchStats stats = GoMatchRunner(options, players[0], players[1]).Run();
+    double score = stats.Score();
+    double margin = stats.ScoreMargin();
+    std::printf("%d games, %lld playouts per move, in %.1f s\n", stats.games, searchPlayouts, stats.seconds);
+    std::printf("%-22s %7.1f%% +- %.1f%%\n", "patterns score", 100 * score, 100 * margin);
+    std::printf("%-22s %+7.0f  [%+.0f, %+.0f]\n", "Elo difference", stats.EloDifference(),
+        GoMatchStats::Elo(score - margin), GoMatchStats::Elo(score + margin));
+    return 0;
+}
@@ -0,0 +1,255 @@
+// GoPlayout.cpp : Implements random playouts.
+//
+#include "GoPlayout.h"
+
+#include "GoMetrics.h"
+#include "GoScore.h"
+
+template <int N>
+GoPlayoutT<N>::GoPlayoutT(uint64_t seed, double komi)
+    : random(seed), komi(komi), emptyCount(0), patterns(nullptr), refreshSerial(0)
+{
+    position.SetUndoEnabled(false);
+    for (int point = 0; point < POINTS; ++point)
+        refreshed[point] = 0;
+}
+
+template <int N>
+void GoPlayoutT<N>::SetPatterns(const GoPatternWeights* weights)
+{
+    patterns = weights;
+    position.SetPatternsEnabled(weights != nullptr);
+}
+
+// Function to play a random game from start to the end and score it
+template <int N>
+GoPlayoutResult GoPlayoutT<N>::Run(const GoPositionT<N>& start)
+{
+    GO_METRIC_TIME(TIMER_PLAYOUT);
+    position.CopyPosition(start);
+    position.ReserveHistory(MAX_MOVES);
+    if (patterns)
+        ComputeWeights();
+    else
+        CollectEmptyPoints();
+
+    int moves = 0;
+    while (!position.IsGameOver() && moves < MAX_MOVES)
+    {
+        Stone player = position.CurrentPlayer();
+        if ((patterns ? PlayWeighted(player) : PlayUniform(player)) == PASS_MOVE)
+            position.Pass();
+        moves += 1;
+    }
+
+    GO_METRIC_ADD(METRIC_PLAYOUT_MOVES, moves);
+    GoPlayoutResult result;
+    result.score = ScoreArea(position, komi).Margin();
+    result.moves = moves;
+    return result;
+}
+
+// Function to play a uniformly random move that does not fill an eye of
+// the player's; PASS_MOVE if there is none, without passing
+template <int N>
+int GoPlayoutT<N>::PlayUniform(Stone player)
+{
+    int captures = position.BlackScore() + position.WhiteScore();
+
+    // Draw points at random; a point that cannot be played is moved
+    // behind the untried ones so it is not drawn again this turn
+    int untried = emptyCount;
+    while (untried > 0)
+    {
+        int i = random.Below(untried);
+        int point = emptyPoints[i];
+        if (!position.IsTrueEye(point, player) && position.TryPlay(point))
+        {
+            if (position.BlackScore() + position.WhiteScore() != captures)
+                CollectEmptyPoints();
+            else
+                RemoveEmptyPoint(point);
+            return point;
+        }
+        untried -= 1;
+        SwapEmptyPoints(i, untried);
+    }
+    return PASS_MOVE;
+}
+
+// Function to play a move drawn by pattern weight, as PlayUniform
+template <int N>
+int GoPlayoutT<N>::PlayWeighted(Stone player)
+{
+    // A point that cannot be played weighs nothing until the move is made,
+    // so it is not drawn again this turn
+    int color = player == BLACK ? 0 : 1;
+    int played = PASS_MOVE;
+    int rejectedCount = 0;
+    while (totalWeight[color] > 0)
+    {
+        int point = FindWeight(color, (uint32_t)random.Below((int)totalWeight[color]));
+        if (!position.IsTrueEye(point, player) && position.TryPlay(point))
+        {
+            played = point;
+            break;
+        }
+        rejected[rejectedCount++] = (short)point;
+        SetWeight(color, point, 0);
+    }
+
+    RefreshWeights();
+    for (int i = 0; i < rejectedCount; ++i)
+        WeighPoint(rejected[i]);
+    return played;
+}
+
+// Function to weigh every point from scratch
+template <int N>
+void GoPlayoutT<N>::ComputeWeights()
+{
+    for (int color = 0; color < 2; ++color)
+    {
+        Stone player = color == 0 ? BLACK : WHITE;
+        uint32_t* weights = pointWeights[color];
+        uint32_t* tree = weightTree[color];
+        for (int point = 0; point < POINTS; ++point)
+        {
+            weights[point] = position.AtPoint(point) == EMPTY ?
+                patterns->Weight(position.PatternCode(point), player) : 0;
+        }
+
+        // Build the tree bottom up: each node adds itself to its parent
+        totalWeight[color] = 0;
+        for (int i = 1; i <= POINTS; ++i)
+            tree[i] = weights[i - 1];
+        for (int i = 1; i <= POINTS; ++i)
+        {
+            totalWeight[color] += weights[i - 1];
+            int parent = i + (i & -i);
+            if (parent <= POINTS)
+                tree[parent] += tree[i];
+        }
+    }
+    position.ClearPatternChanges();
+}
+
+// Function to weigh again the points around every pattern change the
+// position has listed since the last time
+template <int N>
+void GoPlayoutT<N>::RefreshWeights()
+{
+    if (position.PatternChangesOverflowed())
+    {
+        ComputeWeights();
+        return;
+    }
+    // The 3x3 areas of nearby changes overlap; weigh each point once
+    refreshSerial += 1;
+    for (int i = 0; i < position.PatternChangeCount(); ++i)
+    {
+        int point = position.PatternChange(i);
+        for (int j = 0; j < 9; ++j)
+        {
+            int adj = point + (j < 4 ? GoGeometry<N>::NEIGHBOR_OFFSETS[j] :
+                j < 8 ? GoGeometry<N>::DIAGONAL_OFFSETS[j - 4] : 0);
+            if (refreshed[adj] != refreshSerial)
+            {
+                refreshed[adj] = refreshSerial;
+                WeighPoint(adj);
+            }
+        }
+    }
+    position.ClearPatternChanges();
+}
+
+template <int N>
+void GoPlayoutT<N>::WeighPoint(int point)
+{
+    Stone stone = position.AtPoint(point);
+    if (stone == OFFBOARD)
+        return;
+    if (stone != EMPTY)
+    {
+        SetWeight(0, point, 0);
+        SetWeight(1, point, 0);
+        return;
+    }
+    int code = position.PatternCode(point);
+    SetWeight(0, point, patterns->Weight(code, BLACK));
+    SetWeight(1, point, patterns->Weight(code, WHITE));
+}
+
+template <int N>
+void GoPlayoutT<N>::SetWeight(int color, int point, uint32_t weight)
+{
+    uint32_t delta = weight - pointWeights[color][point];
+    if (delta == 0)
+        return;
+    pointWeights[color][point] = weight;
+    totalWeight[color] += delta;
+    for (int i = point + 1; i <= POINTS; i += i & -i)
+        weightTree[color][i] += delta;
+}
+
+// Function to find the point where the running total of a player's
+// weights passes target, which must be below the total
+template <int N>
+int GoPlayoutT<N>::FindWeight(int color, uint32_t target) const
+{
+    const uint32_t* tree = weightTree[color];
+    int step = 1;
+    while (2 * step <= POINTS)
+        step *= 2;
+    int index = 0;
+    for (; step > 0; step /= 2)
+    {
+        if (index + step <= POINTS && tree[index + step] <= target)
+        {
+            index += step;
+            target -= tree[index];
+        }
+    }
+    return index;
+}
+
+// Function to rebuild the empty point list from the board
+template <int N>
+void GoPlayoutT<N>::CollectEmptyPoints()
+{
+    emptyCount = 0;
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            int point = GoGeometry<N>::Point(x, y);
+            if (position.AtPoint(point) == EMPTY)
+            {
+                emptyIndex[point] = (short)emptyCount;
+                emptyPoints[emptyCount++] = point;
+            }
+        }
+    }
+}
+
+template <int N>
+void GoPlayoutT<N>::RemoveEmptyPoint(int point)
+{
+    emptyCount -= 1;
+    SwapEmptyPoints(emptyIndex[point], emptyCount);
+}
+
+template <int N>
+void GoPlayoutT<N>::SwapEmptyPoints(int i, int j)
+{
+    int a = emptyPoints[i];
+    int b = emptyPoints[j];
+    emptyPoints[i] = b;
+    emptyPoints[j] = a;
+    emptyIndex[b] = (short)i;
+    emptyIndex[a] = (short)j;
+}
+
+template class GoPlayoutT<9>;
+template class GoPlayoutT<13>;
+template class GoPlayoutT<19>;
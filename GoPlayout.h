@@ -0,0 +1,103 @@
+// GoPlayout.h : Random playouts for Monte Carlo evaluation.
+//
+// A GoPlayout plays a game on from a given position with uniformly random
+// legal moves until both sides pass, then scores it. A side passes only
+// when every legal move left would fill one of its own true eyes, so the
+// finished board consists of living groups and their eyes, and it is
+// scored by Tromp-Taylor area (see GoScore.h).
+//
+// With pattern weights set (SetPatterns), moves are drawn instead with
+// probability in proportion to the weight of their 3x3 pattern (see
+// GoPattern.h). The scratch position keeps the pattern codes up to date,
+// and the playout keeps each player's weights in a Fenwick tree over the
+// points, so drawing a move and updating the weights around the stones
+// that changed both take time logarithmic in the board size.
+//
+// Each GoPlayout owns its scratch position, its random generator and its
+// list of empty points, all sized at construction, so Run() does not
+// touch the heap once the scratch position has seen one long game. Give
+// every thread its own GoPlayout; with the same seed, the same start
+// positions give the same results.
+//
+#pragma once
+
+#include <cstdint>
+
+#include "GoPattern.h"
+#include "GoPosition.h"
+#include "GoRandom.h"
+
+// Outcome of one playout
+struct GoPlayoutResult
+{
+    double score;   // Black's area minus White's area minus komi
+    int moves;      // moves and passes played from the start position
+
+    Stone Winner() const { return score > 0 ? BLACK : score < 0 ? WHITE : EMPTY; }
+};
+
+template <int N>
+class GoPlayoutT
+{
+public:
+    explicit GoPlayoutT(uint64_t seed = 1, double komi = 7.5);
+
+    // Restart the random sequence
+    void Seed(uint64_t seed) { random.Seed(seed); }
+
+    void SetKomi(double value) { komi = value; }
+    double Komi() const { return komi; }
+
+    // Draw moves by pattern weight, or uniformly with nullptr (the
+    // default). The weights are not copied and must outlive the playout.
+    void SetPatterns(const GoPatternWeights* weights);
+    const GoPatternWeights* Patterns() const { return patterns; }
+
+    // Play start on to the end of the game and score it; start itself is
+    // not changed
+    GoPlayoutResult Run(const GoPositionT<N>& start);
+
+    // The scratch position as the last Run left it, at the end of its game
+    const GoPositionT<N>& Position() const { return position; }
+
+    // Games that have not ended after this many moves are scored as they
+    // stand (long ko fights under simple ko)
+    static const int MAX_MOVES = 3 * N * N;
+
+private:
+    static constexpr int POINTS = GoGeometry<N>::POINTS;
+
+    int PlayUniform(Stone player);
+    int PlayWeighted(Stone player);
+    void ComputeWeights();
+    void RefreshWeights();
+    void WeighPoint(int point);
+    void SetWeight(int color, int point, uint32_t weight);
+    int FindWeight(int color, uint32_t target) const;
+    void CollectEmptyPoints();
+    void RemoveEmptyPoint(int point);
+    void SwapEmptyPoints(int i, int j);
+
+    GoPositionT<N> position;
+    GoRandom random;
+    double komi;
+
+    // Empty points of the scratch position and each point's index in it
+    int emptyPoints[N * N];
+    short emptyIndex[POINTS];
+    int emptyCount;
+
+    // Pattern weights and, for each player (Black, White), the weight of
+    // playing on every point and a Fenwick tree over those weights
+    const GoPatternWeights* patterns;
+    uint32_t pointWeights[2][POINTS];
+    uint32_t weightTree[2][POINTS + 1];
+    uint32_t totalWeight[2];
+    short rejected[POINTS];
+
+    // Weight refresh each point last had, to weigh it once per move
+    unsigned refreshed[POINTS];
+    unsigned refreshSerial;
+};
+
+typedef GoPlayoutT<19> GoPlayout;
@@ -0,0 +1,842 @@
+// GoPosition.cpp : Implements the headless Go rules engine.
+//
+#include "GoPosition.h"
+
+#include <algorithm>
+
+#include "GoMetrics.h"
+
+template <int N>
+GoPositionT<N>::GoPositionT(KoRule rule)
+    : koRule(rule), undoEnabled(true), patternsEnabled(false), patternChangeCount(0), patternOverflow(false)
+{
+    Reset();
+}
+
+// Function to reset the game board and scores
+template <int N>
+void GoPositionT<N>::Reset()
+{
+    for (int point = 0; point < POINTS; ++point)
+    {
+        board[point] = OFFBOARD;
+        chainHead[point] = 0;
+        nextStone[point] = 0;
+        chains[point] = Chain();
+        chainSaved[point] = 0;
+    }
+    for (int i = 0; i < SIZE; ++i)
+        for (int j = 0; j < SIZE; ++j)
+            board[Point(i, j)] = EMPTY;
+
+    currentPlayer = BLACK;
+    blackScore = 0;
+    whiteScore = 0;
+    consecutivePasses = 0;
+    hash = 0;
+    koPoint = 0;
+
+    journal.clear();
+    frames.clear();
+    frameSerial = 1;
+    history.Clear();
+    RecordPosition();
+    if (patternsEnabled)
+        ComputeNeighbourCodes();
+}
+
+template <int N>
+void GoPositionT<N>::SetKoRule(KoRule rule)
+{
+    koRule = rule;
+    Reset();
+}
+
+// Function to toggle the current player
+template <int N>
+void GoPositionT<N>::TogglePlayer()
+{
+    PushFrame();
+    SwitchSides();
+    koPoint = 0;
+    RecordPosition();
+}
+
+// Function to hand the move to the other player and update the hash
+template <int N>
+void GoPositionT<N>::SwitchSides()
+{
+    currentPlayer = Opponent(currentPlayer);
+    hash ^= ZOBRIST.whiteToMove;
+}
+
+// Function to handle passing the turn
+template <int N>
+void GoPositionT<N>::Pass()
+{
+    PushFrame();
+    consecutivePasses += 1;
+    SwitchSides();
+    koPoint = 0;
+    RecordPosition();
+}
+
+// Hash the superko history is keyed on under the current rule
+template <int N>
+uint64_t GoPositionT<N>::SuperkoKey() const
+{
+    return koRule == KO_SITUATIONAL_SUPERKO ? hash : PositionHash();
+}
+
+// Function to remember the current position for the superko check; the
+// open undo frame notes whether it was new so Undo can forget it again
+template <int N>
+void GoPositionT<N>::RecordPosition()
+{
+    if (koRule == KO_SIMPLE)
+        return;
+
+    bool inserted = history.Insert(SuperkoKey());
+    if (undoEnabled && !frames.empty())
+        frames.back().recorded = inserted;
+}
+
+// Function to place a stone on the board
+template <int N>
+bool GoPositionT<N>::PlaceStone(int x, int y)
+{
+    return TryPlay(Point(x, y));
+}
+
+// Function to check and play a move in one pass. Occupancy, suicide and
+// simple ko are O(1) neighbour checks done up front; superko is checked
+// on the hash the move actually produced and rolled back from the undo
+// journal if the position has occurred before.
+template <int N>
+bool GoPositionT<N>::TryPlay(int move)
+{
+    if (move == PASS_MOVE)
+    {
+        Pass();
+        return true;
+    }
+    GO_METRIC_TIME(TIMER_PLAY);
+
+    // Without a journal there is nothing to roll back with, so check first
+    if (!undoEnabled && !IsLegal(move))
+        return false;
+    if (undoEnabled && !HasLiberty(move))
+        return false;
+
+    PushFrame();
+    PlayAt(move);
+
+    consecutivePasses = 0; // Reset pass count after a valid move
+
+    // Toggle to the next player
+    SwitchSides();
+
+    if (undoEnabled && koRule != KO_SIMPLE && history.Contains(SuperkoKey()))
+    {
+        Undo();
+        return false;
+    }
+    RecordPosition();
+
+    return true;
+}
+
+// Function to start an undo frame for the next change of position
+template <int N>
+void GoPositionT<N>::PushFrame()
+{
+    if (!undoEnabled)
+        return;
+
+    UndoFrame frame;
+    frame.journalSize = (int)journal.size();
+    frame.hash = hash;
+    frame.koPoint = koPoint;
+    frame.player = currentPlayer;
+    frame.blackScore = blackScore;
+    frame.whiteScore = whiteScore;
+    frame.consecutivePasses = consecutivePasses;
+    frame.recorded = false;
+    frames.push_back(frame);
+    frameSerial += 1;
+}
+
+// Function to take back the last move, pass or turn skip. Replays the
+// journal backwards, so the cost is proportional to what the move changed.
+template <int N>
+bool GoPositionT<N>::Undo()
+{
+    if (frames.empty())
+        return false;
+
+    const UndoFrame& frame = frames.back();
+    if (frame.recorded)
+        history.Remove(SuperkoKey());
+
+    for (int i = (int)journal.size() - 1; i >= frame.journalSize; --i)
+    {
+        const JournalEntry& entry = journal[i];
+        switch (entry.field)
+        {
+        case JOURNAL_BOARD:
+            board[entry.point] = (Stone)entry.value.size;
+            if (patternsEnabled)
+                UpdateNeighbourCodes(entry.point, board[entry.point]);
+            break;
+        case JOURNAL_CHAIN_HEAD:
+            chainHead[entry.point] = (short)entry.value.size;
+            break;
+        case JOURNAL_NEXT_STONE:
+            nextStone[entry.point] = (short)entry.value.size;
+            break;
+        case JOURNAL_CHAIN:
+            if (patternsEnabled)
+                NoteAtari(entry.point);
+            chains[entry.point] = entry.value;
+            if (patternsEnabled)
+                NoteAtari(entry.point);
+            break;
+        }
+    }
+    journal.resize(frame.journalSize);
+
+    hash = frame.hash;
+    koPoint = frame.koPoint;
+    currentPlayer = frame.player;
+    blackScore = frame.blackScore;
+    whiteScore = frame.whiteScore;
+    consecutivePasses = frame.consecutivePasses;
+    frames.pop_back();
+    return true;
+}
+
+template <int N>
+void GoPositionT<N>::SetUndoEnabled(bool enabled)
+{
+    undoEnabled = enabled;
+    journal.clear();
+    frames.clear();
+}
+
+// Function to copy another position's game state, keeping this
+// position's undo setting and buffers
+template <int N>
+void GoPositionT<N>::CopyPosition(const GoPositionT& other)
+{
+    std::copy(other.board, other.board + POINTS, board);
+    std::copy(other.chainHead, other.chainHead + POINTS, chainHead);
+    std::copy(other.nextStone, other.nextStone + POINTS, nextStone);
+    std::copy(other.chains, other.chains + POINTS, chains);
+
+    currentPlayer = other.currentPlayer;
+    hash = other.hash;
+    koPoint = other.koPoint;
+    koRule = other.koRule;
+    history.Assign(other.history);
+    blackScore = other.blackScore;
+    whiteScore = other.whiteScore;
+    consecutivePasses = other.consecutivePasses;
+
+    journal.clear();
+    frames.clear();
+    if (patternsEnabled)
+        ComputeNeighbourCodes();
+}
+
+// Journaling setters: every write to the board or chain arrays goes
+// through one of these so it can be undone
+template <int N>
+void GoPositionT<N>::SetBoard(int point, Stone stone)
+{
+    if (undoEnabled)
+        Journal(JOURNAL_BOARD, point, board[point]);
+    board[point] = stone;
+    if (patternsEnabled)
+        UpdateNeighbourCodes(point, stone);
+}
+
+template <int N>
+void GoPositionT<N>::SetChainHead(int point, int head)
+{
+    if (undoEnabled)
+        Journal(JOURNAL_CHAIN_HEAD, point, chainHead[point]);
+    chainHead[point] = (short)head;
+}
+
+template <int N>
+void GoPositionT<N>::SetNextStone(int point, int next)
+{
+    if (undoEnabled)
+        Journal(JOURNAL_NEXT_STONE, point, nextStone[point]);
+    nextStone[point] = (short)next;
+}
+
+// A chain record is journaled once per move, however often it changes
+template <int N>
+typename GoPositionT<N>::Chain& GoPositionT<N>::ChainForWrite(int head)
+{
+    if (undoEnabled && chainSaved[head] != frameSerial)
+    {
+        chainSaved[head] = frameSerial;
+        JournalEntry entry;
+        entry.field = JOURNAL_CHAIN;
+        entry.point = (short)head;
+        entry.value = chains[head];
+        journal.push_back(entry);
+    }
+    return chains[head];
+}
+
+template <int N>
+void GoPositionT<N>::Journal(int field, int point, int value)
+{
+    JournalEntry entry;
+    entry.field = (short)field;
+    entry.point = (short)point;
+    entry.value.size = value;
+    journal.push_back(entry);
+}
+
+// Function to check if a move is valid
+template <int N>
+bool GoPositionT<N>::IsValidMove(int x, int y) const
+{
+    return IsLegal(Point(x, y));
+}
+
+// A move is legal if the new stone gets a liberty of its own, joins a
+// friendly chain that keeps another liberty, or captures an enemy chain,
+// and it does not break the ko rule
+template <int N>
+bool GoPositionT<N>::IsLegal(int point) const
+{
+    GO_METRIC_TIME(TIMER_LEGALITY);
+    if (!HasLiberty(point))
+        return false;
+    if (koRule == KO_SIMPLE)
+        return true;
+
+    uint64_t next = HashAfter(point);
+    if (koRule == KO_POSITIONAL_SUPERKO && currentPlayer == BLACK)
+        next ^= ZOBRIST.whiteToMove; // White would be to move; drop the side key
+    return !history.Contains(next);
+}
+
+template <int N>
+GoMoveStatus GoPositionT<N>::CheckMove(int point) const
+{
+    if (board[point] != EMPTY)
+        return MOVE_OCCUPIED;
+    if (point == koPoint)
+        return MOVE_KO;
+    if (!HasLiberty(point))
+        return MOVE_SUICIDE;
+    return IsLegal(point) ? MOVE_LEGAL : MOVE_SUPERKO;
+}
+
+// Occupancy, suicide and simple ko test; everything but superko
+template <int N>
+bool GoPositionT<N>::HasLiberty(int point) const
+{
+    if (board[point] != EMPTY || point == koPoint)
+        return false;
+
+    for (int offset : NEIGHBOR_OFFSETS)
+    {
+        int adj = point + offset;
+        Stone stone = board[adj];
+        if (stone == EMPTY)
+            return true;
+        if (stone == OFFBOARD)
+            continue;
+
+        // The neighbouring chain is in atari exactly when its last liberty is this point
+        bool lastLiberty = InAtari(chainHead[adj]);
+        if (stone == currentPlayer ? !lastLiberty : lastLiberty)
+            return true;
+    }
+    return false;
+}
+
+// Function to list all legal moves in one sweep
+template <int N>
+void GoPositionT<N>::GenerateLegalMoves(GoMoveListT<N>& list, bool skipOwnEyes) const
+{
+    list.count = 0;
+
+    // Atari state of every chain, computed once at its head
+    bool inAtari[POINTS];
+    for (int y = 0; y < SIZE; ++y)
+    {
+        for (int x = 0; x < SIZE; ++x)
+        {
+            int point = Point(x, y);
+            if (board[point] != EMPTY && chainHead[point] == point)
+                inAtari[point] = InAtari(point);
+        }
+    }
+
+    // Superko keys are HashAfter() plus sideKey; without a capture that is
+    // quietHash plus the new stone
+    uint64_t sideKey = 0;
+    if (koRule == KO_POSITIONAL_SUPERKO && currentPlayer == BLACK)
+        sideKey = ZOBRIST.whiteToMove; // White would be to move; drop the side key
+    uint64_t quietHash = hash ^ ZOBRIST.whiteToMove ^ sideKey;
+
+    for (int y = 0; y < SIZE; ++y)
+    {
+        for (int x = 0; x < SIZE; ++x)
+        {
+            int point = Point(x, y);
+            if (board[point] != EMPTY || point == koPoint)
+                continue;
+
+            // Same test as HasLiberty, reading the cached atari flags
+            bool hasLiberty = false;
+            bool captures = false;
+            for (int offset : NEIGHBOR_OFFSETS)
+            {
+                int adj = point + offset;
+                Stone stone = board[adj];
+                if (stone == EMPTY)
+                    hasLiberty = true;
+                else if (stone == currentPlayer)
+                    hasLiberty |= !inAtari[chainHead[adj]];
+                else if (stone != OFFBOARD)
+                    captures |= inAtari[chainHead[adj]];
+            }
+            if (!hasLiberty && !captures)
+                continue;
+
+            if (skipOwnEyes && IsTrueEye(point, currentPlayer))
+                continue;
+
+            if (koRule != KO_SIMPLE)
+            {
+                uint64_t next = captures ? HashAfter(point) ^ sideKey : quietHash ^ ZobristStone(currentPlayer, point);
+                if (history.Contains(next))
+                    continue;
+            }
+            list.Add(point);
+        }
+    }
+}
+
+template <int N>
+GoBitboardT<N> GoPositionT<N>::LegalMoveMask(bool skipOwnEyes) const
+{
+    GoMoveListT<N> list;
+    GenerateLegalMoves(list, skipOwnEyes);
+
+    GoBitboardT<N> mask = GoBitboardT<N>::Empty();
+    for (int i = 0; i < list.count; ++i)
+        mask.Set(GoBitboardT<N>::Bit(PointX(list.moves[i]), PointY(list.moves[i])));
+    return mask;
+}
+
+template <int N>
+bool GoPositionT<N>::IsTrueEye(int point, Stone player) const
+{
+    if (board[point] != EMPTY)
+        return false;
+    for (int offset : NEIGHBOR_OFFSETS)
+    {
+        Stone stone = board[point + offset];
+        if (stone != player && stone != OFFBOARD)
+            return false;
+    }
+
+    // In the open one enemy diagonal is fine; on the edge none is
+    int enemyDiagonals = 0;
+    int edge = 0;
+    for (int offset : DIAGONAL_OFFSETS)
+    {
+        Stone stone = board[point + offset];
+        if (stone == OFFBOARD)
+            edge = 1;
+        else if (stone == Opponent(player))
+            enemyDiagonals += 1;
+    }
+    return enemyDiagonals + edge < 2;
+}
+
+// Hash of the position after the current player plays a legal move at
+// point, with the opponent to move. Only the chains it captures are walked.
+template <int N>
+uint64_t GoPositionT<N>::HashAfter(int point) const
+{
+    Stone opponent = Opponent(currentPlayer);
+    uint64_t next = hash ^ ZOBRIST.whiteToMove ^ ZobristStone(currentPlayer, point);
+
+    int captured[4];
+    int capturedCount = 0;
+    for (int offset : NEIGHBOR_OFFSETS)
+    {
+        int adj = point + offset;
+        if (board[adj] != opponent || !InAtari(chainHead[adj]))
+            continue;
+
+        int head = chainHead[adj];
+        bool seen = false;
+        for (int i = 0; i < capturedCount; ++i)
+            seen = seen || captured[i] == head;
+        if (seen)
+            continue;
+        captured[capturedCount++] = head;
+
+        int stone = head;
+        do
+        {
+            next ^= ZobristStone(opponent, stone);
+            stone = nextStone[stone];
+        } while (stone != head);
+    }
+    return next;
+}
+
+// Function to put the current player's stone on a legal point and
+// resolve merges and captures
+template <int N>
+void GoPositionT<N>::PlayAt(int point)
+{
+    Stone player = currentPlayer;
+    Stone opponent = Opponent(player);
+    GO_METRIC_ADD(METRIC_STONES_PLAYED, 1);
+
+    SetBoard(point, player);
+    hash ^= ZobristStone(player, point);
+    SetChainHead(point, point);
+    SetNextStone(point, point);
+    Chain& chain = ChainForWrite(point);
+    chain = Chain();
+    chain.size = 1;
+
+    for (int offset : NEIGHBOR_OFFSETS)
+    {
+        int adj = point + offset;
+        if (board[adj] == EMPTY)
+            AddLiberty(point, adj);
+        else if (board[adj] != OFFBOARD)
+            RemoveLiberty(chainHead[adj], point);
+    }
+
+    for (int offset : NEIGHBOR_OFFSETS)
+    {
+        int adj = point + offset;
+        if (board[adj] == player && chainHead[adj] != chainHead[point])
+            MergeChains(chainHead[point], chainHead[adj]);
+    }
+    if (patternsEnabled)
+        NoteAtari(chainHead[point]);
+
+    // Check all adjacent positions for opponent chains left without liberties
+    int capturedStones = 0;
+    int capturedPoint = 0;
+    for (int offset : NEIGHBOR_OFFSETS)
+    {
+        int adj = point + offset;
+        if (board[adj] == opponent && chains[chainHead[adj]].liberties == 0)
+        {
+            capturedStones += chains[chainHead[adj]].size;
+            capturedPoint = adj;
+            RemoveCapturedStones(chainHead[adj]);
+        }
+    }
+
+    // Taking a single stone with a lone stone that is left in atari sets up
+    // a ko: the opponent may not retake at once
+    int head = chainHead[point];
+    if (capturedStones == 1 && chains[head].size == 1 && chains[head].liberties == 1)
+        koPoint = capturedPoint;
+    else
+        koPoint = 0;
+}
+
+template <int N>
+void GoPositionT<N>::AddLiberty(int head, int point)
+{
+    if (patternsEnabled)
+        NoteAtari(head);
+    Chain& chain = ChainForWrite(head);
+    chain.liberties += 1;
+    chain.libertySum += point;
+    chain.libertySumSq += point * point;
+}
+
+template <int N>
+void GoPositionT<N>::RemoveLiberty(int head, int point)
+{
+    Chain& chain = ChainForWrite(head);
+    chain.liberties -= 1;
+    chain.libertySum -= point;
+    chain.libertySumSq -= point * point;
+    if (patternsEnabled)
+        NoteAtari(head);
+}
+
+// A chain is in atari when all its pseudo-liberties are the same point,
+// i.e. when n * sum(p^2) == sum(p)^2
+template <int N>
+bool GoPositionT<N>::InAtari(int head) const
+{
+    const Chain& chain = chains[head];
+    return chain.liberties > 0 &&
+        (long long)chain.liberties * chain.libertySumSq == (long long)chain.libertySum * chain.libertySum;
+}
+
+// The single liberty of a chain in atari
+template <int N>
+int GoPositionT<N>::AtariLiberty(int head) const
+{
+    return chains[head].libertySum / chains[head].liberties;
+}
+
+// Function to join two chains; the smaller one is relabelled
+template <int N>
+void GoPositionT<N>::MergeChains(int head, int other)
+{
+    if (chains[head].size < chains[other].size)
+    {
+        int swap = head;
+        head = other;
+        other = swap;
+    }
+    GO_METRIC_ADD(METRIC_MERGES, 1);
+    GO_METRIC_ADD(METRIC_MERGED_STONES, chains[other].size);
+
+    int stone = other;
+    do
+    {
+        SetChainHead(stone, head);
+        stone = nextStone[stone];
+    } while (stone != other);
+
+    int next = nextStone[head];
+    SetNextStone(head, nextStone[other]);
+    SetNextStone(other, next);
+
+    Chain& chain = ChainForWrite(head);
+    chain.size += chains[other].size;
+    chain.liberties += chains[other].liberties;
+    chain.libertySum += chains[other].libertySum;
+    chain.libertySumSq += chains[other].libertySumSq;
+}
+
+// Function to remove a captured chain
+template <int N>
+void GoPositionT<N>::RemoveCapturedStones(int head)
+{
+    Stone player = board[head];
+    GO_METRIC_ADD(METRIC_CAPTURES, 1);
+    GO_METRIC_ADD(METRIC_CAPTURED_STONES, chains[head].size);
+
+    int stone = head;
+    do
+    {
+        SetBoard(stone, EMPTY);
+        hash ^= ZobristStone(player, stone);
+        stone = nextStone[stone];
+    } while (stone != head);
+
+    // Every stone next to a removed one gains a liberty
+    do
+    {
+        for (int offset : NEIGHBOR_OFFSETS)
+        {
+            int adj = stone + offset;
+            if (board[adj] == BLACK || board[adj] == WHITE)
+                AddLiberty(chainHead[adj], stone);
+        }
+        stone = nextStone[stone];
+    } while (stone != head);
+
+    // Update score
+    if (player == BLACK)
+        whiteScore += chains[head].size;
+    else
+        blackScore += chains[head].size;
+}
+
+// Function to count liberties of the group at (x, y)
+template <int N>
+int GoPositionT<N>::CountLiberties(int x, int y) const
+{
+    int head = Point(x, y);
+    if (board[head] != BLACK && board[head] != WHITE)
+        return 0;
+
+    bool counted[POINTS] = { false };
+    int liberties = 0;
+    int stone = head;
+    GO_METRIC_ADD(METRIC_LIBERTY_COUNTS, 1);
+    GO_METRIC_ADD(METRIC_LIBERTY_STONES, chains[chainHead[head]].size);
+    do
+    {
+        for (int offset : NEIGHBOR_OFFSETS)
+        {
+            int adj = stone + offset;
+            if (board[adj] == EMPTY && !counted[adj])
+            {
+                counted[adj] = true;
+                liberties += 1;
+            }
+        }
+        stone = nextStone[stone];
+    } while (stone != head);
+    return liberties;
+}
+
+// Function to list the first max distinct liberties of a chain; a short
+// list needs no marks, so this suits readers asking for two or three
+template <int N>
+int GoPositionT<N>::ChainLibertyPoints(int point, int* liberties, int max) const
+{
+    int count = 0;
+    int stone = point;
+    do
+    {
+        for (int offset : NEIGHBOR_OFFSETS)
+        {
+            int adj = stone + offset;
+            if (board[adj] != EMPTY)
+                continue;
+            int i = 0;
+            while (i < count && liberties[i] != adj)
+                i += 1;
+            if (i < count)
+                continue;
+            liberties[count++] = adj;
+            if (count == max)
+                return count;
+        }
+        stone = nextStone[stone];
+    } while (stone != point);
+    return count;
+}
+
+// Function to count the liberties of all chains at once. Each chain is
+// walked from its head, marking its liberties with the head point so none
+// is counted twice; the stones then take the count kept at their head.
+template <int N>
+void GoPositionT<N>::ChainLiberties(short* liberties) const
+{
+    short marked[POINTS];
+    for (int point = 0; point < POINTS; ++point)
+    {
+        liberties[point] = 0;
+        marked[point] = 0;
+    }
+
+    for (int point = 0; point < POINTS; ++point)
+    {
+        if ((board[point] != BLACK && board[point] != WHITE) || chainHead[point] != point)
+            continue;
+        int count = 0;
+        int stone = point;
+        do
+        {
+            for (int offset : NEIGHBOR_OFFSETS)
+            {
+                int adj = stone + offset;
+                if (board[adj] == EMPTY && marked[adj] != point)
+                {
+                    marked[adj] = (short)point;
+                    count += 1;
+                }
+            }
+            stone = nextStone[stone];
+        } while (stone != point);
+        liberties[point] = (short)count;
+    }
+
+    for (int point = 0; point < POINTS; ++point)
+    {
+        if (board[point] == BLACK || board[point] == WHITE)
+            liberties[point] = liberties[chainHead[point]];
+    }
+}
+
+template <int N>
+void GoPositionT<N>::SetPatternsEnabled(bool enabled)
+{
+    patternsEnabled = enabled;
+    if (enabled)
+        ComputeNeighbourCodes();
+}
+
+template <int N>
+int GoPositionT<N>::PatternCode(int point) const
+{
+    int code = neighbourCodes[point];
+    for (int i = 0; i < 4; ++i)
+    {
+        int color = (code >> (2 * i)) & 3;
+        if ((color == BLACK || color == WHITE) && InAtari(chainHead[point + NEIGHBOR_OFFSETS[i]]))
+            code |= 1 << (PATTERN_ATARI_SHIFT + i);
+    }
+    return code;
+}
+
+// Function to work out the colors around every point from the board; every
+// pattern counts as changed
+template <int N>
+void GoPositionT<N>::ComputeNeighbourCodes()
+{
+    for (int point = 0; point < POINTS; ++point)
+    {
+        int code = 0;
+        if (board[point] != OFFBOARD)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                code |= board[point + NEIGHBOR_OFFSETS[i]] << (2 * i);
+                code |= board[point + DIAGONAL_OFFSETS[i]] << (2 * i + 8);
+            }
+        }
+        neighbourCodes[point] = (uint16_t)code;
+    }
+    patternChangeCount = 0;
+    patternOverflow = true;
+}
+
+// Function to write a point's new stone into the codes of the eight points
+// around it, each of which sees it from the opposite side
+template <int N>
+void GoPositionT<N>::UpdateNeighbourCodes(int point, Stone stone)
+{
+    static const int OPPOSITE[8] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+    for (int i = 0; i < 8; ++i)
+    {
+        int adj = point + (i < 4 ? NEIGHBOR_OFFSETS[i] : DIAGONAL_OFFSETS[i - 4]);
+        int shift = 2 * OPPOSITE[i];
+        neighbourCodes[adj] = (uint16_t)((neighbourCodes[adj] & ~(3 << shift)) | (stone << shift));
+    }
+    NotePatternChange(point);
+}
+
+template <int N>
+void GoPositionT<N>::NotePatternChange(int point)
+{
+    if (patternChangeCount < POINTS)
+        patternChanges[patternChangeCount++] = (short)point;
+    else
+        patternOverflow = true;
+}
+
+// Function to list the liberty of a chain in atari, whose neighbours' atari
+// flags are about to change or just have
+template <int N>
+void GoPositionT<N>::NoteAtari(int head)
+{
+    if (InAtari(head))
+        NotePatternChange(AtariLiberty(head));
+}
+
+template class GoPositionT<9>;
+template class GoPositionT<13>;
+template class GoPositionT<19>;
@@ -0,0 +1,301 @@
+// GoPosition.h : Headless Go rules engine.
+//
+// A GoPosition holds one complete game state (board, player to move,
+// capture counts and pass count). It has value semantics and no global
+// state, so any number of positions can live in one process and be played
+// from different threads, as long as each position is used by one thread
+// at a time.
+//
+// Stones are grouped into chains that are kept up to date as moves are
+// played: every stone knows the head of its chain, the stones of a chain
+// form a circular list, and each chain carries its pseudo-liberty count
+// (one per stone/empty-point contact). Together with the sum and sum of
+// squares of those liberty points this answers "is this chain captured"
+// and "is this chain in atari" in constant time, without flood-fills.
+//
+// Optionally (SetPatternsEnabled) every point also carries the code of its
+// 3x3 neighbourhood, rewritten for the eight neighbours of each point
+// whose stone changes; with the atari flags read off the chain records
+// that gives each point's pattern without looking at the board. The
+// points whose pattern may have changed are listed for the playout policy
+// (see GoPlayout.h) to pick up.
+//
+// The position also keeps its Zobrist hash up to date and, under the
+// superko rules, a history of the hashes of all earlier positions, so
+// repetitions are rejected with one hash lookup.
+//
+// Every change to the board and chain arrays is written to an undo
+// journal, and each move, pass or turn skip opens a frame in it. Undo()
+// replays the last frame backwards, so taking a move back costs as much
+// as the move itself did. Search code plays and takes back moves on one
+// position instead of copying it.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GoBitboard.h"
+#include "GoTypes.h"
+#include "GoZobrist.h"
+
+template <int N>
+class GoPositionT : public GoGeometry<N>
+{
+public:
+    using GoGeometry<N>::SIZE;
+    using GoGeometry<N>::STRIDE;
+    using GoGeometry<N>::POINTS;
+    using GoGeometry<N>::NEIGHBOR_OFFSETS;
+    using GoGeometry<N>::DIAGONAL_OFFSETS;
+    using GoGeometry<N>::Point;
+    using GoGeometry<N>::PointX;
+    using GoGeometry<N>::PointY;
+
+    explicit GoPositionT(KoRule rule = KO_POSITIONAL_SUPERKO);
+
+    // Clear the board, scores, pass count and history; Black to move
+    void Reset();
+
+    // Switch repetition rule; resets the position
+    void SetKoRule(KoRule rule);
+    KoRule GetKoRule() const { return koRule; }
+
+    // Stone at column x, row y
+    Stone At(int x, int y) const { return board[Point(x, y)]; }
+
+    // Stone on a point index, OFFBOARD on the border
+    Stone AtPoint(int point) const { return board[point]; }
+
+    Stone CurrentPlayer() const { return currentPlayer; }
+
+    // Number of stones captured by each player
+    int BlackScore() const { return blackScore; }
+    int WhiteScore() const { return whiteScore; }
+
+    // Zobrist hash of the stones and the player to move
+    uint64_t Hash() const { return hash; }
+
+    // Zobrist hash of the stones alone
+    uint64_t PositionHash() const { return currentPlayer == WHITE ? hash ^ ZOBRIST.whiteToMove : hash; }
+
+    // Point the current player may not play because it would retake a
+    // single-stone ko at once, or 0 when there is none
+    int KoPoint() const { return koPoint; }
+
+    int ConsecutivePasses() const { return consecutivePasses; }
+    bool IsGameOver() const { return consecutivePasses >= 2; }
+
+    // Clear the pass count, so that play can go on after both players
+    // passed, as when the game is resumed to settle which stones are dead
+    void ResumePlay() { consecutivePasses = 0; }
+
+    // Check whether the current player may play at (x, y)
+    bool IsValidMove(int x, int y) const;
+
+    // Play the current player's stone at (x, y), capture and hand the turn
+    // over. Returns false and leaves the position unchanged if the move is
+    // illegal.
+    bool PlaceStone(int x, int y);
+
+    // Check and play a move (a point or PASS_MOVE) in a single pass.
+    // Returns false and leaves the position unchanged if it is illegal.
+    bool TryPlay(int move);
+
+    // Take back the last move, pass or turn skip; false if there is none
+    bool Undo();
+    bool CanUndo() const { return !frames.empty(); }
+
+    // Turn the undo journal off (and drop it) for positions that are only
+    // ever played forward, such as random playouts
+    void SetUndoEnabled(bool enabled);
+
+    // Take over the game state of other (board, chains, player, scores and
+    // superko history) but not its undo journal, which is dropped. Meant
+    // for scratch positions that are reused for many playouts.
+    void CopyPosition(const GoPositionT& other);
+
+    // Make room in the superko history for this many more moves
+    void ReserveHistory(int moves) { history.Reserve(moves); }
+
+    // Pass the turn to the other player
+    void Pass();
+
+    // Hand the turn over without playing or counting a pass
+    void TogglePlayer();
+
+    // Check a move given as a point index
+    bool IsLegalMove(int point) const { return IsLegal(point); }
+
+    // Check an on-board point and say why it cannot be played, if it cannot
+    GoMoveStatus CheckMove(int point) const;
+
+    // Every legal point for the current player, in one sweep over the
+    // board. The atari state of each chain is worked out once and shared
+    // by all of its liberties. With skipOwnEyes, points that fill one of
+    // the current player's true eyes are left out. Passing is not listed.
+    void GenerateLegalMoves(GoMoveListT<N>& list, bool skipOwnEyes = false) const;
+
+    // The same set as a bitmask, in GoBitboard bit numbering
+    GoBitboardT<N> LegalMoveMask(bool skipOwnEyes = false) const;
+
+    // An empty point whose neighbours are all the player's stones and
+    // which the opponent cannot break open through its diagonals
+    bool IsTrueEye(int point, Stone player) const;
+
+    // Count the distinct liberties of the group containing (x, y); walks
+    // the group's stones
+    int CountLiberties(int x, int y) const;
+
+    // Distinct liberties of the chain on every point, 0 on empty points
+    // and the border, in one sweep over the board
+    void ChainLiberties(short* liberties) const;
+
+    // Constant-time chain queries for the group containing (x, y)
+    int GroupSize(int x, int y) const { return chains[chainHead[Point(x, y)]].size; }
+    bool IsInAtari(int x, int y) const { return InAtari(chainHead[Point(x, y)]); }
+
+    // Chains by point index, for readers that walk them (see GoTactics.h):
+    // the head point shared by a chain's stones, the next stone of its
+    // circular list, and whether it is in atari
+    int ChainHead(int point) const { return chainHead[point]; }
+    int NextStone(int point) const { return nextStone[point]; }
+    bool ChainInAtari(int point) const { return InAtari(chainHead[point]); }
+
+    // Distinct liberties of the chain on a point, stopping once max are
+    // found; writes them to liberties and returns how many there are
+    int ChainLibertyPoints(int point, int* liberties, int max) const;
+
+    // Keep 3x3 pattern codes up to date; off by default. Turning it on
+    // works out every code once.
+    void SetPatternsEnabled(bool enabled);
+    bool PatternsEnabled() const { return patternsEnabled; }
+
+    // Pattern code of a point (see PATTERN_ATARI_SHIFT): the colors around
+    // it, kept incrementally, and the atari flags of its neighbours' chains
+    int PatternCode(int point) const;
+
+    // Points around which patterns changed since the last
+    // ClearPatternChanges: points whose stone changed and liberties of
+    // chains that went into or out of atari. Of the empty points, only the
+    // listed ones and their eight neighbours can have new codes. If more
+    // changed than the list holds it overflows, and every pattern counts
+    // as changed.
+    int PatternChangeCount() const { return patternChangeCount; }
+    int PatternChange(int i) const { return patternChanges[i]; }
+    bool PatternChangesOverflowed() const { return patternOverflow; }
+    void ClearPatternChanges()
+    {
+        patternChangeCount = 0;
+        patternOverflow = false;
+    }
+
+private:
+    // Per-chain data, stored at the chain's head point
+    struct Chain
+    {
+        int size;           // number of stones
+        int liberties;      // pseudo-liberties
+        int libertySum;     // sum of the pseudo-liberty points
+        int libertySumSq;   // sum of their squares
+    };
+
+    // Undo journal entry: the old value of one board, chainHead or
+    // nextStone element (kept in value.size) or of one chain record
+    enum JournalField { JOURNAL_BOARD, JOURNAL_CHAIN_HEAD, JOURNAL_NEXT_STONE, JOURNAL_CHAIN };
+    struct JournalEntry
+    {
+        short field;
+        short point;
+        Chain value;
+    };
+
+    // Scalar state saved when a move starts
+    struct UndoFrame
+    {
+        int journalSize;
+        uint64_t hash;
+        int koPoint;
+        Stone player;
+        int blackScore;
+        int whiteScore;
+        int consecutivePasses;
+        bool recorded;      // the move added its position to the history
+    };
+
+    bool IsLegal(int point) const;
+    bool HasLiberty(int point) const;
+    uint64_t HashAfter(int point) const;
+    uint64_t SuperkoKey() const;
+    void SwitchSides();
+    void RecordPosition();
+    void PushFrame();
+    void SetBoard(int point, Stone stone);
+    void SetChainHead(int point, int head);
+    void SetNextStone(int point, int next);
+    Chain& ChainForWrite(int head);
+    void Journal(int field, int point, int value);
+    void PlayAt(int point);
+    void AddLiberty(int head, int point);
+    void RemoveLiberty(int head, int point);
+    bool InAtari(int head) const;
+    int AtariLiberty(int head) const;
+    void MergeChains(int head, int other);
+    void RemoveCapturedStones(int head);
+    void ComputeNeighbourCodes();
+    void UpdateNeighbourCodes(int point, Stone stone);
+    void NotePatternChange(int point);
+    void NoteAtari(int head);
+
+    // Board with border, indexed by point
+    Stone board[POINTS];
+
+    // Head point of the chain each stone belongs to
+    short chainHead[POINTS];
+
+    // Next stone of the same chain (circular list)
+    short nextStone[POINTS];
+
+    // Chain data, valid at head points only
+    Chain chains[POINTS];
+
+    // Current player
+    Stone currentPlayer;
+
+    // Zobrist hash, including the side to move
+    uint64_t hash;
+
+    // Simple ko point for the current player, 0 if none
+    int koPoint;
+
+    // Repetition rule and the hashes of earlier positions under superko
+    KoRule koRule;
+    GoHashHistory history;
+
+    // Player scores
+    int blackScore;
+    int whiteScore;
+
+    // Counter to track consecutive passes
+    int consecutivePasses;
+
+    // Undo journal and one frame per move since the last Reset
+    bool undoEnabled;
+    std::vector<JournalEntry> journal;
+    std::vector<UndoFrame> frames;
+
+    // Serial number of the open frame, and the frame each chain record
+    // was last journaled in
+    unsigned frameSerial;
+    unsigned chainSaved[POINTS];
+
+    // Colors around each point, in the low 16 bits of a pattern code, and
+    // the points whose patterns changed; only while patterns are enabled
+    bool patternsEnabled;
+    uint16_t neighbourCodes[POINTS];
+    short patternChanges[POINTS];
+    int patternChangeCount;
+    bool patternOverflow;
+};
+
+typedef GoPositionT<19> GoPosition;
@@ -0,0 +1,43 @@
+// GoRandom.h : Small, fast pseudo-random generator for playouts.
+//
+// xorshift64* with a SplitMix64-scrambled seed. The state is one word and
+// a step is three shifts and a multiply, so every thread keeps its own
+// generator instead of sharing a locked one. The same seed always gives
+// the same sequence, which makes playouts and searches reproducible.
+//
+#pragma once
+
+#include <cstdint>
+
+class GoRandom
+{
+public:
+    explicit GoRandom(uint64_t seed = 1) { Seed(seed); }
+
+    // Restart the sequence; nearby seeds give unrelated sequences
+    void Seed(uint64_t seed)
+    {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1; // never zero
+    }
+
+    uint64_t Next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Uniform integer in [0, n) for n > 0, by multiplying instead of
+    // dividing
+    int Below(int n)
+    {
+        return (int)(((Next() >> 32) * (uint64_t)n) >> 32);
+    }
+
+private:
+    uint64_t state;
+};
@@ -0,0 +1,195 @@
+// GoRenderBench.cpp : Board renderer benchmark and image check.
+//
+// Usage: GoRenderBench [-size n] [-width w] [-height h] [-moves k] [-seed s] [-ppm file] [-diff file]
+//
+// Plays k random legal moves (300 by default) on an n x n board (19 by
+// default) laid out in a w x h client area (984 x 761, the desktop
+// client's default window) the way the client lays it out. After every
+// move it times bringing the frame up to date two ways: redrawing the
+// whole frame, which is what every repaint used to do, and redrawing only
+// the cells that changed. It reports the time per frame of each, the
+// share of the frame the incremental update has to repaint, and the
+// number of pixels where the two frames differ, which must be 0.
+//
+// -ppm writes the last frame as a binary PPM image; -diff compares it with
+// an earlier one and fails if any pixel differs, so a change to the
+// renderer can be checked against a reference image.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "GoGame.h"
+#include "GoRandom.h"
+#include "GoRenderer.h"
+
+// Side panel width and padding of the desktop client's layout
+static const int SIDE_PANEL_WIDTH = 250;
+static const int BOARD_PADDING = 40;
+static const int BOARD_OFFSET = 20;
+
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to play a random legal move, or pass if a few tries find none
+static void PlayRandomMove(GoGame& game, GoRandom& random)
+{
+    int size = game.Size();
+    for (int tries = 0; tries < 4 * size * size; ++tries)
+    {
+        int x = random.Below(size);
+        int y = random.Below(size);
+        if (game.At(x, y) == EMPTY && game.PlaceStone(x, y))
+            return;
+    }
+    game.Pass();
+}
+
+static bool WritePpm(const char* path, const GoBoardRenderer& renderer)
+{
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+    std::fprintf(file, "P6\n%d %d\n255\n", renderer.Width(), renderer.Height());
+    std::vector<unsigned char> row((std::size_t)renderer.Width() * 3);
+    for (int y = 0; y < renderer.Height(); ++y)
+    {
+        const uint32_t* pixels = renderer.Pixels() + (std::size_t)y * renderer.Width();
+        for (int x = 0; x < renderer.Width(); ++x)
+        {
+            row[3 * x] = (unsigned char)(pixels[x] >> 16);
+            row[3 * x + 1] = (unsigned char)(pixels[x] >> 8);
+            row[3 * x + 2] = (unsigned char)pixels[x];
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    return std::fclose(file) == 0;
+}
+
+// Function to count the pixels of the frame that differ from a PPM image;
+// -1 if the image cannot be read or has other dimensions
+static long long DiffPpm(const char* path, const GoBoardRenderer& renderer)
+{
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr)
+        return -1;
+    int width = 0, height = 0, maximum = 0;
+    bool valid = std::fscanf(file, "P6 %d %d %d", &width, &height, &maximum) == 3 && std::fgetc(file) != EOF &&
+        width == renderer.Width() && height == renderer.Height() && maximum == 255;
+    long long differing = 0;
+    std::vector<unsigned char> row((std::size_t)width * 3);
+    for (int y = 0; valid && y < height; ++y)
+    {
+        valid = std::fread(row.data(), 1, row.size(), file) == row.size();
+        const uint32_t* pixels = renderer.Pixels() + (std::size_t)y * width;
+        for (int x = 0; valid && x < width; ++x)
+        {
+            uint32_t color = (uint32_t)row[3 * x] << 16 | (uint32_t)row[3 * x + 1] << 8 | row[3 * x + 2];
+            differing += color != pixels[x];
+        }
+    }
+    std::fclose(file);
+    return valid ? differing : -1;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = 19;
+    int width = 984;
+    int height = 761;
+    int moveCount = 300;
+    uint64_t seed = 1;
+    const char* ppmPath = nullptr;
+    const char* diffPath = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-size") == 0)
+            size = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-width") == 0)
+            width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-height") == 0)
+            height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-moves") == 0)
+            moveCount = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-seed") == 0)
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "-ppm") == 0)
+            ppmPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "-diff") == 0)
+            diffPath = argv[i + 1];
+    }
+    std::unique_ptr<GoGame> game = CreateGoGame(size);
+    int side = std::min(width - SIDE_PANEL_WIDTH - BOARD_PADDING, height - BOARD_PADDING);
+    if (!game || side < size || moveCount < 1)
+    {
+        std::fprintf(stderr, "usage: GoRenderBench [-size 9|13|19] [-width w] [-height h] [-moves k] [-seed s] "
+            "[-ppm file] [-diff file]\n");
+        return 2;
+    }
+    int cellSize = side / size;
+
+    GoBoardRenderer incremental;
+    GoBoardRenderer full;
+    incremental.SetLayout(*game, width, height, cellSize, BOARD_OFFSET);
+    incremental.TakeDirtyRect();
+    full.SetLayout(*game, width, height, cellSize, BOARD_OFFSET);
+
+    GoRandom random(seed);
+    double fullSeconds = 0;
+    double incrementalSeconds = 0;
+    long long dirtyPixels = 0;
+    long long cellsRedrawn = 0;
+    long long differing = 0;
+    std::size_t pixelCount = (std::size_t)width * height;
+    for (int move = 0; move < moveCount; ++move)
+    {
+        PlayRandomMove(*game, random);
+
+        auto start = std::chrono::steady_clock::now();
+        full.Redraw(*game);
+        fullSeconds += SecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        incremental.Update(*game);
+        GoRenderRect dirty = incremental.TakeDirtyRect();
+        incrementalSeconds += SecondsSince(start);
+        dirtyPixels += dirty.Area();
+        cellsRedrawn += incremental.CellsRedrawn();
+
+        for (std::size_t i = 0; i < pixelCount; ++i)
+            differing += incremental.Pixels()[i] != full.Pixels()[i];
+    }
+
+    std::printf("%dx%d board, %dx%d frame, %d px cells, %d moves\n", size, size, width, height, cellSize, moveCount);
+    std::printf("%-24s %10.1f us\n", "full redraw per frame", 1e6 * fullSeconds / moveCount);
+    std::printf("%-24s %10.1f us\n", "incremental per frame", 1e6 * incrementalSeconds / moveCount);
+    std::printf("%-24s %10.1fx\n", "speedup", fullSeconds / incrementalSeconds);
+    std::printf("%-24s %10.2f\n", "cells redrawn per move", (double)cellsRedrawn / moveCount);
+    std::printf("%-24s %10.2f%%\n", "frame repainted", 100.0 * dirtyPixels / ((double)pixelCount * moveCount));
+    std::printf("%-24s %10lld\n", "pixels differing", differing);
+
+    if (ppmPath && !WritePpm(ppmPath, incremental))
+    {
+        std::fprintf(stderr, "cannot write %s\n", ppmPath);
+        return 1;
+    }
+    if (diffPath)
+    {
+        long long changed = DiffPpm(diffPath, incremental);
+        if (changed < 0)
+        {
+            std::fprintf(stderr, "cannot compare with %s\n", diffPath);
+            return 1;
+        }
+        std::printf("%-24s %10lld\n", "pixels differing from reference", changed);
+        if (changed != 0)
+            return 1;
+    }
+    return differing == 0 ? 0 : 1;
+}
@@ -0,0 +1,303 @@
+// GoRenderer.cpp : Implements the board renderer.
+//
+#include "GoRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Colors, 0x00RRGGBB
+static const uint32_t WOOD_COLOR = 0xF0D9B5;
+static const uint32_t LINE_COLOR = 0x000000;
+static const uint32_t BLACK_STONE_COLOR = 0x000000;
+static const uint32_t WHITE_STONE_COLOR = 0xFFFFFF;
+
+static const int STAR_POINT_RADIUS = 4;
+
+// Opacity each shade level adds to the square over an empty point
+static const int SHADE_ALPHA_STEP = 36;
+
+// Space left between neighbouring stones, on each side
+static const int STONE_MARGIN = 4;
+
+// Sub-pixel samples per pixel along each axis, for the edges of discs
+static const int DISC_SAMPLES = 4;
+
+// Function to make a disc of the given radius with a one-pixel edge, as a
+// square sprite with premultiplied colors and coverage in the alpha byte.
+// Like a GDI Ellipse with a bounding box of (-radius, -radius) to (radius,
+// radius), it covers pixels -radius to radius - 1 on each axis.
+static std::vector<uint32_t> MakeDisc(int radius, uint32_t fill, uint32_t edge)
+{
+    int size = 2 * radius;
+    std::vector<uint32_t> sprite((std::size_t)size * size);
+    double inner = radius - 1.0;
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            int red = 0, green = 0, blue = 0, covered = 0;
+            for (int sy = 0; sy < DISC_SAMPLES; ++sy)
+            {
+                for (int sx = 0; sx < DISC_SAMPLES; ++sx)
+                {
+                    double dx = x + (sx + 0.5) / DISC_SAMPLES - radius;
+                    double dy = y + (sy + 0.5) / DISC_SAMPLES - radius;
+                    double distance = std::sqrt(dx * dx + dy * dy);
+                    if (distance > radius)
+                        continue;
+                    uint32_t color = distance <= inner ? fill : edge;
+                    red += (color >> 16) & 0xFF;
+                    green += (color >> 8) & 0xFF;
+                    blue += color & 0xFF;
+                    covered += 1;
+                }
+            }
+            const int samples = DISC_SAMPLES * DISC_SAMPLES;
+            uint32_t alpha = (uint32_t)((covered * 255 + samples / 2) / samples);
+            sprite[(std::size_t)y * size + x] = alpha << 24 | (uint32_t)((red + samples / 2) / samples) << 16 |
+                (uint32_t)((green + samples / 2) / samples) << 8 | (uint32_t)((blue + samples / 2) / samples);
+        }
+    }
+    return sprite;
+}
+
+// Function to make a sprite half as opaque; premultiplied, so every byte
+// halves
+static std::vector<uint32_t> Fade(const std::vector<uint32_t>& sprite)
+{
+    std::vector<uint32_t> faded(sprite.size());
+    for (std::size_t i = 0; i < sprite.size(); ++i)
+        faded[i] = (sprite[i] >> 1) & 0x7F7F7F7F;
+    return faded;
+}
+
+// Function to lay a premultiplied pixel over an opaque one
+static inline uint32_t Blend(uint32_t under, uint32_t over)
+{
+    uint32_t alpha = over >> 24;
+    if (alpha == 255)
+        return over & 0xFFFFFF;
+    if (alpha == 0)
+        return under;
+    uint32_t keep = 255 - alpha;
+    uint32_t red = ((over >> 16) & 0xFF) + (((under >> 16) & 0xFF) * keep + 127) / 255;
+    uint32_t green = ((over >> 8) & 0xFF) + (((under >> 8) & 0xFF) * keep + 127) / 255;
+    uint32_t blue = (over & 0xFF) + ((under & 0xFF) * keep + 127) / 255;
+    return red << 16 | green << 8 | blue;
+}
+
+// Function to blend a square sprite whose top left corner is at (left,
+// top) into a buffer, inside the clip rectangle only
+static void BlendSprite(std::vector<uint32_t>& pixels, int width, const GoRenderRect& clip,
+    const std::vector<uint32_t>& sprite, int size, int left, int top)
+{
+    int x0 = std::max(left, clip.left), x1 = std::min(left + size, clip.right);
+    int y0 = std::max(top, clip.top), y1 = std::min(top + size, clip.bottom);
+    for (int y = y0; y < y1; ++y)
+    {
+        uint32_t* row = &pixels[(std::size_t)y * width];
+        const uint32_t* source = &sprite[(std::size_t)(y - top) * size];
+        for (int x = x0; x < x1; ++x)
+            row[x] = Blend(row[x], source[x - left]);
+    }
+}
+
+GoBoardRenderer::GoBoardRenderer()
+    : width(0), height(0), boardSize(0), cellSize(0), offset(0), stoneRadius(0), cellsRedrawn(0)
+{
+}
+
+void GoBoardRenderer::SetLayout(const GoGame& game, int width, int height, int cellSize, int offset)
+{
+    this->width = std::max(width, 0);
+    this->height = std::max(height, 0);
+    this->boardSize = game.Size();
+    this->cellSize = std::max(cellSize, 1);
+    this->offset = offset;
+    stoneRadius = std::max(this->cellSize / 2 - STONE_MARGIN, 1);
+    sprites[0] = MakeDisc(stoneRadius, BLACK_STONE_COLOR, LINE_COLOR);
+    sprites[1] = MakeDisc(stoneRadius, WHITE_STONE_COLOR, LINE_COLOR);
+    fadedSprites[0] = Fade(sprites[0]);
+    fadedSprites[1] = Fade(sprites[1]);
+    Redraw(game);
+}
+
+void GoBoardRenderer::Redraw(const GoGame& game)
+{
+    DrawBackground(game);
+    frame = background;
+    drawn.assign((std::size_t)boardSize * boardSize, EMPTY);
+    drawnDead.assign((std::size_t)boardSize * boardSize, 0);
+    drawnShade.assign((std::size_t)boardSize * boardSize, 0);
+    Update(game);
+    dirty = GoRenderRect();
+    AddDirty(0, 0, width, height);
+}
+
+// Function to draw the wood, grid lines and star points into the
+// background layer
+void GoBoardRenderer::DrawBackground(const GoGame& game)
+{
+    background.assign((std::size_t)width * height, WOOD_COLOR);
+    if (background.empty())
+        return;
+
+    // Lines run from the first intersection up to, not including, the
+    // last, as GDI draws them
+    int last = offset + (boardSize - 1) * cellSize;
+    int x0 = std::min(std::max(offset, 0), width), x1 = std::max(std::min(last, width), x0);
+    int y0 = std::min(std::max(offset, 0), height), y1 = std::max(std::min(last, height), y0);
+    for (int i = 0; i < boardSize; ++i)
+    {
+        int line = offset + i * cellSize;
+        if (line >= 0 && line < height)
+        {
+            uint32_t* row = &background[(std::size_t)line * width];
+            std::fill(row + x0, row + x1, LINE_COLOR);
+        }
+        if (line >= 0 && line < width)
+        {
+            for (int y = y0; y < y1; ++y)
+                background[(std::size_t)y * width + line] = LINE_COLOR;
+        }
+    }
+
+    std::vector<uint32_t> star = MakeDisc(STAR_POINT_RADIUS, LINE_COLOR, LINE_COLOR);
+    GoRenderRect all;
+    all.right = width;
+    all.bottom = height;
+    for (int i = 0; i < game.HoshiCount(); ++i)
+    {
+        int point = game.HoshiPoint(i);
+        int x = offset + game.PointX(point) * cellSize;
+        int y = offset + game.PointY(point) * cellSize;
+        BlendSprite(background, width, all, star, 2 * STAR_POINT_RADIUS, x - STAR_POINT_RADIUS,
+            y - STAR_POINT_RADIUS);
+    }
+}
+
+// Function to redraw the cell around intersection (x, y): background
+// first, then the stone if there is one, faded and marked if it is dead,
+// or the shade of an empty point
+void GoBoardRenderer::DrawCell(int x, int y, Stone stone, bool dead, int shade)
+{
+    int centerX = offset + x * cellSize;
+    int centerY = offset + y * cellSize;
+    GoRenderRect cell;
+    cell.left = std::max(centerX - cellSize / 2, 0);
+    cell.top = std::max(centerY - cellSize / 2, 0);
+    cell.right = std::min(centerX - cellSize / 2 + cellSize, width);
+    cell.bottom = std::min(centerY - cellSize / 2 + cellSize, height);
+    if (cell.IsEmpty())
+        return;
+
+    for (int row = cell.top; row < cell.bottom; ++row)
+    {
+        std::size_t start = (std::size_t)row * width;
+        std::copy(background.begin() + start + cell.left, background.begin() + start + cell.right,
+            frame.begin() + start + cell.left);
+    }
+    if (stone != BLACK && stone != WHITE && shade != 0)
+    {
+        // A translucent square half a cell across in the colour the point
+        // leans to
+        int level = std::min(std::abs(shade), SHADE_LEVELS);
+        uint32_t alpha = (uint32_t)(level * SHADE_ALPHA_STEP);
+        uint32_t tint = shade > 0 ? 0 : alpha;
+        uint32_t over = alpha << 24 | tint << 16 | tint << 8 | tint;
+        int half = std::max(cellSize / 4, 1);
+        for (int row = std::max(centerY - half, cell.top); row < std::min(centerY + half, cell.bottom); ++row)
+        {
+            uint32_t* pixels = &frame[(std::size_t)row * width];
+            for (int column = std::max(centerX - half, cell.left); column < std::min(centerX + half, cell.right);
+                ++column)
+                pixels[column] = Blend(pixels[column], over);
+        }
+    }
+    if (stone == BLACK || stone == WHITE)
+    {
+        const std::vector<uint32_t>* sprite = dead ? fadedSprites : sprites;
+        BlendSprite(frame, width, cell, sprite[stone == BLACK ? 0 : 1], 2 * stoneRadius, centerX - stoneRadius,
+            centerY - stoneRadius);
+    }
+    if (dead && (stone == BLACK || stone == WHITE))
+    {
+        // A square of the captor's colour, a third of the stone across
+        int half = std::max(stoneRadius / 3, 1);
+        uint32_t color = stone == BLACK ? WHITE_STONE_COLOR : BLACK_STONE_COLOR;
+        for (int row = std::max(centerY - half, cell.top); row < std::min(centerY + half, cell.bottom); ++row)
+        {
+            std::size_t start = (std::size_t)row * width;
+            std::fill(frame.begin() + start + std::max(centerX - half, cell.left),
+                frame.begin() + start + std::min(centerX + half, cell.right), color);
+        }
+    }
+    AddDirty(cell.left, cell.top, cell.right, cell.bottom);
+    cellsRedrawn += 1;
+}
+
+void GoBoardRenderer::Update(const GoGame& game)
+{
+    cellsRedrawn = 0;
+    if (game.Size() != boardSize || frame.empty())
+        return;
+
+    // Marks and shades made for a board of another size are left out
+    std::size_t cells = (std::size_t)boardSize * boardSize;
+    bool marked = dead.size() == cells;
+    bool shaded = shading.size() == cells;
+    for (int y = 0; y < boardSize; ++y)
+    {
+        for (int x = 0; x < boardSize; ++x)
+        {
+            std::size_t cell = (std::size_t)y * boardSize + x;
+            Stone stone = game.At(x, y);
+            uint8_t mark = marked ? dead[cell] : 0;
+            int8_t shade = shaded ? shading[cell] : 0;
+            if (stone != drawn[cell] || mark != drawnDead[cell] || shade != drawnShade[cell])
+            {
+                DrawCell(x, y, stone, mark != 0, shade);
+                drawn[cell] = stone;
+                drawnDead[cell] = mark;
+                drawnShade[cell] = shade;
+            }
+        }
+    }
+}
+
+void GoBoardRenderer::SetDeadStones(const std::vector<uint8_t>& dead)
+{
+    this->dead = dead;
+}
+
+void GoBoardRenderer::SetShading(const std::vector<int8_t>& shading)
+{
+    this->shading = shading;
+}
+
+// Function to grow the dirty rectangle over another one
+void GoBoardRenderer::AddDirty(int left, int top, int right, int bottom)
+{
+    if (right <= left || bottom <= top)
+        return;
+    if (dirty.IsEmpty())
+    {
+        dirty.left = left;
+        dirty.top = top;
+        dirty.right = right;
+        dirty.bottom = bottom;
+        return;
+    }
+    dirty.left = std::min(dirty.left, left);
+    dirty.top = std::min(dirty.top, top);
+    dirty.right = std::max(dirty.right, right);
+    dirty.bottom = std::max(dirty.bottom, bottom);
+}
+
+GoRenderRect GoBoardRenderer::TakeDirtyRect()
+{
+    GoRenderRect rect = dirty;
+    dirty = GoRenderRect();
+    return rect;
+}
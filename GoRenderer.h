@@ -0,0 +1,108 @@
+// GoRenderer.h : Draws the board into a pixel buffer, redrawing only what
+// changed.
+//
+// The renderer keeps two buffers the size of the window's client area: the
+// background layer (wood, grid lines and star points), drawn once per
+// layout, and the frame shown on screen. Black and white stones are
+// anti-aliased sprites, also made once per layout. Update compares the
+// game's stones with the ones last drawn, and for every point that changed
+// (the move just played, the stones it captured, the stones an undo put
+// back) copies the point's cell back from the background and blends the
+// new stone over it. The cells redrawn add up to a dirty rectangle, which
+// is all the window has to repaint.
+//
+// Stones marked dead (see GoOwnership.h) are drawn faded, with a small
+// square of the other colour on them, and empty points can be shaded
+// toward the colour whose influence they are under (see GoInfluence.h);
+// a point counts as changed when its mark or shade does.
+//
+// Nothing here depends on the platform: pixels are 32-bit 0x00RRGGBB,
+// rows top to bottom, which is also the layout of a top-down 32-bit
+// Windows DIB, so the desktop client blits the frame as it is. The Linux
+// tools render and compare frames with the same code (see GoRenderBench).
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GoGame.h"
+
+// Rectangle of frame pixels; right and bottom are exclusive
+struct GoRenderRect
+{
+    int left = 0;
+    int top = 0;
+    int right = 0;
+    int bottom = 0;
+
+    bool IsEmpty() const { return right <= left || bottom <= top; }
+    int Area() const { return IsEmpty() ? 0 : (right - left) * (bottom - top); }
+};
+
+class GoBoardRenderer
+{
+public:
+    // Shades run from -SHADE_LEVELS, White's most, to SHADE_LEVELS
+    static constexpr int SHADE_LEVELS = 4;
+
+    GoBoardRenderer();
+
+    // Lay the board of the game out in a frame of width x height pixels,
+    // with intersections cellSize apart and the first offset pixels from
+    // the top left corner, and draw it; the whole frame becomes dirty
+    void SetLayout(const GoGame& game, int width, int height, int cellSize, int offset);
+
+    // Draw the whole frame again from scratch in the current layout, as
+    // repainting the window used to; the whole frame becomes dirty
+    void Redraw(const GoGame& game);
+
+    // Redraw the points whose stone differs from the one last drawn. A
+    // game of another size than the layout's is ignored until SetLayout.
+    void Update(const GoGame& game);
+
+    // Mark the stones to draw as dead, one entry per point row by row as in
+    // GoOwnershipMap::dead; an empty vector, or one for another board size,
+    // clears the marks. The cells whose mark changed are redrawn by the
+    // next Update.
+    void SetDeadStones(const std::vector<uint8_t>& dead);
+
+    // Shade the empty points, one entry per point row by row, positive
+    // toward Black and negative toward White; an empty vector clears the
+    // shading. Like the marks, drawn by the next Update.
+    void SetShading(const std::vector<int8_t>& shading);
+
+    // Area redrawn since the last call; empty if nothing was
+    GoRenderRect TakeDirtyRect();
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    const uint32_t* Pixels() const { return frame.data(); }
+
+    // Cells redrawn by the last Update
+    int CellsRedrawn() const { return cellsRedrawn; }
+
+private:
+    void DrawBackground(const GoGame& game);
+    void DrawCell(int x, int y, Stone stone, bool dead, int shade);
+    void AddDirty(int left, int top, int right, int bottom);
+
+    int width;
+    int height;
+    int boardSize;
+    int cellSize;
+    int offset;
+    int stoneRadius;
+
+    std::vector<uint32_t> background;
+    std::vector<uint32_t> frame;
+    std::vector<uint32_t> sprites[2];   // Black, White; premultiplied, alpha in the top byte
+    std::vector<uint32_t> fadedSprites[2]; // the same at half coverage, for dead stones
+    std::vector<Stone> drawn;           // stone last drawn at each point, by row
+    std::vector<uint8_t> dead;          // dead marks to draw, by row; empty for none
+    std::vector<uint8_t> drawnDead;     // dead mark last drawn at each point
+    std::vector<int8_t> shading;        // shades to draw, by row; empty for none
+    std::vector<int8_t> drawnShade;     // shade last drawn at each point
+    GoRenderRect dirty;
+    int cellsRedrawn;
+};
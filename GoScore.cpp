@@ -0,0 +1,162 @@
+// GoScore.cpp : Implements Tromp-Taylor area scoring.
+//
+#include "GoScore.h"
+
+#include <cstring>
+
+#include "GoBitPosition.h"
+#include "GoPosition.h"
+
+// Function to score by labelling every empty region with the colours
+// that border it
+template <int N>
+GoAreaScore ScoreArea(const GoPositionT<N>& position, double komi)
+{
+    GoAreaScore score = { 0, 0, komi };
+
+    bool seen[GoGeometry<N>::POINTS];
+    std::memset(seen, 0, sizeof(seen));
+    int stack[N * N];
+
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            int point = GoGeometry<N>::Point(x, y);
+            Stone stone = position.AtPoint(point);
+            if (stone == BLACK)
+            {
+                score.blackArea += 1;
+                continue;
+            }
+            if (stone == WHITE)
+            {
+                score.whiteArea += 1;
+                continue;
+            }
+            if (seen[point])
+                continue;
+
+            // Flood the region, noting which colours it touches
+            int size = 0;
+            bool blackBorder = false;
+            bool whiteBorder = false;
+            int top = 0;
+            stack[top++] = point;
+            seen[point] = true;
+            while (top > 0)
+            {
+                int current = stack[--top];
+                size += 1;
+                for (int offset : GoGeometry<N>::NEIGHBOR_OFFSETS)
+                {
+                    int adj = current + offset;
+                    Stone neighbor = position.AtPoint(adj);
+                    if (neighbor == EMPTY && !seen[adj])
+                    {
+                        seen[adj] = true;
+                        stack[top++] = adj;
+                    }
+                    blackBorder = blackBorder || neighbor == BLACK;
+                    whiteBorder = whiteBorder || neighbor == WHITE;
+                }
+            }
+
+            if (blackBorder && !whiteBorder)
+                score.blackArea += size;
+            else if (whiteBorder && !blackBorder)
+                score.whiteArea += size;
+        }
+    }
+    return score;
+}
+
+template <int N>
+GoAreaScore ScoreArea(const GoBitPositionT<N>& position, double komi)
+{
+    return ScoreArea(position.Stones(BLACK), position.Stones(WHITE), komi);
+}
+
+// Function to score by growing each colour through the empty points; a
+// point reached by one colour only belongs to it
+template <int N>
+GoAreaScore ScoreArea(const GoBitboardT<N>& black, const GoBitboardT<N>& white, double komi)
+{
+    GoBitboardT<N> empty = GoBitboardT<N>::BoardMask().AndNot(black | white);
+    GoBitboardT<N> blackReach = black.Neighbors().FloodFill(empty);
+    GoBitboardT<N> whiteReach = white.Neighbors().FloodFill(empty);
+
+    GoAreaScore score;
+    score.blackArea = black.Count() + blackReach.AndNot(whiteReach).Count();
+    score.whiteArea = white.Count() + whiteReach.AndNot(blackReach).Count();
+    score.komi = komi;
+    return score;
+}
+
+// Function to label every point with its owner, flooding each empty
+// region as ScoreArea does and then handing its points to its owner
+template <int N>
+void AreaOwners(const GoPositionT<N>& position, Stone* owners)
+{
+    bool seen[GoGeometry<N>::POINTS];
+    std::memset(seen, 0, sizeof(seen));
+    int region[N * N];
+
+    for (int y = 0; y < N; ++y)
+    {
+        for (int x = 0; x < N; ++x)
+        {
+            int point = GoGeometry<N>::Point(x, y);
+            Stone stone = position.AtPoint(point);
+            if (stone != EMPTY)
+            {
+                owners[y * N + x] = stone;
+                continue;
+            }
+            if (seen[point])
+                continue;
+
+            // The region's points double as the flood's queue
+            int size = 0;
+            bool blackBorder = false;
+            bool whiteBorder = false;
+            region[size++] = point;
+            seen[point] = true;
+            for (int i = 0; i < size; ++i)
+            {
+                for (int offset : GoGeometry<N>::NEIGHBOR_OFFSETS)
+                {
+                    int adj = region[i] + offset;
+                    Stone neighbor = position.AtPoint(adj);
+                    if (neighbor == EMPTY && !seen[adj])
+                    {
+                        seen[adj] = true;
+                        region[size++] = adj;
+                    }
+                    blackBorder = blackBorder || neighbor == BLACK;
+                    whiteBorder = whiteBorder || neighbor == WHITE;
+                }
+            }
+
+            Stone owner = blackBorder == whiteBorder ? EMPTY : blackBorder ? BLACK : WHITE;
+            for (int i = 0; i < size; ++i)
+            {
+                int cell = GoGeometry<N>::PointY(region[i]) * N + GoGeometry<N>::PointX(region[i]);
+                owners[cell] = owner;
+            }
+        }
+    }
+}
+
+template GoAreaScore ScoreArea(const GoPositionT<9>&, double);
+template GoAreaScore ScoreArea(const GoPositionT<13>&, double);
+template GoAreaScore ScoreArea(const GoPositionT<19>&, double);
+template GoAreaScore ScoreArea(const GoBitPositionT<9>&, double);
+template GoAreaScore ScoreArea(const GoBitPositionT<13>&, double);
+template GoAreaScore ScoreArea(const GoBitPositionT<19>&, double);
+template GoAreaScore ScoreArea(const GoBitboardT<9>&, const GoBitboardT<9>&, double);
+template GoAreaScore ScoreArea(const GoBitboardT<13>&, const GoBitboardT<13>&, double);
+template GoAreaScore ScoreArea(const GoBitboardT<19>&, const GoBitboardT<19>&, double);
+template void AreaOwners(const GoPositionT<9>&, Stone*);
+template void AreaOwners(const GoPositionT<13>&, Stone*);
+template void AreaOwners(const GoPositionT<19>&, Stone*);
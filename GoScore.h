@@ -0,0 +1,45 @@
+// GoScore.h : Tromp-Taylor area scoring.
+//
+// A player's area is their stones plus every empty point from which only
+// their stones can be reached through empty points. Regions that touch
+// both colours (dame, seki) or neither count for nobody. Dead stones are
+// not removed first, so a game should be played out until they are
+// captured, as playouts do, or scored with the dead stones found by
+// EstimateOwnership (see GoOwnership.h) taken off.
+//
+// The array version labels each empty region in one flood-fill pass. The
+// bitboard version grows both colours into the empty points at once with
+// whole-board shifts; on a finished game, where the empty regions are
+// small, that takes a handful of iterations.
+//
+#pragma once
+
+#include "GoBitboard.h"
+#include "GoTypes.h"
+
+template <int N> class GoPositionT;
+template <int N> class GoBitPositionT;
+
+struct GoAreaScore
+{
+    int blackArea;
+    int whiteArea;
+    double komi;
+
+    // Black's lead, negative when White is ahead
+    double Margin() const { return blackArea - whiteArea - komi; }
+    Stone Winner() const { return Margin() > 0 ? BLACK : Margin() < 0 ? WHITE : EMPTY; }
+};
+
+// Defined in GoScore.cpp for the sizes in GO_BOARD_SIZES
+template <int N>
+GoAreaScore ScoreArea(const GoPositionT<N>& position, double komi);
+template <int N>
+GoAreaScore ScoreArea(const GoBitPositionT<N>& position, double komi);
+template <int N>
+GoAreaScore ScoreArea(const GoBitboardT<N>& black, const GoBitboardT<N>& white, double komi);
+
+// Owner of every point by area, row by row (x + y * N): the colour of the
+// stone on it, the colour that alone borders its empty region, or EMPTY
+template <int N>
+void AreaOwners(const GoPositionT<N>& position, Stone* owners);
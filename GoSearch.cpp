@@ -0,0 +1,494 @@
+// GoSearch.cpp : Implements the multithreaded Monte Carlo tree search.
+//
+#include "GoSearch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <thread>
+
+#include "GoEvalQueue.h"
+#include "GoFeatures.h"
+#include "GoMetrics.h"
+#include "GoPlayout.h"
+#include "GoTactics.h"
+#include "GoTransTable.h"
+
+// Arenas release nodes without destroying them
+static_assert(std::is_trivially_destructible<GoNode>::value, "GoNode must be trivially destructible");
+
+double GoNode::WinRate() const
+{
+    int n = visits.load(std::memory_order_relaxed);
+    return n > 0 ? wins.load(std::memory_order_relaxed) / ((double)WIN_UNITS * n) : 0.5;
+}
+
+// Per-thread search state: a position to walk the tree on, a playout
+// engine with its own random generator, a tactical reader, the path of
+// the current descent and the network input and output of the last
+// expansion
+template <int N>
+struct GoSearchT<N>::Worker
+{
+    GoPositionT<N> board;
+    GoPlayoutT<N> playout;
+    GoTacticsT<N> tactics;
+    std::vector<GoNode*> path;
+    std::vector<uint64_t> keys; // table keys of the path's positions below the root
+    long long playouts;
+
+    uint8_t planes[FEATURE_PLANES * N * N];
+    float policy[N * N + 1];
+    bool evaluated;             // the descent expanded a node through the network
+    double blackValue;          // its value, as Black's chance to win
+
+    Worker(uint64_t seed, double komi) : playout(seed, komi), playouts(0), evaluated(false), blackValue(0.5) {}
+};
+
+template <int N>
+GoSearchT<N>::GoSearchT(const GoSearchOptions& options)
+    : options(options), evaluator(nullptr), table(nullptr), tableSalt(0), activeArena(0), stopRequested(false),
+      playoutsStarted(0), searchCount(0), lastPlayouts(0), lastSeconds(0)
+{
+    ResizeArenas();
+}
+
+template <int N>
+void GoSearchT<N>::SetOptions(const GoSearchOptions& value)
+{
+    bool resize = value.treeMemory != options.treeMemory;
+    bool rescore = value.komi != options.komi;
+    options = value;
+    if (resize)
+        ResizeArenas();
+    else if (rescore)
+        ClearTree(); // its win rates were counted with the old komi
+}
+
+template <int N>
+bool GoSearchT<N>::SetEvaluator(GoEvalQueue* value)
+{
+    if (value && value->Network().Shape().size != N)
+        return false;
+    evaluator = value;
+    return true;
+}
+
+// Function to split the memory budget over the two arenas
+template <int N>
+void GoSearchT<N>::ResizeArenas()
+{
+    std::size_t nodes = options.treeMemory / (2 * sizeof(GoNode));
+    arenas[0].Resize(nodes);
+    arenas[1].Resize(nodes);
+    ClearTree();
+}
+
+// Function to start a new game at the root
+template <int N>
+void GoSearchT<N>::Reset(KoRule rule)
+{
+    root.SetKoRule(rule);
+    ClearTree();
+}
+
+template <int N>
+void GoSearchT<N>::SetPosition(const GoPositionT<N>& position)
+{
+    root = position;
+    ClearTree();
+}
+
+// Function to play a move (a point or PASS_MOVE) at the root and keep
+// what is known about the position it leads to
+template <int N>
+bool GoSearchT<N>::Play(int move)
+{
+    if (!root.TryPlay(move))
+        return false;
+
+    if (tree.state.load(std::memory_order_acquire) == GoNode::EXPANDED)
+    {
+        for (int i = 0; i < tree.childCount; ++i)
+        {
+            if (tree.children[i].move == move)
+            {
+                PromoteChild(tree.children[i]);
+                return true;
+            }
+        }
+    }
+    ClearTree();
+    return true;
+}
+
+template <int N>
+void GoSearchT<N>::SkipTurn()
+{
+    root.TogglePlayer();
+    ClearTree();
+}
+
+template <int N>
+bool GoSearchT<N>::Undo()
+{
+    if (!root.Undo())
+        return false;
+    ClearTree();
+    return true;
+}
+
+template <int N>
+void GoSearchT<N>::ClearTree()
+{
+    arenas[0].Reset();
+    arenas[1].Reset();
+    tree.visits.store(0);
+    tree.wins.store(0);
+    tree.state.store(GoNode::LEAF);
+    tree.childCount = 0;
+    tree.children = nullptr;
+    tree.move = PASS_MOVE;
+}
+
+// Function to make a child of the root the new root: its subtree is
+// copied into the idle arena and the old arena is dropped as a whole
+template <int N>
+void GoSearchT<N>::PromoteChild(const GoNode& child)
+{
+    GoNodeArena& target = arenas[1 - activeArena];
+    target.Reset();
+
+    // The copy never needs more nodes than the arena it comes from holds
+    GoNode promoted;
+    CopySubtree(child, promoted, target);
+
+    tree.visits.store(promoted.visits.load());
+    tree.wins.store(promoted.wins.load());
+    tree.state.store(promoted.state.load());
+    tree.childCount = promoted.childCount;
+    tree.children = promoted.children;
+    tree.move = promoted.move;
+
+    arenas[activeArena].Reset();
+    activeArena = 1 - activeArena;
+}
+
+template <int N>
+void GoSearchT<N>::CopySubtree(const GoNode& from, GoNode& to, GoNodeArena& arena)
+{
+    to.visits.store(from.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    to.wins.store(from.wins.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    to.move = from.move;
+    to.prior = from.prior;
+    if (from.state.load(std::memory_order_relaxed) != GoNode::EXPANDED)
+        return;
+
+    GoNode* children = arena.Allocate(from.childCount);
+    for (int i = 0; i < from.childCount; ++i)
+        CopySubtree(from.children[i], children[i], arena);
+    to.children = children;
+    to.childCount = from.childCount;
+    to.state.store(GoNode::EXPANDED, std::memory_order_relaxed);
+}
+
+// Function to run workers on the tree until a limit is reached
+template <int N>
+int GoSearchT<N>::Search(const GoSearchLimits& limits)
+{
+    lastPlayouts = 0;
+    lastSeconds = 0;
+    if (root.IsGameOver())
+        return PASS_MOVE;
+
+    auto start = std::chrono::steady_clock::now();
+    stopRequested.store(false);
+    playoutsStarted.store(0);
+    uint64_t saltState = ((uint64_t)N << 32) ^ (uint64_t)std::llround(2 * options.komi);
+    tableSalt = NextZobristKey(saltState);
+
+    int threadCount = std::max(1, options.threads);
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        uint64_t seed = options.seed + searchCount * 0x10000 + t;
+        workers.emplace_back(new Worker(seed, options.komi));
+        workers.back()->board.CopyPosition(root);
+        workers.back()->playout.SetPatterns(options.patterns);
+    }
+    workers[0]->path.assign(1, &tree);
+    Expand(tree, *workers[0]);
+    searchCount += 1;
+
+    // The calling thread is the first worker
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; ++t)
+        threads.emplace_back(&GoSearchT::RunWorker, this, std::ref(*workers[t]), std::cref(limits));
+    RunWorker(*workers[0], limits);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (const auto& worker : workers)
+        lastPlayouts += worker->playouts;
+    lastSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return BestMove();
+}
+
+// Function to run descents, playouts and backups on one thread
+template <int N>
+void GoSearchT<N>::RunWorker(Worker& worker, const GoSearchLimits& limits)
+{
+    auto start = std::chrono::steady_clock::now();
+    const int virtualLoss = options.virtualLoss;
+    Stone rootPlayer = root.CurrentPlayer();
+    GoPositionT<N>& board = worker.board;
+
+    while (!stopRequested.load(std::memory_order_relaxed))
+    {
+        if (limits.stop && limits.stop->load(std::memory_order_relaxed))
+            break;
+        if (limits.playouts > 0 && playoutsStarted.fetch_add(1, std::memory_order_relaxed) >= limits.playouts)
+            break;
+        if (limits.seconds > 0 &&
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= limits.seconds)
+            break;
+
+        GO_METRIC_TIME(TIMER_SEARCH_ITERATION);
+
+        // Walk down through expanded nodes, leaving a virtual loss in each
+        worker.path.clear();
+        worker.keys.clear();
+        worker.evaluated = false;
+        GoNode* node = &tree;
+        node->visits.fetch_add(virtualLoss, std::memory_order_relaxed);
+        worker.path.push_back(node);
+        for (;;)
+        {
+            if (node->state.load(std::memory_order_acquire) != GoNode::EXPANDED)
+            {
+                // Expand a leaf that has been visited often enough, then
+                // step into one of its new children
+                int visits = node->visits.load(std::memory_order_relaxed) - virtualLoss;
+                if (visits < options.expandVisits || board.IsGameOver() || !Expand(*node, worker))
+                    break;
+            }
+
+            GoNode* child = SelectChild(*node);
+            if (child == nullptr || !board.TryPlay(child->move))
+                break;
+            int before = child->visits.fetch_add(virtualLoss, std::memory_order_relaxed);
+            worker.path.push_back(child);
+            node = child;
+            if (table)
+            {
+                worker.keys.push_back(board.Hash() ^ tableSalt);
+                if (before == 0)
+                    SeedFromTable(*child, worker.keys.back());
+            }
+        }
+
+        // Black's share of the result: the playout's, blended with the
+        // network value if the descent evaluated a position
+        double weight = worker.evaluated ? options.networkWeight : 0;
+        double blackResult = weight * worker.blackValue;
+        if (weight < 1)
+        {
+            Stone winner = worker.playout.Run(board).Winner();
+            blackResult += (1 - weight) * (winner == BLACK ? 1 : winner == EMPTY ? 0.5 : 0);
+        }
+        int blackPoints = (int)std::lround(blackResult * GoNode::WIN_UNITS);
+
+        // Replace the virtual losses by the real result; the node at
+        // depth d holds a move by the root player when d is odd
+        for (size_t depth = 0; depth < worker.path.size(); ++depth)
+        {
+            GoNode* visited = worker.path[depth];
+            Stone mover = depth % 2 == 1 ? rootPlayer : Opponent(rootPlayer);
+            int points = mover == BLACK ? blackPoints : GoNode::WIN_UNITS - blackPoints;
+            if (points)
+                visited->wins.fetch_add(points, std::memory_order_relaxed);
+            visited->visits.fetch_add(1 - virtualLoss, std::memory_order_relaxed);
+            if (table && depth > 0)
+                table->Add(worker.keys[depth - 1], 1, (uint32_t)points);
+        }
+
+        for (size_t depth = 1; depth < worker.path.size(); ++depth)
+            board.Undo();
+        worker.playouts += 1;
+    }
+}
+
+// Function to start a node reached for the first time from the results
+// the table holds for its position, keeping their win rate
+template <int N>
+void GoSearchT<N>::SeedFromTable(GoNode& node, uint64_t key)
+{
+    GoTransEntry entry;
+    if (!table->Lookup(key, entry) || entry.visits == 0)
+        return;
+    uint32_t visits = std::min(entry.visits, (uint32_t)std::max(0, options.transpositionVisits));
+    uint32_t wins = (uint32_t)((uint64_t)entry.wins * visits / entry.visits);
+    node.visits.fetch_add((int)visits, std::memory_order_relaxed);
+    if (wins)
+        node.wins.fetch_add((int)wins, std::memory_order_relaxed);
+}
+
+// Function to pick the child with the highest UCT or PUCT value
+template <int N>
+GoNode* GoSearchT<N>::SelectChild(GoNode& node) const
+{
+    int parentVisits = std::max(1, node.visits.load(std::memory_order_relaxed));
+    double logParent = std::log((double)parentVisits);
+    double sqrtParent = std::sqrt((double)parentVisits);
+
+    GoNode* best = nullptr;
+    double bestValue = -1;
+    for (int i = 0; i < node.childCount; ++i)
+    {
+        GoNode& child = node.children[i];
+        int visits = child.visits.load(std::memory_order_relaxed);
+        double value;
+        if (options.rule == SELECT_UCT)
+        {
+            // Unvisited children come first, in order
+            if (visits == 0)
+                return &child;
+            value = child.WinRate() + options.exploration * std::sqrt(logParent / visits);
+        }
+        else
+        {
+            value = child.WinRate() + options.exploration * child.prior * sqrtParent / (1 + visits);
+        }
+
+        if (value > bestValue)
+        {
+            bestValue = value;
+            best = &child;
+        }
+    }
+    return best;
+}
+
+// Function to create a node's children, one per legal move that does not
+// fill an own true eye plus a pass. The node is the last one on the
+// worker's path and its position the worker's board. Returns false if
+// another worker has claimed the node first.
+template <int N>
+bool GoSearchT<N>::Expand(GoNode& node, Worker& worker)
+{
+    GoPositionT<N>& position = worker.board;
+    GoNodeArena& arena = arenas[activeArena];
+    if (arena.Used() == arena.Capacity())
+        return false; // the tree has reached its memory budget
+
+    int expected = GoNode::LEAF;
+    if (!node.state.compare_exchange_strong(expected, GoNode::EXPANDING, std::memory_order_acq_rel))
+        return false;
+
+    GoMoveListT<N> moves;
+    position.GenerateLegalMoves(moves, true);
+    if (options.readLadders)
+        DropLostEscapes(moves, worker);
+    moves.Add(PASS_MOVE);
+
+    GoNode* children = arena.Allocate(moves.count);
+    if (children == nullptr)
+    {
+        node.state.store(GoNode::LEAF, std::memory_order_release);
+        return false;
+    }
+    for (int i = 0; i < moves.count; ++i)
+    {
+        children[i].move = moves.moves[i];
+        children[i].prior = 1.0f / moves.count;
+    }
+
+    if (evaluator)
+    {
+        // The moves on the path are the history the network sees
+        int recent[FEATURE_HISTORY];
+        int recentCount = 0;
+        for (size_t depth = worker.path.size() - 1; depth > 0 && recentCount < FEATURE_HISTORY; --depth)
+            recent[recentCount++] = worker.path[depth]->move;
+        ExtractFeatures(position, recent, recentCount, 0, worker.planes);
+        float value;
+        evaluator->Evaluate(worker.planes, worker.policy, value);
+
+        // Priors from the policy, renormalized over the children
+        float sum = 0;
+        for (int i = 0; i < moves.count; ++i)
+            sum += worker.policy[FeatureMoveIndex<N>(moves.moves[i], 0)];
+        for (int i = 0; i < moves.count && sum > 0; ++i)
+            children[i].prior = worker.policy[FeatureMoveIndex<N>(moves.moves[i], 0)] / sum;
+
+        worker.evaluated = true;
+        worker.blackValue = (position.CurrentPlayer() == BLACK ? 1 + value : 1 - value) / 2;
+    }
+    node.children = children;
+    node.childCount = moves.count;
+    node.state.store(GoNode::EXPANDED, std::memory_order_release);
+    GO_METRIC_ADD(METRIC_EXPANSIONS, 1);
+    return true;
+}
+
+// Function to leave out the moves that only extend a chain in atari which
+// cannot escape, such as running in a working ladder; a move that also
+// captures is kept
+template <int N>
+void GoSearchT<N>::DropLostEscapes(GoMoveListT<N>& moves, Worker& worker)
+{
+    GoPositionT<N>& position = worker.board;
+    Stone player = position.CurrentPlayer();
+    int kept = 0;
+    for (int i = 0; i < moves.count; ++i)
+    {
+        int move = moves.moves[i];
+        bool captures = false;
+        bool lost = false;
+        for (int offset : GoGeometry<N>::NEIGHBOR_OFFSETS)
+        {
+            int adj = move + offset;
+            Stone stone = position.AtPoint(adj);
+            if (stone == Opponent(player) && position.ChainInAtari(adj))
+                captures = true;
+            else if (stone == player && position.ChainInAtari(adj) && !lost)
+                lost = worker.tactics.ReadEscape(position, adj) == TACTIC_FAILS;
+        }
+        if (captures || !lost)
+            moves.moves[kept++] = move;
+    }
+    moves.count = kept;
+}
+
+template <int N>
+int GoSearchT<N>::BestMove() const
+{
+    std::vector<GoMoveStats> stats = RootStats();
+    return stats.empty() ? PASS_MOVE : stats.front().move;
+}
+
+template <int N>
+std::vector<GoMoveStats> GoSearchT<N>::RootStats() const
+{
+    std::vector<GoMoveStats> stats;
+    if (tree.state.load(std::memory_order_acquire) != GoNode::EXPANDED)
+        return stats;
+
+    for (int i = 0; i < tree.childCount; ++i)
+    {
+        const GoNode& child = tree.children[i];
+        int visits = child.visits.load(std::memory_order_relaxed);
+        if (visits > 0)
+            stats.push_back({ child.move, visits, child.WinRate() });
+    }
+    std::stable_sort(stats.begin(), stats.end(),
+        [](const GoMoveStats& a, const GoMoveStats& b) { return a.visits > b.visits; });
+    return stats;
+}
+
+template class GoSearchT<9>;
+template class GoSearchT<13>;
+template class GoSearchT<19>;
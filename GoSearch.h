@@ -0,0 +1,209 @@
+// GoSearch.h : Multithreaded Monte Carlo tree search.
+//
+// GoSearch keeps a game position (the root) and a search tree below it.
+// Search() runs several worker threads on the one shared tree (tree
+// parallelism). Each worker walks down from the root on its own copy of
+// the position, choosing children by UCT or PUCT, expands the leaf it
+// reaches, finishes the game with a random playout and adds the result to
+// every node on the way back up.
+//
+// Node statistics are atomic counters updated without locks. While a
+// worker is inside a node it holds a virtual loss there: the node looks
+// as if it had already lost a few more games, so the other workers
+// spread out over other lines instead of all following the same one.
+// A node is expanded by whichever worker first claims it; the others keep
+// playing out from it in the meantime instead of waiting.
+//
+// With an evaluator (a GoEvalQueue around a policy/value network) set,
+// every expansion also evaluates the node's position: the policy becomes
+// the children's priors, which PUCT selection uses, and the value is
+// blended with the playout result (networkWeight) when it is backed up.
+//
+// With a transposition table (GoTransTable) set, every result backed up
+// through a node is also added to the table under the node's position and
+// player to move (the wins are the mover's, so the same stones with the
+// other player to move are another entry), and a node reached for the
+// first time starts from the table's results for it, up to
+// transpositionVisits of them. Transpositions in
+// the tree, earlier searches and other processes sharing the table thus
+// pool what they learned about a position.
+//
+// Nodes live in a GoNodeArena with a fixed memory budget; once it is full
+// the tree stops growing and search goes on from its leaves. There are two
+// arenas. Playing a move at the root copies the subtree below that move
+// into the idle arena and then drops the old one in bulk, so the next
+// search starts from the statistics gathered so far instead of from zero.
+//
+// The root is changed with Reset, SetPosition, Play, SkipTurn and Undo,
+// which mirror the calls a front end makes on its own board. They must not
+// be called while a search is running; Stop() may be called from any
+// thread to end one early.
+//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "GoNodeArena.h"
+#include "GoPosition.h"
+
+class GoEvalQueue;
+class GoPatternWeights;
+class GoTransTable;
+
+// How children are ranked during the descent
+enum GoSelectionRule
+{
+    SELECT_UCT,     // win rate + c * sqrt(ln N / n)
+    SELECT_PUCT     // win rate + c * prior * sqrt(N) / (1 + n)
+};
+
+struct GoSearchOptions
+{
+    int threads = 1;
+    GoSelectionRule rule = SELECT_UCT;
+    double exploration = 0.7;   // c in the selection formula
+    int virtualLoss = 3;        // lost games a worker adds on its way down
+    int expandVisits = 2;       // visits a leaf needs before it is expanded
+    double komi = 7.5;
+    uint64_t seed = 1;
+    std::size_t treeMemory = 256 << 20; // bytes for both node arenas
+    double networkWeight = 0.5; // share of the network value in a result, with an evaluator
+    int transpositionVisits = 100; // most visits a new node takes from a transposition table
+    const GoPatternWeights* patterns = nullptr; // playout pattern weights, uniform playouts without
+    bool readLadders = false;   // leave out extensions of chains in atari that cannot escape (GoTactics.h)
+};
+
+// When Search() stops; a zero field means no limit of that kind
+struct GoSearchLimits
+{
+    long long playouts = 0;
+    double seconds = 0;
+
+    // Optional flag owned by the caller; the search ends once it is set.
+    // Unlike Stop(), a flag set before Search() starts is not missed.
+    const std::atomic<bool>* stop = nullptr;
+};
+
+// Tree node. The statistics count games from the point of view of the
+// player who made the node's move. Child arrays come from a GoNodeArena,
+// which never runs destructors.
+struct GoNode
+{
+    enum { LEAF, EXPANDING, EXPANDED };
+
+    // Fine enough for blended network values; a node can take 2^27 visits
+    static const int WIN_UNITS = 16;
+
+    std::atomic<int> visits;    // finished playouts plus virtual losses in flight
+    std::atomic<int> wins;      // in WIN_UNITS per win, half of that per draw
+    std::atomic<int> state;     // children are valid once this is EXPANDED
+    int childCount;
+    GoNode* children;
+    int move;
+    float prior;                // policy probability, used by PUCT
+
+    GoNode() : visits(0), wins(0), state(LEAF), childCount(0), children(nullptr), move(PASS_MOVE), prior(1) {}
+
+    double WinRate() const;
+};
+
+// Result of one root move
+struct GoMoveStats
+{
+    int move;
+    int visits;
+    double winRate;     // for the player to move at the root
+};
+
+template <int N>
+class GoSearchT
+{
+public:
+    explicit GoSearchT(const GoSearchOptions& options = GoSearchOptions());
+
+    GoSearchT(const GoSearchT&) = delete;
+    GoSearchT& operator=(const GoSearchT&) = delete;
+
+    // A new treeMemory or komi drops the tree. Not while a search is
+    // running.
+    const GoSearchOptions& Options() const { return options; }
+    void SetOptions(const GoSearchOptions& value);
+
+    // Use a network for priors and values, or stop with null. False if the
+    // network is for another board size. Not while a search is running.
+    bool SetEvaluator(GoEvalQueue* value);
+
+    // Share results through a transposition table, or stop with null. Not
+    // while a search is running.
+    void SetTranspositionTable(GoTransTable* value) { table = value; }
+
+    // Root position changes. Play keeps the subtree of the move played;
+    // the others drop the search tree.
+    void Reset(KoRule rule = KO_POSITIONAL_SUPERKO);
+    void SetPosition(const GoPositionT<N>& position);
+    bool Play(int move);
+    void SkipTurn();
+    bool Undo();
+
+    const GoPositionT<N>& Position() const { return root; }
+
+    // Search the root position until a limit is reached or Stop() is
+    // called, adding to the tree from earlier calls. Returns the best move.
+    int Search(const GoSearchLimits& limits);
+
+    // End a running search as soon as possible
+    void Stop() { stopRequested.store(true); }
+
+    // Most visited root move, or PASS_MOVE before any search
+    int BestMove() const;
+
+    // Root moves by decreasing visit count
+    std::vector<GoMoveStats> RootStats() const;
+
+    // Figures for the last Search() call
+    long long LastPlayouts() const { return lastPlayouts; }
+    double LastSeconds() const { return lastSeconds; }
+
+    // Playouts through the root so far, including reused ones
+    int RootVisits() const { return tree.visits.load(std::memory_order_relaxed); }
+
+    // Nodes in the tree and the most it can hold
+    std::size_t TreeNodes() const { return arenas[activeArena].Used() + 1; }
+    std::size_t TreeCapacity() const { return arenas[activeArena].Capacity() + 1; }
+
+private:
+    struct Worker;
+
+    void ClearTree();
+    void ResizeArenas();
+    void PromoteChild(const GoNode& child);
+    void CopySubtree(const GoNode& from, GoNode& to, GoNodeArena& arena);
+    void RunWorker(Worker& worker, const GoSearchLimits& limits);
+    GoNode* SelectChild(GoNode& node) const;
+    bool Expand(GoNode& node, Worker& worker);
+    void DropLostEscapes(GoMoveListT<N>& moves, Worker& worker);
+    void SeedFromTable(GoNode& node, uint64_t key);
+
+    GoSearchOptions options;
+    GoEvalQueue* evaluator;
+    GoTransTable* table;
+    uint64_t tableSalt;     // keeps positions of other sizes and komis apart
+    GoPositionT<N> root;
+    GoNode tree;
+
+    // Child arrays are allocated from arenas[activeArena]; the other one
+    // is only used while promoting a subtree
+    GoNodeArena arenas[2];
+    int activeArena;
+
+    std::atomic<bool> stopRequested;
+    std::atomic<long long> playoutsStarted;
+    uint64_t searchCount;
+
+    long long lastPlayouts;
+    double lastSeconds;
+};
+
+typedef GoSearchT<19> GoSearch;
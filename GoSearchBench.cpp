@@ -0,0 +1,103 @@
+// GoSearchBench.cpp : Tree search scaling benchmark.
+//
+// Usage: GoSearchBench [seconds per run] [max threads] [seed] [board size]
+//
+// Searches the empty board (19x19 unless a size of 9 or 13 is given) with 1, 2, 4, ... threads up to the maximum
+// (one per hardware core by default), each time on a fresh tree, and
+// reports playouts per second and the speed-up over one thread. Tree
+// parallelism should scale close to linearly as long as there are free
+// cores. Then it plays the best move at the root and reports how much of
+// the tree was kept for the next search and how long promoting it took.
+//
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "GoSearch.h"
+
+// Function to format a move in the usual letters-and-numbers notation
+template <int N>
+static void FormatMove(int move, char (&text)[16])
+{
+    if (move == PASS_MOVE)
+    {
+        std::snprintf(text, sizeof text, "pass");
+        return;
+    }
+    int x = GoGeometry<N>::PointX(move);
+    int y = GoGeometry<N>::PointY(move);
+    std::snprintf(text, sizeof text, "%c%d", "ABCDEFGHJKLMNOPQRST"[x], N - y);
+}
+
+// Function to run the scaling table and the reuse test on one board size
+template <int N>
+static void RunBench(double seconds, int maxThreads, uint64_t seed)
+{
+    std::printf("%dx%d empty board, %.1f s per run\n", N, N, seconds);
+    std::printf("%-8s %14s %10s %10s %8s\n", "threads", "playouts/sec", "speed-up", "best move", "win rate");
+
+    double single = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        GoSearchOptions options;
+        options.threads = threads;
+        options.seed = seed;
+        GoSearchT<N> search(options);
+
+        GoSearchLimits limits;
+        limits.seconds = seconds;
+        int best = search.Search(limits);
+
+        double rate = search.LastPlayouts() / search.LastSeconds();
+        if (threads == 1)
+            single = rate;
+        char move[16];
+        FormatMove<N>(best, move);
+        std::printf("%-8d %14.0f %10.2f %10s %7.1f%%\n", threads, rate, rate / single, move,
+            100.0 * search.RootStats().front().winRate);
+
+        if (threads < maxThreads && threads * 2 > maxThreads)
+            threads = maxThreads / 2; // finish with exactly maxThreads
+    }
+
+    GoSearchOptions options;
+    options.threads = maxThreads;
+    options.seed = seed;
+    GoSearchT<N> search(options);
+    GoSearchLimits limits;
+    limits.seconds = seconds;
+    int best = search.Search(limits);
+    int visits = search.RootVisits();
+    std::size_t nodes = search.TreeNodes();
+
+    auto start = std::chrono::steady_clock::now();
+    search.Play(best);
+    double promoteSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("tree reuse: kept %d of %d playouts and %zu of %zu nodes in %.2f ms\n", search.RootVisits(), visits,
+        search.TreeNodes(), nodes, 1000 * promoteSeconds);
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+    uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 20241017;
+    int size = argc > 4 ? std::atoi(argv[4]) : 19;
+    if (maxThreads <= 0)
+        maxThreads = 1;
+    if (seconds <= 0 || (size != 9 && size != 13 && size != 19))
+    {
+        std::fprintf(stderr, "usage: GoSearchBench [seconds per run > 0] [max threads] [seed] [board size 9, 13 or 19]\n");
+        return 2;
+    }
+
+    if (size == 9)
+        RunBench<9>(seconds, maxThreads, seed);
+    else if (size == 13)
+        RunBench<13>(seconds, maxThreads, seed);
+    else
+        RunBench<19>(seconds, maxThreads, seed);
+    return 0;
+}
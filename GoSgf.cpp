@@ -0,0 +1,436 @@
+// GoSgf.cpp : Implements the SGF reader and game replay.
+//
+#include "GoSgf.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+void GoSgfGame::Clear()
+{
+    size = 19;
+    komi = 0;
+    result = std::string_view();
+    moves.clear();
+}
+
+bool GoSgfReport::IsComplete() const
+{
+    for (const GoSgfIssue& issue : issues)
+    {
+        if (issue.problem != SGF_REPETITION)
+            return false;
+    }
+    return true;
+}
+
+// Function to step over a property value; p is at its '['. Returns the
+// character after the closing ']', or nullptr if the text ends first.
+static const char* SkipValue(const char* p, const char* end)
+{
+    for (++p; p < end; ++p)
+    {
+        if (*p == '\\')
+            ++p; // the next character is taken literally
+        else if (*p == ']')
+            return p + 1;
+    }
+    return nullptr;
+}
+
+// Function to step over a game tree; p is at its '('. Returns the
+// character after the matching ')', or nullptr if the text ends first.
+static const char* SkipTree(const char* p, const char* end)
+{
+    int depth = 0;
+    while (p < end)
+    {
+        char c = *p;
+        if (c == '[')
+        {
+            p = SkipValue(p, end);
+            if (p == nullptr)
+                return nullptr;
+            continue;
+        }
+        ++p;
+        if (c == '(')
+            depth += 1;
+        else if (c == ')' && --depth == 0)
+            return p;
+    }
+    return nullptr;
+}
+
+bool FindSgfGames(std::string_view text, std::vector<std::string_view>& games)
+{
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end)
+    {
+        // Anything between trees is ignored
+        p = static_cast<const char*>(std::memchr(p, '(', end - p));
+        if (p == nullptr)
+            return true;
+        const char* next = SkipTree(p, end);
+        if (next == nullptr)
+            return false;
+        games.push_back(std::string_view(p, next - p));
+        p = next;
+    }
+    return true;
+}
+
+// Function to read a point value; an empty value is a pass. Letters
+// outside a-z give a coordinate no board has.
+static bool ReadPoint(std::string_view value, GoSgfMove& move)
+{
+    if (value.empty())
+    {
+        move.x = move.y = -1;
+        return true;
+    }
+    if (value.size() != 2)
+        return false;
+    move.x = (value[0] >= 'a' && value[0] <= 'z') ? value[0] - 'a' : 127;
+    move.y = (value[1] >= 'a' && value[1] <= 'z') ? value[1] - 'a' : 127;
+    return true;
+}
+
+// Function to read a number from a view, which is not terminated
+static double ReadNumber(std::string_view value)
+{
+    char text[32];
+    std::size_t length = value.size() < sizeof(text) - 1 ? value.size() : sizeof(text) - 1;
+    std::memcpy(text, value.data(), length);
+    text[length] = '\0';
+    return std::strtod(text, nullptr);
+}
+
+// Function to take in one value of a property the replay needs; the
+// others are skipped
+static bool ReadProperty(const char* name, std::string_view value, GoSgfGame& game)
+{
+    GoSgfMove move = { EMPTY, -1, -1, false };
+    if ((name[0] == 'B' || name[0] == 'W') && name[1] == '\0')
+    {
+        move.player = name[0] == 'B' ? BLACK : WHITE;
+        if (!ReadPoint(value, move))
+            return false;
+        if (value == "tt" && game.size <= 19)
+            move.x = move.y = -1; // old-style pass
+        game.moves.push_back(move);
+    }
+    else if (name[0] == 'A' && (name[1] == 'B' || name[1] == 'W') && name[2] == '\0')
+    {
+        // A single point or a rectangle given by two corners
+        move.player = name[1] == 'B' ? BLACK : WHITE;
+        move.setup = true;
+        GoSgfMove corner = move;
+        std::size_t colon = value.find(':');
+        if (colon == std::string_view::npos)
+        {
+            if (!ReadPoint(value, move) || move.x < 0)
+                return false;
+            game.moves.push_back(move);
+            return true;
+        }
+        if (!ReadPoint(value.substr(0, colon), move) || !ReadPoint(value.substr(colon + 1), corner) ||
+            move.x < 0 || corner.x < 0 || move.x > corner.x || move.y > corner.y)
+            return false;
+        for (int y = move.y; y <= corner.y; ++y)
+        {
+            for (int x = move.x; x <= corner.x; ++x)
+            {
+                GoSgfMove stone = move;
+                stone.x = (signed char)x;
+                stone.y = (signed char)y;
+                game.moves.push_back(stone);
+            }
+        }
+    }
+    else if (std::strcmp(name, "SZ") == 0)
+    {
+        game.size = (int)ReadNumber(value.substr(0, value.find(':')));
+    }
+    else if (std::strcmp(name, "KM") == 0)
+    {
+        game.komi = ReadNumber(value);
+    }
+    else if (std::strcmp(name, "RE") == 0)
+    {
+        game.result = value;
+    }
+    return true;
+}
+
+bool ParseSgfGame(std::string_view tree, GoSgfGame& game)
+{
+    game.Clear();
+    const char* p = tree.data();
+    const char* end = p + tree.size();
+
+    // Uppercase letters of the current property identifier; lowercase
+    // letters, allowed in old files ("AddBlack"), are dropped
+    char name[4] = { 0 };
+    int nameLength = 0;
+    bool haveName = false;
+
+    int depth = 0;
+    bool mainLine = true;
+    while (p < end)
+    {
+        char c = *p;
+        if (c == '[')
+        {
+            const char* next = SkipValue(p, end);
+            if (next == nullptr || !haveName || depth == 0)
+                return false;
+            if (nameLength <= 2 && !ReadProperty(name, std::string_view(p + 1, next - p - 2), game))
+                return false;
+            p = next;
+        }
+        else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
+        {
+            // A letter after a value starts the next property
+            if (depth == 0 || !mainLine)
+                return false;
+            nameLength = 0;
+            for (; p < end && ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')); ++p)
+            {
+                if (*p >= 'A' && *p <= 'Z' && nameLength < 3)
+                    name[nameLength++] = *p;
+            }
+            name[nameLength < 3 ? nameLength : 3] = '\0';
+            haveName = nameLength > 0;
+        }
+        else if (c == ';')
+        {
+            if (depth == 0 || !mainLine)
+                return false;
+            haveName = false;
+            ++p;
+        }
+        else if (c == '(')
+        {
+            // Only the first variation at each branch is followed
+            if (!mainLine)
+            {
+                p = SkipTree(p, end);
+                if (p == nullptr)
+                    return false;
+                continue;
+            }
+            depth += 1;
+            haveName = false;
+            ++p;
+        }
+        else if (c == ')')
+        {
+            if (depth == 0)
+                return false;
+            mainLine = false;
+            haveName = false;
+            ++p;
+            if (--depth == 0)
+                return true;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            ++p;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+template <int N>
+void ReplaySgfGame(const GoSgfGame& game, GoPositionT<N>& position, GoHashHistory& seen, GoSgfReport& report)
+{
+    report.size = N;
+    report.moves = 0;
+    report.issues.clear();
+    if (position.GetKoRule() != KO_SIMPLE)
+        position.SetKoRule(KO_SIMPLE);
+    else
+        position.Reset();
+    seen.Clear();
+    seen.Insert(position.PositionHash());
+
+    int moveNumber = 0;
+    for (const GoSgfMove& move : game.moves)
+    {
+        if (!move.setup)
+            moveNumber += 1;
+        GoSgfIssue issue = { SGF_ILLEGAL_MOVE, MOVE_LEGAL, move.setup ? 0 : moveNumber, move };
+
+        // Records say whose move it is; a player moving twice in a row
+        // (after handicap stones, say) is taken as a skipped turn
+        if (move.player != position.CurrentPlayer())
+            position.TogglePlayer();
+
+        if (move.x < 0)
+        {
+            position.Pass();
+            report.moves += 1;
+            continue;
+        }
+        if (move.x >= N || move.y >= N)
+        {
+            issue.problem = SGF_BAD_COORDINATE;
+            report.issues.push_back(issue);
+            return;
+        }
+
+        int point = GoGeometry<N>::Point(move.x, move.y);
+        issue.status = position.CheckMove(point);
+        if (issue.status != MOVE_LEGAL)
+        {
+            report.issues.push_back(issue);
+            return;
+        }
+        position.TryPlay(point);
+        if (!move.setup)
+            report.moves += 1;
+
+        // Passes leave the stones as they are, so only moves are checked
+        if (!seen.Insert(position.PositionHash()))
+        {
+            issue.problem = SGF_REPETITION;
+            report.issues.push_back(issue);
+        }
+    }
+}
+
+template void ReplaySgfGame(const GoSgfGame&, GoPositionT<9>&, GoHashHistory&, GoSgfReport&);
+template void ReplaySgfGame(const GoSgfGame&, GoPositionT<13>&, GoHashHistory&, GoSgfReport&);
+template void ReplaySgfGame(const GoSgfGame&, GoPositionT<19>&, GoHashHistory&, GoSgfReport&);
+
+// Function to append a property value, escaping the characters SGF
+// gives a meaning
+static void WriteValue(std::string_view value, std::string& text)
+{
+    text += '[';
+    for (char c : value)
+    {
+        if (c == ']' || c == '\\')
+            text += '\\';
+        text += c;
+    }
+    text += ']';
+}
+
+// Function to append the coordinates of a move, nothing for a pass
+static void WritePoint(const GoSgfMove& move, std::string& text)
+{
+    if (move.x >= 0)
+    {
+        text += (char)('a' + move.x);
+        text += (char)('a' + move.y);
+    }
+}
+
+void WriteSgfGame(const GoSgfGame& game, std::string& text, std::string_view black, std::string_view white)
+{
+    char number[32];
+    std::snprintf(number, sizeof number, "%d", game.size);
+    text += "(;GM[1]FF[4]SZ[";
+    text += number;
+    std::snprintf(number, sizeof number, "%g", game.komi);
+    text += "]KM[";
+    text += number;
+    text += ']';
+    if (!black.empty())
+    {
+        text += "PB";
+        WriteValue(black, text);
+    }
+    if (!white.empty())
+    {
+        text += "PW";
+        WriteValue(white, text);
+    }
+    if (!game.result.empty())
+    {
+        text += "RE";
+        WriteValue(game.result, text);
+    }
+
+    // Setup stones after a move start a node of their own. A node may hold
+    // each property once, so a run of setup stones becomes one AB and one
+    // AW with a value per stone.
+    bool moveNode = false;
+    for (std::size_t i = 0; i < game.moves.size();)
+    {
+        const GoSgfMove& move = game.moves[i];
+        if (!move.setup)
+        {
+            text += move.player == BLACK ? ";B[" : ";W[";
+            WritePoint(move, text);
+            text += ']';
+            moveNode = true;
+            i += 1;
+            continue;
+        }
+
+        std::size_t end = i;
+        while (end < game.moves.size() && game.moves[end].setup)
+            end += 1;
+        if (moveNode)
+            text += ';';
+        for (Stone player : { BLACK, WHITE })
+        {
+            bool named = false;
+            for (std::size_t j = i; j < end; ++j)
+            {
+                if (game.moves[j].player != player)
+                    continue;
+                if (!named)
+                    text += player == BLACK ? "AB" : "AW";
+                named = true;
+                text += '[';
+                WritePoint(game.moves[j], text);
+                text += ']';
+            }
+        }
+        moveNode = false;
+        i = end;
+    }
+    text += ")\n";
+}
+
+const char* SgfProblemName(const GoSgfIssue& issue)
+{
+    switch (issue.problem)
+    {
+    case SGF_READ_ERROR:
+        return "file could not be read";
+    case SGF_SYNTAX_ERROR:
+        return "syntax error";
+    case SGF_UNSUPPORTED_SIZE:
+        return "unsupported board size";
+    case SGF_BAD_COORDINATE:
+        return "point off the board";
+    case SGF_REPETITION:
+        return "repeated position (superko)";
+    case SGF_ILLEGAL_MOVE:
+        break;
+    }
+
+    switch (issue.status)
+    {
+    case MOVE_OCCUPIED:
+        return "point occupied";
+    case MOVE_SUICIDE:
+        return "suicide";
+    case MOVE_KO:
+        return "ko retaken at once";
+    case MOVE_SUPERKO:
+        return "superko";
+    default:
+        return "illegal move";
+    }
+}
@@ -0,0 +1,104 @@
+// GoSgf.h : Zero-copy reader for SGF game records.
+//
+// SGF text is read in place: FindSgfGames splits a collection into its
+// game trees and ParseSgfGame walks one tree, following the main line
+// (the first variation at every branch) and skipping the others. Nothing
+// is copied out of the text; property values that are kept, such as the
+// result, are views into it, so the text must outlive the GoSgfGame.
+// A GoSgfGame can be reused for many records and stops allocating once
+// its move list has grown to the longest game.
+//
+// ReplaySgfGame plays a parsed game through the rules engine move by
+// move, under simple ko, and reports what is wrong with it. An illegal
+// move (occupied point, suicide, retaking a ko at once, or a coordinate
+// off the board) ends the replay, since the rest of the record no longer
+// fits the board. A move that repeats an earlier position is a superko
+// violation; it is reported but the replay goes on, because many records
+// come from rule sets that allow it.
+//
+// WriteSgfGame goes the other way, for records of games the engine plays.
+//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GoPosition.h"
+
+// One move or setup stone of a record; x is -1 for a pass
+struct GoSgfMove
+{
+    Stone player;
+    signed char x;
+    signed char y;
+    bool setup;     // AB or AW stone rather than a move
+};
+
+// Main line of one game record
+struct GoSgfGame
+{
+    int size;
+    double komi;
+    std::string_view result;        // RE value, empty if none
+    std::vector<GoSgfMove> moves;   // setup stones and moves in order
+
+    GoSgfGame() : size(19), komi(0) {}
+
+    void Clear();
+};
+
+// What can be wrong with a record
+enum GoSgfProblem
+{
+    SGF_READ_ERROR,         // the file could not be mapped
+    SGF_SYNTAX_ERROR,       // the text is not a well-formed game tree
+    SGF_UNSUPPORTED_SIZE,   // SZ is not one of GO_BOARD_SIZES
+    SGF_BAD_COORDINATE,     // a point outside the board
+    SGF_ILLEGAL_MOVE,       // see GoSgfIssue::status
+    SGF_REPETITION          // positional superko violation
+};
+
+struct GoSgfIssue
+{
+    GoSgfProblem problem;
+    GoMoveStatus status;    // for SGF_ILLEGAL_MOVE
+    int moveNumber;         // 1 for the first move, 0 for setup stones and whole-record problems
+    GoSgfMove move;
+};
+
+// Result of replaying one record
+struct GoSgfReport
+{
+    int file;               // index into the importer's file list
+    int game;               // index of the game within its file
+    int size;
+    int moves;              // moves replayed
+    std::vector<GoSgfIssue> issues;
+
+    // Whether the whole record was replayed
+    bool IsComplete() const;
+};
+
+// Function to append a view of every top-level game tree in text to
+// games. Returns false if the text ends inside a tree; the complete
+// trees before it are still listed.
+bool FindSgfGames(std::string_view text, std::vector<std::string_view>& games);
+
+// Function to parse the main line of one game tree. Returns false on a
+// syntax error, in which case game holds what was read up to it.
+bool ParseSgfGame(std::string_view tree, GoSgfGame& game);
+
+// Function to replay a game on position (reset first) and fill in
+// report.size, report.moves and report.issues. seen is scratch space for
+// the repetition check.
+template <int N>
+void ReplaySgfGame(const GoSgfGame& game, GoPositionT<N>& position, GoHashHistory& seen, GoSgfReport& report);
+
+// Name of a problem or move status, for reports
+const char* SgfProblemName(const GoSgfIssue& issue);
+
+// Function to append a game to text as one SGF game tree, with the player
+// names if given. Setup stones at the start go into the root node.
+void WriteSgfGame(const GoSgfGame& game, std::string& text, std::string_view black = std::string_view(),
+    std::string_view white = std::string_view());
@@ -0,0 +1,263 @@
+// GoSgfImporter.cpp : Implements the parallel SGF importer.
+//
+#include "GoSgfImporter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "GoMappedFile.h"
+
+// A run of consecutive game trees from one file. The batch shares
+// ownership of the mapping, which is released with the last batch.
+struct GoSgfImporter::Batch
+{
+    std::shared_ptr<GoMappedFile> mapping;
+    int file;
+    int firstGame;
+    std::vector<std::string_view> games;
+};
+
+// Per-thread state: one scratch position per board size, parse and
+// replay buffers, and the thread's share of the results
+struct GoSgfImporter::Worker
+{
+    GoPositionT<9> board9;
+    GoPositionT<13> board13;
+    GoPositionT<19> board19;
+    GoHashHistory seen;
+    GoSgfGame game;
+    GoSgfReport report;
+    GoSgfImportStats stats;
+    std::vector<GoSgfReport> problems;
+
+    Worker()
+        : board9(KO_SIMPLE), board13(KO_SIMPLE), board19(KO_SIMPLE)
+    {
+        board9.SetUndoEnabled(false);
+        board13.SetUndoEnabled(false);
+        board19.SetUndoEnabled(false);
+    }
+};
+
+// Bounded queue between the reading thread and the workers. Push blocks
+// while it is full, which keeps the reader from mapping the whole archive
+// ahead of the workers.
+class GoSgfImporter::BatchQueue
+{
+public:
+    explicit BatchQueue(std::size_t capacity) : capacity(capacity), closed(false) {}
+
+    void Push(std::unique_ptr<Batch> batch)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this]() { return batches.size() < capacity; });
+        batches.push_back(std::move(batch));
+        notEmpty.notify_one();
+    }
+
+    // The next batch, or null once the queue is closed and empty
+    std::unique_ptr<Batch> Pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this]() { return !batches.empty() || closed; });
+        if (batches.empty())
+            return nullptr;
+        std::unique_ptr<Batch> batch = std::move(batches.front());
+        batches.pop_front();
+        notFull.notify_one();
+        return batch;
+    }
+
+    // No more batches will be pushed
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    std::deque<std::unique_ptr<Batch>> batches;
+    std::size_t capacity;
+    bool closed;
+};
+
+// Function to make a report for a problem with a whole record
+static GoSgfReport RecordProblem(int file, int game, GoSgfProblem problem)
+{
+    GoSgfReport report;
+    report.file = file;
+    report.game = game;
+    report.size = 0;
+    report.moves = 0;
+    report.issues.push_back({ problem, MOVE_LEGAL, 0, { EMPTY, -1, -1, false } });
+    return report;
+}
+
+GoSgfImporter::GoSgfImporter(int threads)
+    : threads(threads)
+{
+}
+
+// Function to read, split and queue the files while the workers replay
+GoSgfImportStats GoSgfImporter::Import(const std::vector<std::string>& paths)
+{
+    auto start = std::chrono::steady_clock::now();
+    problems.clear();
+
+    int threadCount = threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency());
+    BatchQueue queue(4 * threadCount);
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> workerThreads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        workers.emplace_back(new Worker());
+        workerThreads.emplace_back(&GoSgfImporter::RunWorker, this, std::ref(*workers.back()), std::ref(queue));
+    }
+
+    GoSgfImportStats stats;
+    std::vector<std::string_view> trees;
+    for (int file = 0; file < (int)paths.size(); ++file)
+    {
+        std::shared_ptr<GoMappedFile> mapping = std::make_shared<GoMappedFile>();
+        if (!mapping->Open(paths[file].c_str()))
+        {
+            stats.unreadableFiles += 1;
+            problems.push_back(RecordProblem(file, 0, SGF_READ_ERROR));
+            continue;
+        }
+        stats.files += 1;
+        stats.bytes += (long long)mapping->Size();
+
+        trees.clear();
+        if (!FindSgfGames(mapping->Text(), trees))
+        {
+            // The file ends inside a game tree
+            stats.games += 1;
+            stats.syntaxErrors += 1;
+            problems.push_back(RecordProblem(file, (int)trees.size(), SGF_SYNTAX_ERROR));
+        }
+        stats.games += (long long)trees.size();
+
+        for (std::size_t first = 0; first < trees.size(); first += BATCH_GAMES)
+        {
+            std::size_t last = std::min(trees.size(), first + BATCH_GAMES);
+            std::unique_ptr<Batch> batch(new Batch());
+            batch->mapping = mapping;
+            batch->file = file;
+            batch->firstGame = (int)first;
+            batch->games.assign(trees.begin() + first, trees.begin() + last);
+            queue.Push(std::move(batch));
+        }
+    }
+    queue.Close();
+    for (std::thread& thread : workerThreads)
+        thread.join();
+
+    for (const auto& worker : workers)
+    {
+        stats.moves += worker->stats.moves;
+        stats.completeGames += worker->stats.completeGames;
+        stats.syntaxErrors += worker->stats.syntaxErrors;
+        stats.unsupportedSizes += worker->stats.unsupportedSizes;
+        stats.illegalMoves += worker->stats.illegalMoves;
+        stats.koViolations += worker->stats.koViolations;
+        problems.insert(problems.end(), worker->problems.begin(), worker->problems.end());
+    }
+    std::sort(problems.begin(), problems.end(), [](const GoSgfReport& a, const GoSgfReport& b) {
+        return a.file != b.file ? a.file < b.file : a.game < b.game;
+    });
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void GoSgfImporter::RunWorker(Worker& worker, BatchQueue& queue)
+{
+    while (std::unique_ptr<Batch> batch = queue.Pop())
+    {
+        for (std::size_t i = 0; i < batch->games.size(); ++i)
+            ReplayGame(worker, batch->games[i], batch->file, batch->firstGame + (int)i);
+    }
+}
+
+// Function to parse and replay one record and count what was found
+void GoSgfImporter::ReplayGame(Worker& worker, std::string_view tree, int file, int game)
+{
+    GoSgfReport& report = worker.report;
+    report.file = file;
+    report.game = game;
+    report.size = 0;
+    report.moves = 0;
+    report.issues.clear();
+
+    GoSgfIssue recordIssue = { SGF_SYNTAX_ERROR, MOVE_LEGAL, 0, { EMPTY, -1, -1, false } };
+    if (!ParseSgfGame(tree, worker.game))
+    {
+        report.issues.push_back(recordIssue);
+    }
+    else if (worker.game.size == 9)
+    {
+        ReplaySgfGame(worker.game, worker.board9, worker.seen, report);
+    }
+    else if (worker.game.size == 13)
+    {
+        ReplaySgfGame(worker.game, worker.board13, worker.seen, report);
+    }
+    else if (worker.game.size == 19)
+    {
+        ReplaySgfGame(worker.game, worker.board19, worker.seen, report);
+    }
+    else
+    {
+        report.size = worker.game.size;
+        recordIssue.problem = SGF_UNSUPPORTED_SIZE;
+        report.issues.push_back(recordIssue);
+    }
+
+    GoSgfImportStats& stats = worker.stats;
+    stats.moves += report.moves;
+    for (const GoSgfIssue& issue : report.issues)
+    {
+        stats.syntaxErrors += issue.problem == SGF_SYNTAX_ERROR;
+        stats.unsupportedSizes += issue.problem == SGF_UNSUPPORTED_SIZE;
+        stats.illegalMoves += issue.problem == SGF_BAD_COORDINATE || issue.problem == SGF_ILLEGAL_MOVE;
+        stats.koViolations += issue.problem == SGF_REPETITION || issue.status == MOVE_KO;
+    }
+    stats.completeGames += report.IsComplete();
+
+    if (gameCallback)
+        gameCallback(worker.game, report);
+    if (!report.issues.empty())
+        worker.problems.push_back(report);
+}
+
+// Function to add a file, or the .sgf files below a directory, to paths
+void AddSgfPath(const std::string& path, std::vector<std::string>& paths)
+{
+    std::error_code error;
+    if (!std::filesystem::is_directory(path, error))
+    {
+        paths.push_back(path);
+        return;
+    }
+
+    std::vector<std::string> found;
+    for (std::filesystem::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error))
+    {
+        std::string extension = it->path().extension().string();
+        if (it->is_regular_file(error) && (extension == ".sgf" || extension == ".SGF"))
+            found.push_back(it->path().string());
+    }
+    std::sort(found.begin(), found.end());
+    paths.insert(paths.end(), found.begin(), found.end());
+}
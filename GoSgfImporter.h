@@ -0,0 +1,76 @@
+// GoSgfImporter.h : Parallel import of large SGF archives.
+//
+// Import() streams a list of SGF files through the rules engine. The
+// calling thread maps one file at a time (see GoMappedFile), splits it
+// into game trees and hands them out in batches through a bounded queue;
+// worker threads parse and replay the games straight from the mapping
+// (see GoSgf.h). A mapping is released as soon as its last batch is done
+// and at most a few batches per worker wait in the queue, so memory use
+// does not grow with the size of the archive.
+//
+// Every worker keeps its own positions, parse buffers and report, which
+// stop allocating after the first few games. A record that cannot be read
+// or replayed is counted and kept in Problems(); the run goes on.
+//
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "GoSgf.h"
+
+// Totals for one Import() call
+struct GoSgfImportStats
+{
+    long long files = 0;
+    long long bytes = 0;
+    long long games = 0;            // game trees found
+    long long moves = 0;            // moves replayed
+    long long completeGames = 0;    // replayed to the end
+    long long unreadableFiles = 0;
+    long long syntaxErrors = 0;
+    long long unsupportedSizes = 0;
+    long long illegalMoves = 0;     // games cut short by an illegal move or bad point
+    long long koViolations = 0;     // simple ko and superko violations, all games
+    double seconds = 0;
+
+    double GamesPerSecond() const { return seconds > 0 ? games / seconds : 0; }
+};
+
+class GoSgfImporter
+{
+public:
+    // Zero threads means one per hardware core
+    explicit GoSgfImporter(int threads = 0);
+
+    // Called on a worker thread for every record after its replay
+    typedef std::function<void(const GoSgfGame& game, const GoSgfReport& report)> GameCallback;
+    void SetGameCallback(const GameCallback& callback) { gameCallback = callback; }
+
+    // Import the files and return the totals
+    GoSgfImportStats Import(const std::vector<std::string>& paths);
+
+    // Reports of the records with problems from the last Import(), in
+    // file and game order
+    const std::vector<GoSgfReport>& Problems() const { return problems; }
+
+    // Records per batch handed to a worker
+    static const int BATCH_GAMES = 64;
+
+private:
+    struct Batch;
+    struct Worker;
+    class BatchQueue;
+
+    void RunWorker(Worker& worker, BatchQueue& queue);
+    void ReplayGame(Worker& worker, std::string_view tree, int file, int game);
+
+    int threads;
+    GameCallback gameCallback;
+    std::vector<GoSgfReport> problems;
+};
+
+// Function to add a file, or the .sgf files below a directory in name
+// order, to paths
+void AddSgfPath(const std::string& path, std::vector<std::string>& paths);
@@ -0,0 +1,256 @@
+// GoTactics.cpp : Implements the ladder and atari reader.
+//
+#include "GoTactics.h"
+
+// Cached regions kept before the cache starts over
+static const int MAX_REGION_POOL = 1 << 16;
+
+// Escape moves tried per position: the extension and captures of
+// neighbouring chains in atari
+static const int MAX_ESCAPE_MOVES = 16;
+
+template <int N>
+GoTacticsT<N>::GoTacticsT(int maxDepth, int maxNodes)
+    : maxDepth(maxDepth), maxNodes(maxNodes), position(nullptr), readNodes(0), limited(false), markSerial(0),
+      chainSerial(0), reads(0), cacheHits(0), nodes(0)
+{
+    for (int point = 0; point < POINTS; ++point)
+    {
+        marks[point] = 0;
+        chainMarks[point] = 0;
+    }
+    ClearCache();
+}
+
+template <int N>
+GoTacticResult GoTacticsT<N>::ReadCapture(GoPositionT<N>& target, int point)
+{
+    return Read(target, point, READ_CAPTURE);
+}
+
+template <int N>
+GoTacticResult GoTacticsT<N>::ReadEscape(GoPositionT<N>& target, int point)
+{
+    return Read(target, point, READ_ESCAPE);
+}
+
+template <int N>
+void GoTacticsT<N>::ClearCache()
+{
+    for (int kind = 0; kind < 2; ++kind)
+    {
+        for (int point = 0; point < POINTS; ++point)
+            cache[kind][point].valid = false;
+    }
+    regionPool.clear();
+}
+
+// Function to answer a read from the cache, or read it and cache the answer
+template <int N>
+GoTacticResult GoTacticsT<N>::Read(GoPositionT<N>& target, int point, ReadKind kind)
+{
+    reads += 1;
+    Stone player = target.CurrentPlayer();
+    if (target.AtPoint(point) != (kind == READ_CAPTURE ? Opponent(player) : player))
+        return TACTIC_FAILS;
+
+    position = &target;
+    CacheEntry& entry = cache[kind][target.ChainHead(point)];
+    if (entry.valid && entry.player == player && entry.koPoint == target.KoPoint() && IsCached(entry))
+    {
+        cacheHits += 1;
+        return entry.result;
+    }
+
+    if (++markSerial == 0)
+    {
+        for (int i = 0; i < POINTS; ++i)
+            marks[i] = 0;
+        markSerial = 1;
+    }
+    region.clear();
+    readNodes = 0;
+    limited = false;
+    bool works = kind == READ_CAPTURE ? Capture(point, 0) : Escape(point, 0);
+    GoTacticResult result = limited ? TACTIC_UNKNOWN : works ? TACTIC_WORKS : TACTIC_FAILS;
+
+    // The position is back where it started, so the region is recorded as
+    // it stood before the read
+    if (regionPool.size() + region.size() > MAX_REGION_POOL)
+        ClearCache();
+    entry.valid = true;
+    entry.player = player;
+    entry.koPoint = target.KoPoint();
+    entry.regionStart = (int)regionPool.size();
+    entry.regionSize = (int)region.size();
+    entry.result = result;
+    for (short p : region)
+        regionPool.push_back(RegionPoint{ p, target.AtPoint(p) });
+    return result;
+}
+
+template <int N>
+bool GoTacticsT<N>::IsCached(const CacheEntry& entry) const
+{
+    for (int i = 0; i < entry.regionSize; ++i)
+    {
+        const RegionPoint& saved = regionPool[entry.regionStart + i];
+        if (position->AtPoint(saved.point) != saved.stone)
+            return false;
+    }
+    return true;
+}
+
+// Function to read whether the player to move captures the chain on point:
+// at once with one liberty, with two by an atari the owner cannot escape
+template <int N>
+bool GoTacticsT<N>::Capture(int point, int depth)
+{
+    if (OutOfBudget(depth))
+        return false;
+    int liberties[3];
+    int count = Liberties(point, liberties, 3);
+    if (count == 1)
+    {
+        if (!Play(liberties[0]))
+            return false;
+        position->Undo();
+        return true;
+    }
+    if (count != 2)
+        return false;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        if (!Play(liberties[i]))
+            continue;
+        bool works = !Escape(point, depth + 1);
+        position->Undo();
+        if (works)
+            return true;
+    }
+    return false;
+}
+
+// Function to read whether the owner of the chain on point, to move, keeps
+// it: it escapes with three liberties, or with two that cannot be laddered
+template <int N>
+bool GoTacticsT<N>::Escape(int point, int depth)
+{
+    if (OutOfBudget(depth))
+        return true;
+    int liberties[2];
+    if (Liberties(point, liberties, 2) >= 2)
+        return true;
+
+    // Capturing a neighbour in atari, then extending
+    if (++chainSerial == 0)
+    {
+        for (int i = 0; i < POINTS; ++i)
+            chainMarks[i] = 0;
+        chainSerial = 1;
+    }
+    int moves[MAX_ESCAPE_MOVES];
+    int moveCount = 0;
+    Stone opponent = Opponent(position->AtPoint(point));
+    int stone = point;
+    do
+    {
+        for (int offset : GoGeometry<N>::NEIGHBOR_OFFSETS)
+        {
+            int adj = stone + offset;
+            if (position->AtPoint(adj) != opponent || chainMarks[position->ChainHead(adj)] == chainSerial)
+                continue;
+            chainMarks[position->ChainHead(adj)] = chainSerial;
+            int captures[2];
+            if (Liberties(adj, captures, 2) != 1)
+                continue;
+            if (moveCount < MAX_ESCAPE_MOVES - 1)
+                moves[moveCount++] = captures[0];
+            else
+                limited = true;
+        }
+        stone = position->NextStone(stone);
+    } while (stone != point);
+    moves[moveCount++] = liberties[0];
+
+    for (int i = 0; i < moveCount; ++i)
+    {
+        if (!Play(moves[i]))
+            continue;
+        int after[3];
+        int count = Liberties(point, after, 3);
+        bool safe = count >= 3 || (count == 2 && !Capture(point, depth + 1));
+        position->Undo();
+        if (safe)
+            return true;
+    }
+    return false;
+}
+
+// Function to stop a line at the depth limit or a read at the move limit
+template <int N>
+bool GoTacticsT<N>::OutOfBudget(int depth)
+{
+    if (depth < maxDepth && readNodes < maxNodes)
+        return false;
+    limited = true;
+    return true;
+}
+
+// Function to try a move; its surroundings and the chains next to it decide
+// whether it is legal and what it captures, so they join the region
+template <int N>
+bool GoTacticsT<N>::Play(int move)
+{
+    AddPoint(move);
+    for (int offset : GoGeometry<N>::NEIGHBOR_OFFSETS)
+    {
+        int adj = move + offset;
+        Stone stone = position->AtPoint(adj);
+        if (stone == BLACK || stone == WHITE)
+            AddChain(adj);
+        else
+            AddPoint(adj);
+    }
+    if (!position->TryPlay(move))
+        return false;
+    readNodes += 1;
+    nodes += 1;
+    return true;
+}
+
+template <int N>
+int GoTacticsT<N>::Liberties(int point, int* liberties, int max)
+{
+    AddChain(point);
+    return position->ChainLibertyPoints(point, liberties, max);
+}
+
+// Function to add a chain's stones and the points around them to the region
+template <int N>
+void GoTacticsT<N>::AddChain(int point)
+{
+    int stone = point;
+    do
+    {
+        AddPoint(stone);
+        for (int offset : GoGeometry<N>::NEIGHBOR_OFFSETS)
+            AddPoint(stone + offset);
+        stone = position->NextStone(stone);
+    } while (stone != point);
+}
+
+template <int N>
+void GoTacticsT<N>::AddPoint(int point)
+{
+    if (marks[point] != markSerial)
+    {
+        marks[point] = markSerial;
+        region.push_back((short)point);
+    }
+}
+
+template class GoTacticsT<9>;
+template class GoTacticsT<13>;
+template class GoTacticsT<19>;
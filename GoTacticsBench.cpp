@@ -0,0 +1,164 @@
+// GoTacticsBench.cpp : Tactical reader benchmark and cache check.
+//
+// Usage: GoTacticsBench [-size n] [-games g] [-seed s]
+//
+// First reads a textbook ladder on the 19x19 board, with and without a
+// ladder breaker in its path, and prints the answers and the time per
+// read. Then plays g random games (20 by default) on an n x n board (19
+// by default) and, after every move, reads every chain with one or two
+// liberties: escapes for the player to move, captures for the opponent's.
+// Each read is made twice, by a reader that starts afresh every time and
+// by one that keeps its cache over the whole game, and the benchmark
+// reports the time per read of each, the share answered from the cache
+// and the number of answers that differ, which must be 0.
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "GoRandom.h"
+#include "GoTactics.h"
+
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const char* ResultName(GoTacticResult result)
+{
+    return result == TACTIC_WORKS ? "works" : result == TACTIC_FAILS ? "fails" : "unknown";
+}
+
+// Function to put a stone of either color on the board
+template <int N>
+static void PutStone(GoPositionT<N>& position, int x, int y, Stone stone)
+{
+    if (position.CurrentPlayer() != stone)
+        position.TogglePlayer();
+    position.PlaceStone(x, y);
+}
+
+// Function to read the ladder on a lone White stone near the top left
+// corner, Black to move, which runs down to the bottom right, and time the
+// read without the cache
+static void ReadLadder(bool breaker)
+{
+    GoPositionT<19> position;
+    PutStone(position, 2, 1, BLACK);
+    PutStone(position, 3, 1, BLACK);
+    PutStone(position, 1, 2, BLACK);
+    PutStone(position, 2, 2, WHITE);
+    if (breaker)
+        PutStone(position, 15, 15, WHITE);
+    if (position.CurrentPlayer() != BLACK)
+        position.TogglePlayer();
+
+    GoTactics tactics;
+    int target = GoPosition::Point(2, 2);
+    GoTacticResult result = tactics.ReadCapture(position, target);
+    const int repeats = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i)
+    {
+        tactics.ClearCache();
+        tactics.ReadCapture(position, target);
+    }
+    double seconds = SecondsSince(start);
+    std::printf("%-24s %-8s %8.2f us %6lld moves per read\n", breaker ? "ladder with breaker" : "ladder",
+        ResultName(result), 1e6 * seconds / repeats, tactics.Nodes() / (repeats + 1));
+}
+
+struct GameTotals
+{
+    long long reads;
+    long long unknown;
+    long long differing;
+    double freshSeconds;
+    double cachedSeconds;
+    long long cacheHits;
+};
+
+// Function to play random games and read every short-of-liberties chain
+template <int N>
+static GameTotals ReadGames(int games, uint64_t seed)
+{
+    GameTotals totals = GameTotals();
+    GoRandom random(seed);
+    GoTacticsT<N> fresh;
+    for (int game = 0; game < games; ++game)
+    {
+        GoPositionT<N> position(KO_SIMPLE);
+        GoTacticsT<N> cached;
+        for (int move = 0; move < 3 * N * N && !position.IsGameOver(); ++move)
+        {
+            GoMoveListT<N> moves;
+            position.GenerateLegalMoves(moves, true);
+            if (moves.count == 0)
+                position.Pass();
+            else
+                position.TryPlay(moves.moves[random.Below(moves.count)]);
+
+            Stone player = position.CurrentPlayer();
+            for (int point = 0; point < GoGeometry<N>::POINTS; ++point)
+            {
+                Stone stone = position.AtPoint(point);
+                int liberties[3];
+                if ((stone != BLACK && stone != WHITE) || position.ChainHead(point) != point ||
+                    position.ChainLibertyPoints(point, liberties, 3) > 2)
+                    continue;
+                bool own = stone == player;
+
+                auto start = std::chrono::steady_clock::now();
+                fresh.ClearCache();
+                GoTacticResult expected = own ? fresh.ReadEscape(position, point) : fresh.ReadCapture(position, point);
+                totals.freshSeconds += SecondsSince(start);
+
+                start = std::chrono::steady_clock::now();
+                GoTacticResult result = own ? cached.ReadEscape(position, point) : cached.ReadCapture(position, point);
+                totals.cachedSeconds += SecondsSince(start);
+
+                totals.reads += 1;
+                totals.unknown += expected == TACTIC_UNKNOWN;
+                totals.differing += result != expected;
+            }
+        }
+        totals.cacheHits += cached.CacheHits();
+    }
+    return totals;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = 19;
+    int games = 20;
+    uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-size") == 0)
+            size = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-games") == 0)
+            games = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-seed") == 0)
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    if ((size != 9 && size != 13 && size != 19) || games < 1)
+    {
+        std::fprintf(stderr, "usage: GoTacticsBench [-size 9|13|19] [-games g] [-seed s]\n");
+        return 2;
+    }
+
+    ReadLadder(false);
+    ReadLadder(true);
+
+    GameTotals totals = size == 9 ? ReadGames<9>(games, seed) :
+        size == 13 ? ReadGames<13>(games, seed) : ReadGames<19>(games, seed);
+    long long reads = totals.reads > 0 ? totals.reads : 1;
+    std::printf("%d random games of %dx%d, %lld reads\n", games, size, size, totals.reads);
+    std::printf("%-24s %10.2f us\n", "fresh read", 1e6 * totals.freshSeconds / reads);
+    std::printf("%-24s %10.2f us\n", "cached read", 1e6 * totals.cachedSeconds / reads);
+    std::printf("%-24s %10.1f%%\n", "answered from cache", 100.0 * totals.cacheHits / reads);
+    std::printf("%-24s %10lld\n", "unknown", totals.unknown);
+    std::printf("%-24s %10lld\n", "answers differing", totals.differing);
+    return totals.differing == 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+// GoTransBench.cpp : Transposition table benchmark.
+//
+// Usage: GoTransBench [-size n] [-seconds s] [-moves k] [-threads t] [-mb m] [-shared name]
+//
+// First measures raw table operations per second, a lookup and an add
+// per operation on random keys, on the given number of threads. Then it
+// plays the first k moves of a game (9x9 and 20 moves by default) with a
+// fresh search for each move and s seconds per search, three times over:
+// without a table, with an empty one and with the one the second pass
+// filled. For each pass it reports playouts per second and the table's
+// hit and collision rates. With -shared the table is the named shared
+// memory segment; run several at once, or one after another, to see
+// processes reuse each other's results. The segment is not removed.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "GoRandom.h"
+#include "GoSearch.h"
+#include "GoTransTable.h"
+
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to hammer the table from several threads
+static void RunTableOperations(GoTransTable& table, int threadCount)
+{
+    const int operations = 2000000;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&table, t]() {
+            GoRandom random(1000 + t);
+            GoTransEntry entry;
+            for (int i = 0; i < operations; ++i)
+            {
+                uint64_t key = random.Next();
+                table.Lookup(key, entry);
+                table.Add(key, 1, 8);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = SecondsSince(start);
+    std::printf("table: %zu slots, %s; %.1f M lookups and adds per second on %d threads\n", table.SlotCount(),
+        table.IsShared() ? "shared" : "in process", threadCount * (double)operations / seconds / 1e6,
+        threadCount);
+}
+
+// Function to play the moves of a game, searching each position afresh;
+// moves is filled on the first call and replayed after that
+template <int N>
+static void RunGame(GoTransTable* table, std::vector<int>& moves, int moveCount, double seconds, int threads,
+    const char* label)
+{
+    GoSearchOptions options;
+    options.threads = threads;
+    options.treeMemory = 64 << 20;
+    GoPositionT<N> position;
+    long long playouts = 0;
+    double searchSeconds = 0;
+    if (table)
+        table->ResetStats();
+
+    for (int i = 0; i < moveCount && !position.IsGameOver(); ++i)
+    {
+        GoSearchT<N> search(options);
+        search.SetTranspositionTable(table);
+        search.SetPosition(position);
+        GoSearchLimits limits;
+        limits.seconds = seconds;
+        int best = search.Search(limits);
+        playouts += search.LastPlayouts();
+        searchSeconds += search.LastSeconds();
+
+        if ((int)moves.size() <= i)
+            moves.push_back(best);
+        if (moves[i] == PASS_MOVE)
+            position.Pass();
+        else
+            position.TryPlay(moves[i]);
+    }
+
+    std::printf("%-14s %12.0f", label, playouts / searchSeconds);
+    if (table)
+    {
+        GoTransStats stats = table->Stats();
+        std::printf(" %9.1f%% %9.2f%% %10.1f%%", 100 * stats.HitRate(), 100 * stats.CollisionRate(),
+            stats.stores ? 100.0 * stats.evictions / stats.stores : 0.0);
+    }
+    std::printf("\n");
+}
+
+template <int N>
+static void RunGames(GoTransTable& table, int moveCount, double seconds, int threads)
+{
+    std::printf("%dx%d, %d moves, %.2f s per move\n", N, N, moveCount, seconds);
+    std::printf("%-14s %12s %10s %10s %11s\n", "table", "playouts/sec", "hits", "collisions", "evictions");
+    std::vector<int> moves;
+    RunGame<N>(nullptr, moves, moveCount, seconds, threads, "none");
+    RunGame<N>(&table, moves, moveCount, seconds, threads, "first pass");
+    RunGame<N>(&table, moves, moveCount, seconds, threads, "second pass");
+}
+
+int main(int argc, char* argv[])
+{
+    int size = 9;
+    double seconds = 0.25;
+    int moveCount = 20;
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    int megabytes = 64;
+    const char* sharedName = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-size") == 0)
+            size = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-seconds") == 0)
+            seconds = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-moves") == 0)
+            moveCount = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "-threads") == 0)
+            threads = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "-mb") == 0)
+            megabytes = std::max(1, std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "-shared") == 0)
+            sharedName = argv[i + 1];
+    }
+    if (seconds <= 0 || (size != 9 && size != 13 && size != 19))
+    {
+        std::fprintf(stderr, "usage: GoTransBench [-size 9|13|19] [-seconds s] [-moves k] [-threads t] [-mb m] "
+            "[-shared name]\n");
+        return 2;
+    }
+
+    // Raw operations run on a scratch table, so a shared one only ever
+    // holds search results
+    GoTransTable scratch;
+    scratch.Create((std::size_t)megabytes << 20);
+    RunTableOperations(scratch, threads);
+    scratch.Close();
+
+    GoTransTable table;
+    std::size_t bytes = (std::size_t)megabytes << 20;
+    if (sharedName ? !table.OpenShared(sharedName, bytes) : !table.Create(bytes))
+    {
+        std::fprintf(stderr, "cannot set up the table\n");
+        return 1;
+    }
+    if (size == 9)
+        RunGames<9>(table, moveCount, seconds, threads);
+    else if (size == 13)
+        RunGames<13>(table, moveCount, seconds, threads);
+    else
+        RunGames<19>(table, moveCount, seconds, threads);
+    return 0;
+}
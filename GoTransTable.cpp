@@ -0,0 +1,290 @@
+// GoTransTable.cpp : Implements the transposition table.
+//
+#include "GoTransTable.h"
+
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Shared segment layout: a 64-byte header (magic, version), then the
+// buckets. The bucket count follows from the segment size.
+static const char TABLE_MAGIC[4] = { 'G', 'O', 'T', 'T' };
+static const uint32_t TABLE_VERSION = 1;
+static const std::size_t TABLE_HEADER_SIZE = 64;
+
+// More visits than this halve a slot's counts, keeping its win rate
+static const uint32_t MAX_SLOT_VISITS = 1u << 27;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared slots need lock-free 64-bit atomics");
+
+// Function to give the largest power-of-two bucket count that fits
+static std::size_t BucketsFitting(std::size_t bytes)
+{
+    std::size_t count = 0;
+    while ((count ? 2 * count : 1) * 64 <= bytes)
+        count = count ? 2 * count : 1;
+    return count;
+}
+
+GoTransTable::GoTransTable()
+    : buckets(nullptr), bucketCount(0), shared(false), mapping(nullptr), mappedBytes(0),
+#ifdef _WIN32
+      handle(nullptr),
+#endif
+      lookups(0), hits(0), collisions(0), stores(0), evictions(0)
+{
+}
+
+GoTransTable::~GoTransTable()
+{
+    Close();
+}
+
+bool GoTransTable::Create(std::size_t bytes)
+{
+    Close();
+    std::size_t count = BucketsFitting(bytes);
+    if (count == 0)
+        return false;
+    buckets = new Bucket[count]();
+    bucketCount = count;
+    return true;
+}
+
+// Function to check or write the header of a mapped segment and use its
+// buckets
+bool GoTransTable::Attach(void* view, std::size_t bytes)
+{
+    char* header = static_cast<char*>(view);
+    std::size_t count = bytes > TABLE_HEADER_SIZE ? BucketsFitting(bytes - TABLE_HEADER_SIZE) : 0;
+    if (count == 0)
+        return false;
+
+    // Every process writes the same header, so a race to write it is
+    // harmless
+    uint32_t version;
+    std::memcpy(&version, header + 4, 4);
+    if (std::memcmp(header, TABLE_MAGIC, 4) != 0)
+    {
+        std::memcpy(header + 4, &TABLE_VERSION, 4);
+        std::memcpy(header, TABLE_MAGIC, 4);
+    }
+    else if (version != TABLE_VERSION)
+    {
+        return false;
+    }
+    buckets = reinterpret_cast<Bucket*>(header + TABLE_HEADER_SIZE);
+    bucketCount = count;
+    return true;
+}
+
+#ifdef _WIN32
+
+bool GoTransTable::OpenShared(const char* name, std::size_t bytes)
+{
+    Close();
+    uint64_t size = TABLE_HEADER_SIZE + BucketsFitting(bytes) * sizeof(Bucket);
+    handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size,
+        name);
+    mapping = handle ? MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0) : nullptr;
+    MEMORY_BASIC_INFORMATION info;
+    if (mapping == nullptr || VirtualQuery(mapping, &info, sizeof(info)) == 0 ||
+        !Attach(mapping, info.RegionSize))
+    {
+        Close();
+        return false;
+    }
+    mappedBytes = info.RegionSize;
+    shared = true;
+    return true;
+}
+
+bool GoTransTable::RemoveShared(const char*)
+{
+    return true; // the mapping is deleted with its last handle
+}
+
+void GoTransTable::Close()
+{
+    if (shared)
+    {
+        if (mapping)
+            UnmapViewOfFile(mapping);
+        if (handle)
+            CloseHandle(handle);
+    }
+    else
+    {
+        delete[] buckets;
+    }
+    buckets = nullptr;
+    bucketCount = 0;
+    shared = false;
+    mapping = nullptr;
+    mappedBytes = 0;
+    handle = nullptr;
+}
+
+#else
+
+// Function to turn a segment name into the "/name" form shm_open wants
+static std::string SegmentName(const char* name)
+{
+    return name[0] == '/' ? std::string(name) : "/" + std::string(name);
+}
+
+bool GoTransTable::OpenShared(const char* name, std::size_t bytes)
+{
+    Close();
+    int fd = shm_open(SegmentName(name).c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd < 0)
+        return false;
+
+    // A new segment is empty; the first process to see that sets its size
+    struct stat info;
+    off_t size = (off_t)(TABLE_HEADER_SIZE + BucketsFitting(bytes) * sizeof(Bucket));
+    bool sized = fstat(fd, &info) == 0 && (info.st_size > 0 || ftruncate(fd, size) == 0) && fstat(fd, &info) == 0;
+    void* view = sized ? mmap(nullptr, (std::size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return false;
+    if (!Attach(view, (std::size_t)info.st_size))
+    {
+        munmap(view, (std::size_t)info.st_size);
+        buckets = nullptr;
+        bucketCount = 0;
+        return false;
+    }
+    mapping = view;
+    mappedBytes = (std::size_t)info.st_size;
+    shared = true;
+    return true;
+}
+
+bool GoTransTable::RemoveShared(const char* name)
+{
+    return shm_unlink(SegmentName(name).c_str()) == 0;
+}
+
+void GoTransTable::Close()
+{
+    if (shared)
+        munmap(mapping, mappedBytes);
+    else
+        delete[] buckets;
+    buckets = nullptr;
+    bucketCount = 0;
+    shared = false;
+    mapping = nullptr;
+    mappedBytes = 0;
+}
+
+#endif
+
+bool GoTransTable::Lookup(uint64_t key, GoTransEntry& entry)
+{
+    lookups.fetch_add(1, std::memory_order_relaxed);
+    Bucket& bucket = buckets[key & (bucketCount - 1)];
+    int occupied = 0;
+    for (Slot& slot : bucket.slots)
+    {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if (data == 0)
+            continue;
+        if ((check ^ data) == key)
+        {
+            entry.visits = (uint32_t)data;
+            entry.wins = (uint32_t)(data >> 32);
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        ++occupied;
+    }
+    if (occupied == BUCKET_SLOTS)
+        collisions.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void GoTransTable::Add(uint64_t key, uint32_t visits, uint32_t wins)
+{
+    stores.fetch_add(1, std::memory_order_relaxed);
+    Bucket& bucket = buckets[key & (bucketCount - 1)];
+
+    // The slot already holding the position, or else the least visited
+    Slot* target = nullptr;
+    uint32_t fewest = UINT32_MAX;
+    uint64_t old = 0;
+    for (Slot& slot : bucket.slots)
+    {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if (data != 0 && (check ^ data) == key)
+        {
+            target = &slot;
+            old = data;
+            break;
+        }
+        if ((uint32_t)data < fewest)
+        {
+            fewest = (uint32_t)data;
+            target = &slot;
+        }
+    }
+    if (old == 0 && fewest > 0)
+        evictions.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t total = (uint64_t)(uint32_t)old + visits;
+    uint64_t totalWins = (old >> 32) + wins;
+    while (total > MAX_SLOT_VISITS)
+    {
+        total >>= 1;
+        totalWins >>= 1;
+    }
+    uint64_t data = total | (totalWins << 32);
+    if (data == 0)
+        return;
+    target->data.store(data, std::memory_order_relaxed);
+    target->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void GoTransTable::Clear()
+{
+    for (std::size_t i = 0; i < bucketCount; ++i)
+    {
+        for (Slot& slot : buckets[i].slots)
+        {
+            slot.data.store(0, std::memory_order_relaxed);
+            slot.check.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+GoTransStats GoTransTable::Stats() const
+{
+    GoTransStats stats;
+    stats.lookups = lookups.load();
+    stats.hits = hits.load();
+    stats.collisions = collisions.load();
+    stats.stores = stores.load();
+    stats.evictions = evictions.load();
+    return stats;
+}
+
+void GoTransTable::ResetStats()
+{
+    lookups.store(0);
+    hits.store(0);
+    collisions.store(0);
+    stores.store(0);
+    evictions.store(0);
+}
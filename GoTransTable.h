@@ -0,0 +1,120 @@
+// GoTransTable.h : Lock-free transposition table, optionally shared
+// between processes.
+//
+// The table maps Zobrist position hashes to search results: how many
+// playouts went through the position and how many of them, in
+// GoNode::WIN_UNITS, the player who moved into it won. Search threads add
+// every result they back up and look positions up when they first reach
+// them, so a position met again through another move order, in a later
+// search or in another process starts from what is already known.
+//
+// Slots are 16 bytes, two 64-bit words written with plain atomic stores:
+// the data word and the key XORed with the data word. A reader loads both
+// and accepts the slot only if their XOR gives its key, so a slot torn by
+// two writers racing reads as a miss instead of as wrong data, without any
+// lock. Two writers adding to the same slot at the same time may lose one
+// addition. Four slots make a 64-byte bucket on one cache line; a new
+// position takes the empty or least visited slot of its bucket.
+//
+// The table lives either in process memory (Create) or in a named shared
+// memory segment (OpenShared: POSIX shm_open, or a named file mapping on
+// Windows) that several engine processes on one machine map at once. A
+// segment persists until RemoveShared; a zeroed segment is an empty table,
+// so whichever process comes first needs no setup. On Windows a segment
+// goes away with the last process that has it open.
+//
+// The counters of Stats() are this process's own.
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Results stored for a position
+struct GoTransEntry
+{
+    uint32_t visits;
+    uint32_t wins;      // in GoNode::WIN_UNITS, for the player who moved into the position
+};
+
+struct GoTransStats
+{
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t collisions = 0;    // missed lookups whose bucket was full of other positions
+    uint64_t stores = 0;
+    uint64_t evictions = 0;     // stores that displaced another position
+
+    double HitRate() const { return lookups ? (double)hits / lookups : 0; }
+    double CollisionRate() const { return lookups ? (double)collisions / lookups : 0; }
+};
+
+class GoTransTable
+{
+public:
+    GoTransTable();
+    ~GoTransTable();
+
+    GoTransTable(const GoTransTable&) = delete;
+    GoTransTable& operator=(const GoTransTable&) = delete;
+
+    // Allocate an empty table of at most bytes in this process
+    bool Create(std::size_t bytes);
+
+    // Map the shared segment of the given name, creating it with at most
+    // bytes if it does not exist; an existing segment keeps its size
+    bool OpenShared(const char* name, std::size_t bytes);
+
+    // Delete a shared segment; processes that have it mapped keep it
+    static bool RemoveShared(const char* name);
+
+    void Close();
+
+    bool IsOpen() const { return buckets != nullptr; }
+    bool IsShared() const { return shared; }
+    std::size_t SlotCount() const { return bucketCount * BUCKET_SLOTS; }
+
+    // Results for a position; false if it is not in the table
+    bool Lookup(uint64_t key, GoTransEntry& entry);
+
+    // Add results for a position
+    void Add(uint64_t key, uint32_t visits, uint32_t wins);
+
+    // Empty every slot, for every process sharing the table
+    void Clear();
+
+    GoTransStats Stats() const;
+    void ResetStats();
+
+private:
+    static const int BUCKET_SLOTS = 4;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> check;    // key ^ data
+        std::atomic<uint64_t> data;     // visits, then wins in the upper half; 0 when empty
+    };
+
+    struct alignas(64) Bucket
+    {
+        Slot slots[BUCKET_SLOTS];
+    };
+
+    bool Attach(void* view, std::size_t bytes);
+
+    Bucket* buckets;
+    std::size_t bucketCount;
+    bool shared;
+    void* mapping;
+    std::size_t mappedBytes;
+#ifdef _WIN32
+    void* handle;
+#endif
+
+    std::atomic<uint64_t> lookups;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> collisions;
+    std::atomic<uint64_t> stores;
+    std::atomic<uint64_t> evictions;
+};
@@ -0,0 +1,96 @@
+// GoTypes.h : Board geometry and basic types shared by the rules engines.
+//
+// Every board-dependent class is a template over the board size N and is
+// compiled for the sizes listed in GO_BOARD_SIZES, so each size gets its
+// own constant-folded layout and small boards never pay for 19x19 arrays.
+// The 19x19 instantiations keep their plain names (GoPosition, GoBitboard,
+// ...); code that picks the size at runtime goes through GoGame.
+//
+#pragma once
+
+// Largest supported board; tables shared by all sizes (such as the
+// Zobrist keys) are sized for it
+const int MAX_BOARD_SIZE = 19;
+const int MAX_BOARD_POINTS = (MAX_BOARD_SIZE + 2) * (MAX_BOARD_SIZE + 2);
+
+// Board sizes the templates are instantiated for
+const int GO_BOARD_SIZES[] = { 9, 13, 19 };
+
+// Enum for stone colors; OFFBOARD marks the border points
+enum Stone : unsigned char { EMPTY, BLACK, WHITE, OFFBOARD };
+
+// Function to get the opposing color
+inline Stone Opponent(Stone player)
+{
+    return (player == BLACK) ? WHITE : BLACK;
+}
+
+// Move value for a pass; point 0 is a border point and never a real move
+const int PASS_MOVE = 0;
+
+// Layout of an N x N board. It is stored with a one-point border so
+// neighbours never need bounds checks: point (x, y) lives at
+// (y + 1) * STRIDE + (x + 1).
+template <int N>
+struct GoGeometry
+{
+    static constexpr int SIZE = N;
+    static constexpr int STRIDE = N + 2;
+    static constexpr int POINTS = STRIDE * STRIDE;
+
+    // Offsets of the four neighbours and the four diagonals of a point
+    static constexpr int NEIGHBOR_OFFSETS[4] = { -1, 1, -STRIDE, STRIDE };
+    static constexpr int DIAGONAL_OFFSETS[4] = { -STRIDE - 1, -STRIDE + 1, STRIDE - 1, STRIDE + 1 };
+
+    // Point index of column x, row y
+    static constexpr int Point(int x, int y) { return (y + 1) * STRIDE + (x + 1); }
+    static constexpr int PointX(int point) { return point % STRIDE - 1; }
+    static constexpr int PointY(int point) { return point / STRIDE - 1; }
+
+    // Star points: the 4-4 points (3-3 below 13x13) and the centre, plus
+    // the side points on 19x19
+    static constexpr int HOSHI_COUNT = N >= 19 ? 9 : 5;
+    static constexpr int HoshiPoint(int i)
+    {
+        return HOSHI_COUNT == 9 ? Point(HoshiLine(i % 3), HoshiLine(i / 3))
+            : i < 4 ? Point(HoshiLine((i & 1) * 2), HoshiLine((i >> 1) * 2)) : Point(N / 2, N / 2);
+    }
+
+private:
+    // The three star lines, given as 0, 1 or 2 (2 is the far side)
+    static constexpr int HoshiLine(int k)
+    {
+        return k == 0 ? (N >= 13 ? 3 : 2) : k == 1 ? N / 2 : N - 1 - (N >= 13 ? 3 : 2);
+    }
+};
+
+// Fixed-capacity list of moves: every point plus a pass, never allocates
+template <int N>
+struct GoMoveListT
+{
+    int count;
+    int moves[N * N + 1];
+
+    GoMoveListT() : count(0) {}
+    void Add(int move) { moves[count++] = move; }
+};
+
+typedef GoMoveListT<19> GoMoveList;
+
+// Repetition rules. Simple ko only forbids retaking a single stone at
+// once; positional superko forbids recreating any earlier arrangement of
+// stones, situational superko any earlier arrangement with the same
+// player to move.
+enum KoRule { KO_SIMPLE, KO_POSITIONAL_SUPERKO, KO_SITUATIONAL_SUPERKO };
+
+// 3x3 pattern codes (see GoPattern.h). Bits 0-15 hold the Stone value of
+// each of the eight points around a point, two bits each: the four
+// neighbours in NEIGHBOR_OFFSETS order, then the four diagonals in
+// DIAGONAL_OFFSETS order. Bits 16-19 flag the neighbours whose chain is in
+// atari, in NEIGHBOR_OFFSETS order.
+const int PATTERN_ATARI_SHIFT = 16;
+const int PATTERN_CODES = 1 << 20;
+
+// Outcome of checking a move; everything but MOVE_LEGAL is a reason the
+// move may not be played
+enum GoMoveStatus { MOVE_LEGAL, MOVE_OCCUPIED, MOVE_SUICIDE, MOVE_KO, MOVE_SUPERKO };
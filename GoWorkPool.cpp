@@ -0,0 +1,115 @@
+// GoWorkPool.cpp : Implements the work-stealing thread pool.
+//
+#include "GoWorkPool.h"
+
+#include <algorithm>
+
+// Worker index of the calling thread, -1 outside any pool
+static thread_local int currentWorker = -1;
+static thread_local const GoWorkPool* currentPool = nullptr;
+
+GoWorkPool::GoWorkPool(int threads)
+    : nextWorker(0), steals(0), queued(0), unfinished(0), stopping(false)
+{
+    int count = threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency());
+    for (int i = 0; i < count; ++i)
+        workers.emplace_back(new Worker());
+    for (int i = 0; i < count; ++i)
+        this->threads.emplace_back(&GoWorkPool::Run, this, i);
+}
+
+GoWorkPool::~GoWorkPool()
+{
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobQueued.notify_all();
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+void GoWorkPool::Submit(Job job)
+{
+    bool inside = currentPool == this;
+    int index = inside ? currentWorker : (int)(nextWorker.fetch_add(1) % workers.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued += 1;
+        unfinished += 1;
+    }
+    {
+        Worker& worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (inside)
+            worker.jobs.push_front(std::move(job));
+        else
+            worker.jobs.push_back(std::move(job));
+    }
+    jobQueued.notify_one();
+}
+
+void GoWorkPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this]() { return unfinished == 0; });
+}
+
+// Function to take a job from the worker's own queue or, failing that,
+// from the back of another worker's queue
+bool GoWorkPool::TakeJob(int index, Job& job)
+{
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = std::move(own.jobs.front());
+            own.jobs.pop_front();
+            return true;
+        }
+    }
+    int count = (int)workers.size();
+    for (int i = 1; i < count; ++i)
+    {
+        Worker& victim = *workers[(index + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = std::move(victim.jobs.back());
+            victim.jobs.pop_back();
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void GoWorkPool::Run(int index)
+{
+    currentWorker = index;
+    currentPool = this;
+    for (;;)
+    {
+        {
+            // Sleep until some queue has a job that nobody has taken yet
+            std::unique_lock<std::mutex> lock(mutex);
+            jobQueued.wait(lock, [this]() { return queued > 0 || stopping; });
+            if (queued == 0)
+                return;
+            queued -= 1;
+        }
+
+        // The job counted above is in some queue until it is taken, and
+        // only a thread that counted it may take it, so this finds one
+        Job job;
+        while (!TakeJob(index, job))
+            std::this_thread::yield();
+        job(index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--unfinished == 0)
+            allDone.notify_all();
+    }
+}
@@ -0,0 +1,76 @@
+// GoWorkPool.h : Work-stealing thread pool for independent jobs.
+//
+// Every worker thread has its own queue of jobs. Jobs submitted from
+// outside the pool are dealt out over the queues in turn; a job submitted
+// by a running job goes to the front of its own worker's queue. A worker
+// takes its next job from the front of its own queue and, once that is
+// empty, steals from the back of the others, so jobs of very different
+// lengths (short and long games, say) still keep every thread busy until
+// the last one is done. The queues have their own locks, so workers only
+// contend for a queue when one of them steals. The counts of queued and
+// unfinished jobs, which threads sleep and wake on, share one pool-wide
+// lock, taken once when a job is submitted, started and finished, so jobs
+// should be long enough (a game, a batch of playouts) for that to be
+// negligible.
+//
+// A job gets the index of the worker running it, 0 to ThreadCount() - 1,
+// for per-thread scratch state.
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GoWorkPool
+{
+public:
+    // Zero threads means one per hardware core
+    explicit GoWorkPool(int threads = 0);
+
+    // Waits for the queued jobs, then stops the threads
+    ~GoWorkPool();
+
+    GoWorkPool(const GoWorkPool&) = delete;
+    GoWorkPool& operator=(const GoWorkPool&) = delete;
+
+    typedef std::function<void(int worker)> Job;
+    void Submit(Job job);
+
+    // Block until every job submitted so far has finished
+    void Wait();
+
+    int ThreadCount() const { return (int)workers.size(); }
+
+    // Jobs taken from another worker's queue, for tuning
+    long long Steals() const { return steals.load(); }
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void Run(int index);
+    bool TakeJob(int index, Job& job);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<unsigned> nextWorker;
+    std::atomic<long long> steals;
+
+    // Sleeping and waiting: queued counts jobs in the queues, unfinished
+    // jobs queued or running
+    std::mutex mutex;
+    std::condition_variable jobQueued;
+    std::condition_variable allDone;
+    long long queued;
+    long long unfinished;
+    bool stopping;
+};
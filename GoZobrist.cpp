@@ -0,0 +1,116 @@
+// GoZobrist.cpp : Implements the superko position history.
+//
+#include "GoZobrist.h"
+
+#include <cstddef>
+
+void GoHashHistory::Clear()
+{
+    for (uint64_t& slot : slots)
+        slot = 0;
+    count = 0;
+    hasZero = false;
+}
+
+bool GoHashHistory::Contains(uint64_t hash) const
+{
+    if (hash == 0)
+        return hasZero;
+    if (slots.empty())
+        return false;
+
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t i = hash & mask; slots[i] != 0; i = (i + 1) & mask)
+        if (slots[i] == hash)
+            return true;
+    return false;
+}
+
+bool GoHashHistory::Insert(uint64_t hash)
+{
+    if (hash == 0)
+    {
+        bool inserted = !hasZero;
+        hasZero = true;
+        return inserted;
+    }
+    if (2 * (count + 1) > (int)slots.size())
+        Grow();
+
+    std::size_t mask = slots.size() - 1;
+    std::size_t i = hash & mask;
+    for (; slots[i] != 0; i = (i + 1) & mask)
+        if (slots[i] == hash)
+            return false;
+    slots[i] = hash;
+    count += 1;
+    return true;
+}
+
+void GoHashHistory::Remove(uint64_t hash)
+{
+    if (hash == 0)
+    {
+        hasZero = false;
+        return;
+    }
+    if (slots.empty())
+        return;
+
+    std::size_t mask = slots.size() - 1;
+    std::size_t i = hash & mask;
+    while (slots[i] != hash)
+    {
+        if (slots[i] == 0)
+            return;
+        i = (i + 1) & mask;
+    }
+
+    // Shift later entries of the probe run back into the hole so that
+    // lookups never stop early at it
+    std::size_t hole = i;
+    for (std::size_t j = (hole + 1) & mask; slots[j] != 0; j = (j + 1) & mask)
+    {
+        std::size_t home = slots[j] & mask;
+        bool movable = (hole <= j) ? (home <= hole || home > j) : (home <= hole && home > j);
+        if (movable)
+        {
+            slots[hole] = slots[j];
+            hole = j;
+        }
+    }
+    slots[hole] = 0;
+    count -= 1;
+}
+
+void GoHashHistory::Reserve(int more)
+{
+    while (2 * (count + more) > (int)slots.size())
+        Grow();
+}
+
+void GoHashHistory::Assign(const GoHashHistory& other)
+{
+    slots = other.slots;
+    count = other.count;
+    hasZero = other.hasZero;
+}
+
+// Function to double the table and re-insert every hash
+void GoHashHistory::Grow()
+{
+    spare.swap(slots);
+    slots.assign(spare.empty() ? 512 : spare.size() * 2, 0);
+
+    std::size_t mask = slots.size() - 1;
+    for (uint64_t hash : spare)
+    {
+        if (hash == 0)
+            continue;
+        std::size_t i = hash & mask;
+        while (slots[i] != 0)
+            i = (i + 1) & mask;
+        slots[i] = hash;
+    }
+    spare.clear();
+}
@@ -0,0 +1,88 @@
+// GoZobrist.h : Zobrist keys and the position history used for superko.
+//
+// A position's hash is the XOR of one key per stone (by colour and point)
+// and, when White is to move, the side-to-move key. Playing, capturing and
+// passing change it with a few XORs. The keys are generated at compile
+// time from a fixed seed, so hashes are identical across runs, processes
+// and machines and can be stored in files.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GoTypes.h"
+
+struct GoZobristKeys
+{
+    uint64_t stone[2][MAX_BOARD_POINTS]; // indexed by [player == WHITE][point]
+    uint64_t whiteToMove;
+};
+
+// SplitMix64 step, used only to fill the key table
+constexpr uint64_t NextZobristKey(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr GoZobristKeys MakeZobristKeys()
+{
+    GoZobristKeys keys{};
+    uint64_t state = 0x476F47616D65ull; // "GoGame"
+    for (int color = 0; color < 2; ++color)
+        for (int point = 0; point < MAX_BOARD_POINTS; ++point)
+            keys.stone[color][point] = NextZobristKey(state);
+    keys.whiteToMove = NextZobristKey(state);
+    return keys;
+}
+
+inline constexpr GoZobristKeys ZOBRIST = MakeZobristKeys();
+
+// Key of a stone of the given colour on the given point
+inline uint64_t ZobristStone(Stone player, int point)
+{
+    return ZOBRIST.stone[player == WHITE][point];
+}
+
+// Compact set of position hashes seen so far in a game: open addressing
+// with linear probing in a power-of-two table kept at most half full.
+// Lookups and inserts are O(1) and never compare boards.
+class GoHashHistory
+{
+public:
+    GoHashHistory() : count(0), hasZero(false) {}
+
+    void Clear();
+    bool Contains(uint64_t hash) const;
+
+    // Returns false if the hash was already present
+    bool Insert(uint64_t hash);
+
+    // Remove a hash again, e.g. when a move is taken back
+    void Remove(uint64_t hash);
+
+    int Size() const { return count + (hasZero ? 1 : 0); }
+
+    // Make room for this many more hashes, so that inserting them never
+    // reallocates
+    void Reserve(int more);
+
+    // Copy other's hashes into this table, reusing its memory
+    void Assign(const GoHashHistory& other);
+
+private:
+    void Grow();
+
+    // Zero marks a free slot; the zero hash itself (the empty board) is
+    // tracked by hasZero
+    std::vector<uint64_t> slots;
+    int count;
+
+    // Buffer the old table is rehashed from when growing; kept so that a
+    // history which is reused (see Assign) stops allocating
+    std::vector<uint64_t> spare;
+    bool hasZero;
+};
@@ -2,45 +2,64 @@
 //
 #include <windows.h>
 #include <windowsx.h>  // Include this header for GET_X_LPARAM and GET_Y_LPARAM
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <vector>
-#include <stack>
 #include <string>
 #include <sstream>
+#include <thread>
+
+#include "GoGame.h"
+#include "GoInfluence.h"
+#include "GoMetrics.h"
+#include "GoRenderer.h"
 
 // Window dimensions
 const int WINDOW_WIDTH = 1000;  // Increased width to accommodate side panel
 const int WINDOW_HEIGHT = 800;
 
-// Go board dimensions
-const int BOARD_SIZE = 19;
+// Go board layout
 int CELL_SIZE; // Will be calculated based on window size
 int OFFSET;    // Will be calculated based on window size
 
 // Side panel dimensions
 const int SIDE_PANEL_WIDTH = 250;
 
-// Enum for stone colors
-enum Stone { EMPTY, BLACK, WHITE };
-
-// 2D array to represent the board
-Stone board[BOARD_SIZE][BOARD_SIZE];
-
-// Current player
-Stone currentPlayer = BLACK;
-
-// Player scores
-int blackScore = 0;
-int whiteScore = 0;
-
-// Flags to track consecutive passes
-int consecutivePasses = 0;
-
-// Star points coordinates (0-based indexing)
-const std::vector<std::pair<int, int>> starPoints = {
-    {3, 3}, {3, 9}, {3, 15},
-    {9, 3}, {9, 9}, {9, 15},
-    {15, 3}, {15, 9}, {15, 15}
-};
+// The game being played; all rules live in the engine. Its size is
+// picked in the side panel.
+std::unique_ptr<GoGame> game = CreateGoGame(19);
+
+// Off-screen frame of the board; repaints copy from it, and moves redraw
+// only the cells they change
+GoBoardRenderer boardRenderer;
+
+// Board sizes offered, in the order of the combo box entries
+const int BOARD_SIZE_CHOICES[] = { 9, 13, 19 };
+
+// Opening books for the sizes above, read from book9.gobook, book13.gobook
+// and book19.gobook next to the program if they exist (see GoDb book). The
+// computer plays from them before it starts searching.
+GoBook openingBooks[3];
+
+// Points White receives for moving second
+const double KOMI = 7.5;
+
+// Influence map and score estimate of the board, brought up to date on a
+// worker thread after every change, which posts WM_INFLUENCE_READY. Empty
+// points are shaded one level per INFLUENCE_PER_SHADE of influence. The
+// shading is taken off while the final result is shown.
+GoInfluenceWorker influenceWorker(KOMI);
+const int INFLUENCE_PER_SHADE = 3;
+bool showingResult = false;
+
+// The game's computer player plays White. It searches on a worker thread,
+// which posts WM_COMPUTER_MOVE when done. Setting stopComputer ends the
+// search early, even if the thread has not started searching yet.
+std::thread computerThread;
+std::atomic<bool> stopComputer(false);
+bool computerThinking = false;
+const double COMPUTER_SECONDS_PER_MOVE = 2.0;
 
 // Control IDs
 #define IDC_CURRENT_PLAYER_LABEL 101
@@ -52,25 +71,45 @@ const std::vector<std::pair<int, int>> starPoints = {
 #define IDC_WHITE_SCORE_TEXT     107
 #define IDC_PASS_BUTTON          108
 #define IDC_RESIGN_BUTTON        109
+#define IDC_UNDO_BUTTON          110
+#define IDC_COMPUTER_WHITE_CHECK 111
+#define IDC_BOARD_SIZE_LABEL     112
+#define IDC_BOARD_SIZE_COMBO     113
+#define IDC_METRICS_TEXT         114
+#define IDC_ESTIMATE_TEXT        115
+
+// Refreshes the metrics panel, in builds with GO_METRICS
+#define IDT_METRICS_TIMER        1
+const UINT METRICS_REFRESH_MS = 500;
+
+// Posted by the search thread; wParam is the chosen move
+#define WM_COMPUTER_MOVE (WM_APP + 1)
+
+// Posted by the influence worker when a new map is ready
+#define WM_INFLUENCE_READY (WM_APP + 2)
 
 // Forward declarations
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
-void DrawBoard(HDC hdc, HWND hwnd);
-void DrawStones(HDC hdc);
-bool PlaceStone(int x, int y);
-bool IsValidMove(int x, int y);
-bool RemoveCapturedStones(int x, int y, Stone player);
-int CountLiberties(int x, int y, Stone player, bool visited[BOARD_SIZE][BOARD_SIZE]);
-void TogglePlayer();
+void DrawBoard(HDC hdc, const RECT& area);
+void RefreshBoard(HWND hwnd);
+void RepaintBoard(HWND hwnd);
+void ShowInfluence(HWND hwnd);
 void UpdateDimensions(int width, int height);
-void UpdateScore();
 void UpdateCurrentPlayerText(HWND hwnd);
 void UpdateScoreTexts(HWND hwnd);
 void EndGame(HWND hwnd);
 void PassTurn(HWND hwnd);
 void ResignGame(HWND hwnd);
+void UndoMove(HWND hwnd);
 void CreateUIControls(HWND hwnd);
 void ResetGame(HWND hwnd);
+void StartComputerMove(HWND hwnd);
+void PlayComputerMove(HWND hwnd, int move);
+void StopComputer();
+void ChangeBoardSize(HWND hwnd);
+void LoadOpeningBooks();
+void UseOpeningBook();
+void UpdateMetricsText(HWND hwnd);
 
 // Entry point
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
@@ -95,7 +134,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         0,                              // Optional window styles.
         CLASS_NAME,                     // Window class
         L"Go Game",                     // Window text
-        WS_OVERLAPPEDWINDOW,            // Window style
+        WS_OVERLAPPEDWINDOW | WS_CLIPCHILDREN, // Window style
 
         // Size and position
         CW_USEDEFAULT, CW_USEDEFAULT, WINDOW_WIDTH, WINDOW_HEIGHT,
@@ -113,6 +152,9 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 
     ShowWindow(hwnd, nCmdShow);
 
+    LoadOpeningBooks();
+    UseOpeningBook();
+
     // Initialize the board to EMPTY
     ResetGame(hwnd);
 
@@ -129,14 +171,8 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 // Function to reset the game board and scores
 void ResetGame(HWND hwnd)
 {
-    for (int i = 0; i < BOARD_SIZE; ++i)
-        for (int j = 0; j < BOARD_SIZE; ++j)
-            board[i][j] = EMPTY;
-
-    currentPlayer = BLACK;
-    blackScore = 0;
-    whiteScore = 0;
-    consecutivePasses = 0;
+    game->Reset();
+    influenceWorker.Submit(*game);
 
     UpdateCurrentPlayerText(hwnd);
     UpdateScoreTexts(hwnd);
@@ -151,6 +187,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
     {
         // Create UI Controls on the side panel
         CreateUIControls(hwnd);
+
+        // New influence maps are shown on this thread
+        influenceWorker.SetReadyCallback([hwnd]() { PostMessage(hwnd, WM_INFLUENCE_READY, 0, 0); });
     }
     return 0;
 
@@ -161,56 +200,85 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         int width = rect.right - rect.left;
         int height = rect.bottom - rect.top;
         UpdateDimensions(width, height);
+        boardRenderer.SetLayout(*game, width, height, CELL_SIZE, OFFSET);
+        boardRenderer.TakeDirtyRect();
 
         // Reposition UI controls based on new window size
         // Current Player Label
         HWND hLabelCurrent = GetDlgItem(hwnd, IDC_CURRENT_PLAYER_LABEL);
-        SetWindowPos(hLabelCurrent, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 20, 50, 100, 20, SWP_NOZORDER);
+        SetWindowPos(hLabelCurrent, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 50, 100, 20, SWP_NOZORDER);
 
         // Current Player Text
         HWND hTextCurrent = GetDlgItem(hwnd, IDC_CURRENT_PLAYER_TEXT);
-        SetWindowPos(hTextCurrent, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 130, 50, 100, 20, SWP_NOZORDER);
+        SetWindowPos(hTextCurrent, NULL, OFFSET + game->Size() * CELL_SIZE + 130, 50, 100, 20, SWP_NOZORDER);
 
         // Pass Button
         HWND hPassButton = GetDlgItem(hwnd, IDC_PASS_BUTTON);
-        SetWindowPos(hPassButton, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 20, 80, 100, 30, SWP_NOZORDER);
+        SetWindowPos(hPassButton, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 80, 100, 30, SWP_NOZORDER);
 
         // Resign Button
         HWND hResignButton = GetDlgItem(hwnd, IDC_RESIGN_BUTTON);
-        SetWindowPos(hResignButton, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 130, 80, 100, 30, SWP_NOZORDER);
+        SetWindowPos(hResignButton, NULL, OFFSET + game->Size() * CELL_SIZE + 130, 80, 100, 30, SWP_NOZORDER);
 
         // Scores Label
         HWND hLabelScores = GetDlgItem(hwnd, IDC_SCORES_LABEL);
-        SetWindowPos(hLabelScores, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 20, 130, 100, 20, SWP_NOZORDER);
+        SetWindowPos(hLabelScores, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 130, 100, 20, SWP_NOZORDER);
+
+        // Estimate Text
+        HWND hTextEstimate = GetDlgItem(hwnd, IDC_ESTIMATE_TEXT);
+        SetWindowPos(hTextEstimate, NULL, OFFSET + game->Size() * CELL_SIZE + 130, 130, 100, 20, SWP_NOZORDER);
 
         // Black Score Label
         HWND hLabelBlack = GetDlgItem(hwnd, IDC_BLACK_SCORE_LABEL);
-        SetWindowPos(hLabelBlack, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 20, 160, 100, 20, SWP_NOZORDER);
+        SetWindowPos(hLabelBlack, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 160, 100, 20, SWP_NOZORDER);
 
         // Black Score Text
         HWND hTextBlack = GetDlgItem(hwnd, IDC_BLACK_SCORE_TEXT);
-        SetWindowPos(hTextBlack, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 130, 160, 100, 20, SWP_NOZORDER);
+        SetWindowPos(hTextBlack, NULL, OFFSET + game->Size() * CELL_SIZE + 130, 160, 100, 20, SWP_NOZORDER);
 
         // White Score Label
         HWND hLabelWhite = GetDlgItem(hwnd, IDC_WHITE_SCORE_LABEL);
-        SetWindowPos(hLabelWhite, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 20, 190, 100, 20, SWP_NOZORDER);
+        SetWindowPos(hLabelWhite, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 190, 100, 20, SWP_NOZORDER);
 
         // White Score Text
         HWND hTextWhite = GetDlgItem(hwnd, IDC_WHITE_SCORE_TEXT);
-        SetWindowPos(hTextWhite, NULL, OFFSET + BOARD_SIZE * CELL_SIZE + 130, 190, 100, 20, SWP_NOZORDER);
+        SetWindowPos(hTextWhite, NULL, OFFSET + game->Size() * CELL_SIZE + 130, 190, 100, 20, SWP_NOZORDER);
 
-        InvalidateRect(hwnd, NULL, TRUE); // Redraw the board on resize
+        // Undo Button
+        HWND hUndoButton = GetDlgItem(hwnd, IDC_UNDO_BUTTON);
+        SetWindowPos(hUndoButton, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 230, 100, 30, SWP_NOZORDER);
+
+        // Computer Player Checkbox
+        HWND hComputerCheck = GetDlgItem(hwnd, IDC_COMPUTER_WHITE_CHECK);
+        SetWindowPos(hComputerCheck, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 270, 210, 20, SWP_NOZORDER);
+
+        // Board Size Label
+        HWND hLabelSize = GetDlgItem(hwnd, IDC_BOARD_SIZE_LABEL);
+        SetWindowPos(hLabelSize, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 305, 100, 20, SWP_NOZORDER);
+
+        // Board Size Combo Box
+        HWND hComboSize = GetDlgItem(hwnd, IDC_BOARD_SIZE_COMBO);
+        SetWindowPos(hComboSize, NULL, OFFSET + game->Size() * CELL_SIZE + 130, 300, 100, 100, SWP_NOZORDER);
+
+        // Metrics Text
+        HWND hTextMetrics = GetDlgItem(hwnd, IDC_METRICS_TEXT);
+        if (hTextMetrics)
+            SetWindowPos(hTextMetrics, NULL, OFFSET + game->Size() * CELL_SIZE + 20, 340, 230, 400, SWP_NOZORDER);
+
+        InvalidateRect(hwnd, NULL, FALSE); // Show the new layout
     }
     return 0;
 
+    case WM_ERASEBKGND:
+        return 1; // The board frame covers the whole client area
+
     case WM_PAINT:
     {
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
 
-        // Draw the board and stones
-        DrawBoard(hdc, hwnd);
-        DrawStones(hdc);
+        // Copy the board and stones from the frame
+        DrawBoard(hdc, ps.rcPaint);
 
         EndPaint(hwnd, &ps);
     }
@@ -218,8 +286,8 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 
     case WM_LBUTTONDOWN:
     {
-        if (consecutivePasses >= 2) {
-            // Game already ended, ignore clicks
+        if (game->IsGameOver() || computerThinking) {
+            // Game already ended or the computer is to move, ignore clicks
             return 0;
         }
 
@@ -230,32 +298,49 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         int col = (xPos - OFFSET + CELL_SIZE / 2) / CELL_SIZE;
         int row = (yPos - OFFSET + CELL_SIZE / 2) / CELL_SIZE;
 
-        if (col >= 0 && col < BOARD_SIZE && row >= 0 && row < BOARD_SIZE)
+        if (col >= 0 && col < game->Size() && row >= 0 && row < game->Size())
         {
-            if (IsValidMove(col, row))
+            // PlaceStone checks and plays the move in one pass
+            if (game->PlaceStone(col, row))
             {
-                if (PlaceStone(col, row))
-                {
-                    InvalidateRect(hwnd, NULL, TRUE);
-                    consecutivePasses = 0; // Reset pass count after a valid move
-                    UpdateCurrentPlayerText(hwnd);
-                    UpdateScoreTexts(hwnd);
-                }
+                RefreshBoard(hwnd);
+                UpdateCurrentPlayerText(hwnd);
+                UpdateScoreTexts(hwnd);
             }
             else
             {
                 // Invalid move: lose turn
                 MessageBox(hwnd, L"Invalid move! Turn skipped.", L"Invalid Move", MB_OK | MB_ICONWARNING);
-                TogglePlayer();
-                InvalidateRect(hwnd, NULL, TRUE);
+                game->TogglePlayer();
+                RefreshBoard(hwnd);
                 UpdateCurrentPlayerText(hwnd);
             }
+            StartComputerMove(hwnd);
         }
     }
     return 0;
 
+    case WM_COMPUTER_MOVE:
+        PlayComputerMove(hwnd, (int)wParam);
+        return 0;
+
+    case WM_INFLUENCE_READY:
+        ShowInfluence(hwnd);
+        return 0;
+
+    case WM_TIMER:
+        if (wParam == IDT_METRICS_TIMER)
+            UpdateMetricsText(hwnd);
+        return 0;
+
     case WM_COMMAND:
     {
+        if (computerThinking)
+        {
+            // Wait for the computer's move
+            return 0;
+        }
+
         switch (LOWORD(wParam))
         {
         case IDC_PASS_BUTTON: // Pass
@@ -264,11 +349,24 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         case IDC_RESIGN_BUTTON: // Resign
             ResignGame(hwnd);
             break;
+        case IDC_UNDO_BUTTON: // Take back
+            UndoMove(hwnd);
+            break;
+        case IDC_COMPUTER_WHITE_CHECK: // Computer plays White
+            StartComputerMove(hwnd);
+            break;
+        case IDC_BOARD_SIZE_COMBO: // New game on another board size
+            if (HIWORD(wParam) == CBN_SELCHANGE)
+                ChangeBoardSize(hwnd);
+            break;
         }
     }
     return 0;
 
     case WM_DESTROY:
+        KillTimer(hwnd, IDT_METRICS_TIMER);
+        StopComputer();
+        influenceWorker.SetReadyCallback(nullptr);
         PostQuitMessage(0);
         return 0;
 
@@ -284,7 +382,7 @@ void CreateUIControls(HWND hwnd)
         L"STATIC",  // Predefined class; Unicode assumed 
         L"Current Player:",      // Text 
         WS_VISIBLE | WS_CHILD,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 20,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
         50,         // y position 
         100,        // Label width
         20,        // Label height
@@ -298,7 +396,7 @@ void CreateUIControls(HWND hwnd)
         L"STATIC",  // Predefined class; Unicode assumed 
         L"Black",      // Initial text 
         WS_VISIBLE | WS_CHILD,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 130,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 130,         // x position 
         50,         // y position 
         100,        // Text width
         20,        // Text height
@@ -312,7 +410,7 @@ void CreateUIControls(HWND hwnd)
         L"BUTTON",  // Predefined class; Unicode assumed 
         L"Pass",      // Button text 
         WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_DEFPUSHBUTTON,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 20,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
         80,         // y position 
         100,        // Button width
         30,        // Button height
@@ -326,7 +424,7 @@ void CreateUIControls(HWND hwnd)
         L"BUTTON",  // Predefined class; Unicode assumed 
         L"Resign",      // Button text 
         WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_DEFPUSHBUTTON,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 130,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 130,         // x position 
         80,         // y position 
         100,        // Button width
         30,        // Button height
@@ -340,7 +438,7 @@ void CreateUIControls(HWND hwnd)
         L"STATIC",  // Predefined class; Unicode assumed 
         L"Scores:",      // Text 
         WS_VISIBLE | WS_CHILD,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 20,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
         130,         // y position 
         100,        // Label width
         20,        // Label height
@@ -349,12 +447,26 @@ void CreateUIControls(HWND hwnd)
         (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
         NULL);      // Pointer not needed.
 
+    // Estimate Text: the influence map's score, updated after every move
+    CreateWindow(
+        L"STATIC",  // Predefined class; Unicode assumed 
+        L"",      // Filled in by UpdateScoreTexts 
+        WS_VISIBLE | WS_CHILD,  // Styles 
+        OFFSET + game->Size() * CELL_SIZE + 130,         // x position 
+        130,         // y position 
+        100,        // Text width
+        20,        // Text height
+        hwnd,     // Parent window
+        (HMENU)IDC_ESTIMATE_TEXT,       // Control ID
+        (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
+        NULL);      // Pointer not needed.
+
     // Black Score Label
     CreateWindow(
         L"STATIC",  // Predefined class; Unicode assumed 
         L"Black:",      // Text 
         WS_VISIBLE | WS_CHILD,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 20,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
         160,         // y position 
         100,        // Label width
         20,        // Label height
@@ -368,7 +480,7 @@ void CreateUIControls(HWND hwnd)
         L"STATIC",  // Predefined class; Unicode assumed 
         L"0",      // Initial score 
         WS_VISIBLE | WS_CHILD,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 130,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 130,         // x position 
         160,         // y position 
         100,        // Text width
         20,        // Text height
@@ -382,7 +494,7 @@ void CreateUIControls(HWND hwnd)
         L"STATIC",  // Predefined class; Unicode assumed 
         L"White:",      // Text 
         WS_VISIBLE | WS_CHILD,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 20,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
         190,         // y position 
         100,        // Label width
         20,        // Label height
@@ -396,7 +508,7 @@ void CreateUIControls(HWND hwnd)
         L"STATIC",  // Predefined class; Unicode assumed 
         L"0",      // Initial score 
         WS_VISIBLE | WS_CHILD,  // Styles 
-        OFFSET + BOARD_SIZE * CELL_SIZE + 130,         // x position 
+        OFFSET + game->Size() * CELL_SIZE + 130,         // x position 
         190,         // y position 
         100,        // Text width
         20,        // Text height
@@ -404,6 +516,114 @@ void CreateUIControls(HWND hwnd)
         (HMENU)IDC_WHITE_SCORE_TEXT,       // Control ID
         (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
         NULL);      // Pointer not needed.
+
+    // Undo Button
+    CreateWindow(
+        L"BUTTON",  // Predefined class; Unicode assumed 
+        L"Undo",      // Button text 
+        WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_DEFPUSHBUTTON,  // Styles 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
+        230,         // y position 
+        100,        // Button width
+        30,        // Button height
+        hwnd,     // Parent window
+        (HMENU)IDC_UNDO_BUTTON,       // Control ID
+        (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
+        NULL);      // Pointer not needed.
+
+    // Computer Player Checkbox
+    CreateWindow(
+        L"BUTTON",  // Predefined class; Unicode assumed 
+        L"Computer plays White",      // Checkbox text 
+        WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_AUTOCHECKBOX,  // Styles 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
+        270,         // y position 
+        210,        // Checkbox width
+        20,        // Checkbox height
+        hwnd,     // Parent window
+        (HMENU)IDC_COMPUTER_WHITE_CHECK,       // Control ID
+        (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
+        NULL);      // Pointer not needed.
+
+    // Board Size Label
+    CreateWindow(
+        L"STATIC",  // Predefined class; Unicode assumed 
+        L"Board size:",      // Text 
+        WS_VISIBLE | WS_CHILD,  // Styles 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
+        305,         // y position 
+        100,        // Label width
+        20,        // Label height
+        hwnd,     // Parent window
+        (HMENU)IDC_BOARD_SIZE_LABEL,       // Control ID
+        (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
+        NULL);      // Pointer not needed.
+
+    // Board Size Combo Box
+    HWND hComboSize = CreateWindow(
+        L"COMBOBOX",  // Predefined class; Unicode assumed 
+        L"",      // No text 
+        WS_TABSTOP | WS_VISIBLE | WS_CHILD | WS_VSCROLL | CBS_DROPDOWNLIST,  // Styles 
+        OFFSET + game->Size() * CELL_SIZE + 130,         // x position 
+        300,         // y position 
+        100,        // Combo box width
+        100,        // Height including the drop-down list
+        hwnd,     // Parent window
+        (HMENU)IDC_BOARD_SIZE_COMBO,       // Control ID
+        (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
+        NULL);      // Pointer not needed.
+
+    for (int size : BOARD_SIZE_CHOICES)
+    {
+        std::wstring text = std::to_wstring(size) + L" x " + std::to_wstring(size);
+        int index = (int)SendMessage(hComboSize, CB_ADDSTRING, 0, (LPARAM)text.c_str());
+        if (size == game->Size())
+            SendMessage(hComboSize, CB_SETCURSEL, index, 0);
+    }
+
+#ifdef GO_METRICS
+    // Metrics Text, refreshed while the engine works
+    HWND hTextMetrics = CreateWindow(
+        L"STATIC",  // Predefined class; Unicode assumed 
+        L"",      // Filled by the timer 
+        WS_VISIBLE | WS_CHILD | SS_LEFT,  // Styles 
+        OFFSET + game->Size() * CELL_SIZE + 20,         // x position 
+        340,         // y position 
+        230,        // Text width
+        400,        // Text height
+        hwnd,     // Parent window
+        (HMENU)IDC_METRICS_TEXT,       // Control ID
+        (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
+        NULL);      // Pointer not needed.
+    SendMessage(hTextMetrics, WM_SETFONT, (WPARAM)GetStockObject(ANSI_FIXED_FONT), FALSE);
+    SetTimer(hwnd, IDT_METRICS_TIMER, METRICS_REFRESH_MS, NULL);
+#endif
+}
+
+// Function to show the engine's counters and timings in the side panel
+void UpdateMetricsText(HWND hwnd)
+{
+    HWND hTextMetrics = GetDlgItem(hwnd, IDC_METRICS_TEXT);
+    if (hTextMetrics == NULL)
+        return;
+
+    // One line per counter or timer; the timer lines are split after the
+    // call count to fit the panel
+    std::string text = MetricsText(CollectMetrics());
+    std::wstring lines;
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\n')
+            lines += L"\r\n";
+        else if (text[i] == ',' && i + 1 < text.size() && text[i + 1] == ' ')
+        {
+            lines += L"\r\n   ";
+            ++i;
+        }
+        else
+            lines += (wchar_t)(unsigned char)text[i];
+    }
+    SetWindowText(hTextMetrics, lines.c_str());
 }
 
 // Function to update cell size and offset based on window size
@@ -412,105 +632,53 @@ void UpdateDimensions(int width, int height)
     // Calculate CELL_SIZE based on the smaller dimension
     int boardWidth = width - SIDE_PANEL_WIDTH - 40; // Allocate space for side panel with padding
     int size = (boardWidth < height - 40) ? boardWidth : (height - 40); // 40 for padding
-    CELL_SIZE = size / BOARD_SIZE;
+    CELL_SIZE = size / game->Size();
     OFFSET = 20; // Padding from the window edge
 }
 
-// Function to toggle the current player
-void TogglePlayer()
+// Function to copy part of the board frame to the window
+void DrawBoard(HDC hdc, const RECT& area)
 {
-    currentPlayer = (currentPlayer == BLACK) ? WHITE : BLACK;
+    if (boardRenderer.Width() == 0 || boardRenderer.Height() == 0)
+        return;
+
+    // The frame is a top-down 32-bit DIB as it is
+    BITMAPINFO info = {};
+    info.bmiHeader.biSize = sizeof(info.bmiHeader);
+    info.bmiHeader.biWidth = boardRenderer.Width();
+    info.bmiHeader.biHeight = -boardRenderer.Height();
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    int left = (std::max)((int)area.left, 0);
+    int top = (std::max)((int)area.top, 0);
+    int right = (std::min)((int)area.right, boardRenderer.Width());
+    int bottom = (std::min)((int)area.bottom, boardRenderer.Height());
+    if (right <= left || bottom <= top)
+        return;
+    SetDIBitsToDevice(hdc, left, top, right - left, bottom - top, left, top, 0, boardRenderer.Height(),
+        boardRenderer.Pixels(), &info, DIB_RGB_COLORS);
 }
 
-// Function to draw the Go board
-void DrawBoard(HDC hdc, HWND hwnd)
+// Function to bring the board frame up to date with the game, repaint
+// the cells that changed and have the influence map follow
+void RefreshBoard(HWND hwnd)
 {
-    // Draw background
-    RECT rect;
-    GetClientRect(hwnd, &rect);  // Use hwnd instead of GetDesktopWindow()
-    HBRUSH brush = CreateSolidBrush(RGB(240, 217, 181)); // Wood-like color
-    FillRect(hdc, &rect, brush);
-    DeleteObject(brush);
-
-    // Draw grid lines
-    HPEN hPen = CreatePen(PS_SOLID, 1, RGB(0, 0, 0));
-    HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
-
-    for (int i = 0; i < BOARD_SIZE; ++i)
-    {
-        // Horizontal lines
-        MoveToEx(hdc, OFFSET, OFFSET + i * CELL_SIZE, NULL);
-        LineTo(hdc, OFFSET + (BOARD_SIZE - 1) * CELL_SIZE, OFFSET + i * CELL_SIZE);
-
-        // Vertical lines
-        MoveToEx(hdc, OFFSET + i * CELL_SIZE, OFFSET, NULL);
-        LineTo(hdc, OFFSET + i * CELL_SIZE, OFFSET + (BOARD_SIZE - 1) * CELL_SIZE);
-    }
-
-    // Draw star points (hoshi)
-    for (const auto& point : starPoints)
-    {
-        int x = OFFSET + point.first * CELL_SIZE;
-        int y = OFFSET + point.second * CELL_SIZE;
-        int radius = 4; // Radius for the star point
-
-        // Draw filled circle
-        HBRUSH starBrush = CreateSolidBrush(RGB(0, 0, 0));
-        HBRUSH oldBrush = (HBRUSH)SelectObject(hdc, starBrush);
-        HPEN starPen = CreatePen(PS_SOLID, 1, RGB(0, 0, 0));
-        HPEN oldPen = (HPEN)SelectObject(hdc, starPen);
-
-        Ellipse(hdc, x - radius, y - radius, x + radius, y + radius);
-
-        // Restore old GDI objects
-        SelectObject(hdc, oldBrush);
-        SelectObject(hdc, oldPen);
-
-        // Clean up
-        DeleteObject(starBrush);
-        DeleteObject(starPen);
-    }
-
-    SelectObject(hdc, hOldPen);
-    DeleteObject(hPen);
+    influenceWorker.Submit(*game);
+    RepaintBoard(hwnd);
 }
 
-// Function to draw the stones
-void DrawStones(HDC hdc)
+// Function to redraw the cells of the frame that changed and have them
+// repainted
+void RepaintBoard(HWND hwnd)
 {
-    for (int i = 0; i < BOARD_SIZE; ++i)
-    {
-        for (int j = 0; j < BOARD_SIZE; ++j)
-        {
-            if (board[i][j] != EMPTY)
-            {
-                HBRUSH brush;
-                if (board[i][j] == BLACK)
-                    brush = CreateSolidBrush(RGB(0, 0, 0));
-                else
-                    brush = CreateSolidBrush(RGB(255, 255, 255));
-
-                // Create a black or white pen for the stone border
-                HPEN hPen = CreatePen(PS_SOLID, 1, RGB(0, 0, 0));
-                HPEN hOldPen = (HPEN)SelectObject(hdc, hPen);
-                HBRUSH hOldBrush = (HBRUSH)SelectObject(hdc, brush);
-
-                int x = OFFSET + i * CELL_SIZE;
-                int y = OFFSET + j * CELL_SIZE;
-                int radius = CELL_SIZE / 2 - 4;
-
-                Ellipse(hdc, x - radius, y - radius, x + radius, y + radius);
-
-                // Restore old GDI objects
-                SelectObject(hdc, hOldPen);
-                SelectObject(hdc, hOldBrush);
-
-                // Clean up
-                DeleteObject(hPen);
-                DeleteObject(brush);
-            }
-        }
-    }
+    boardRenderer.Update(*game);
+    GoRenderRect dirty = boardRenderer.TakeDirtyRect();
+    if (dirty.IsEmpty())
+        return;
+    RECT rect = { dirty.left, dirty.top, dirty.right, dirty.bottom };
+    InvalidateRect(hwnd, &rect, FALSE);
 }
 
 // Function to draw the score panel (removed as we are using static controls)
@@ -523,222 +691,87 @@ void DrawStones(HDC hdc)
 void UpdateCurrentPlayerText(HWND hwnd)
 {
     HWND hTextCurrent = GetDlgItem(hwnd, IDC_CURRENT_PLAYER_TEXT);
-    std::wstring playerText = (currentPlayer == BLACK) ? L"Black" : L"White";
+    std::wstring playerText = (game->CurrentPlayer() == BLACK) ? L"Black" : L"White";
     SetWindowText(hTextCurrent, playerText.c_str());
 }
 
-// Function to update the Score Texts
+// Function to update the Score Texts: captures, and the estimate of the
+// latest influence map if it is of this board
 void UpdateScoreTexts(HWND hwnd)
 {
     HWND hTextBlack = GetDlgItem(hwnd, IDC_BLACK_SCORE_TEXT);
     HWND hTextWhite = GetDlgItem(hwnd, IDC_WHITE_SCORE_TEXT);
+    HWND hTextEstimate = GetDlgItem(hwnd, IDC_ESTIMATE_TEXT);
 
-    std::wstring blackScoreStr = std::to_wstring(blackScore);
-    std::wstring whiteScoreStr = std::to_wstring(whiteScore);
+    std::wstring blackScoreStr = std::to_wstring(game->BlackScore());
+    std::wstring whiteScoreStr = std::to_wstring(game->WhiteScore());
 
     SetWindowText(hTextBlack, blackScoreStr.c_str());
     SetWindowText(hTextWhite, whiteScoreStr.c_str());
-}
-
-// Function to place a stone on the board
-bool PlaceStone(int x, int y)
-{
-    if (board[x][y] != EMPTY)
-        return false;
-
-    board[x][y] = currentPlayer;
-
-    // Check for captures
-    bool captured = false;
-    // Check all adjacent positions for opponent stones
-    std::vector<std::pair<int, int>> directions = { {-1,0}, {1,0}, {0,-1}, {0,1} };
-    for (auto& dir : directions)
-    {
-        int adjX = x + dir.first;
-        int adjY = y + dir.second;
-        if (adjX >= 0 && adjX < BOARD_SIZE && adjY >= 0 && adjY < BOARD_SIZE)
-        {
-            if (board[adjX][adjY] == ((currentPlayer == BLACK) ? WHITE : BLACK))
-            {
-                bool hasLiberty = false;
-                bool visited[BOARD_SIZE][BOARD_SIZE] = { false };
-                if (CountLiberties(adjX, adjY, board[adjX][adjY], visited) == 0)
-                {
-                    // Capture the stones
-                    RemoveCapturedStones(adjX, adjY, board[adjX][adjY]);
-                    captured = true;
-                }
-            }
-        }
-    }
 
-    // Check if the placed stone has any liberties
-    bool visited[BOARD_SIZE][BOARD_SIZE] = { false };
-    if (CountLiberties(x, y, currentPlayer, visited) == 0)
+    GoInfluenceMap map = influenceWorker.Latest();
+    std::wostringstream estimate;
+    if (map.size == game->Size())
     {
-        if (!captured) // Suicide move
-        {
-            board[x][y] = EMPTY; // Remove the stone
-            return false;
-        }
-    }
-
-    // TODO: Implement the Ko rule here if necessary
-
-    // Toggle to the next player
-    TogglePlayer();
-
-    return true;
-}
-
-// Function to check if a move is valid
-bool IsValidMove(int x, int y)
-{
-    if (board[x][y] != EMPTY)
-        return false;
-
-    // Temporarily place the stone
-    board[x][y] = currentPlayer;
-
-    // Check for suicide
-    bool suicide = false;
-    bool visited[BOARD_SIZE][BOARD_SIZE] = { false };
-    if (CountLiberties(x, y, currentPlayer, visited) == 0)
-    {
-        // Check if the move captures any opponent stones
-        bool captures = false;
-        std::vector<std::pair<int, int>> directions = { {-1,0}, {1,0}, {0,-1}, {0,1} };
-        for (auto& dir : directions)
-        {
-            int adjX = x + dir.first;
-            int adjY = y + dir.second;
-            if (adjX >= 0 && adjX < BOARD_SIZE && adjY >= 0 && adjY < BOARD_SIZE)
-            {
-                if (board[adjX][adjY] == ((currentPlayer == BLACK) ? WHITE : BLACK))
-                {
-                    bool hasLiberty = false;
-                    bool oppVisited[BOARD_SIZE][BOARD_SIZE] = { false };
-                    if (CountLiberties(adjX, adjY, board[adjX][adjY], oppVisited) == 0)
-                    {
-                        captures = true;
-                        break;
-                    }
-                }
-            }
-        }
-        if (!captures)
-            suicide = true;
-    }
-
-    // Remove the temporary stone
-    board[x][y] = EMPTY;
-
-    return !suicide;
-}
-
-// Function to remove captured stones
-bool RemoveCapturedStones(int x, int y, Stone player)
-{
-    bool removed = false;
-    std::stack<std::pair<int, int>> stonesToRemove;
-    std::stack<std::pair<int, int>> stack;
-    bool visited[BOARD_SIZE][BOARD_SIZE] = { false };
-
-    stack.push({ x, y });
-    visited[x][y] = true;
-
-    while (!stack.empty())
-    {
-        auto current = stack.top();
-        stack.pop();
-        stonesToRemove.push(current);
-
-        std::vector<std::pair<int, int>> directions = { {-1,0}, {1,0}, {0,-1}, {0,1} };
-        for (auto& dir : directions)
-        {
-            int adjX = current.first + dir.first;
-            int adjY = current.second + dir.second;
-            if (adjX >= 0 && adjX < BOARD_SIZE && adjY >= 0 && adjY < BOARD_SIZE)
-            {
-                if (board[adjX][adjY] == player && !visited[adjX][adjY])
-                {
-                    stack.push({ adjX, adjY });
-                    visited[adjX][adjY] = true;
-                }
-            }
-        }
-    }
-
-    // Remove all stones in stonesToRemove
-    while (!stonesToRemove.empty())
-    {
-        auto stone = stonesToRemove.top();
-        stonesToRemove.pop();
-        board[stone.first][stone.second] = EMPTY;
-        removed = true;
-
-        // Update score
-        if (player == BLACK)
-            whiteScore += 1;
+        double margin = map.score.Margin();
+        estimate << L"Est. ";
+        if (margin == 0)
+            estimate << L"even";
         else
-            blackScore += 1;
+            estimate << (margin > 0 ? L"B+" : L"W+") << std::abs(margin);
     }
-
-    return removed;
+    SetWindowText(hTextEstimate, estimate.str().c_str());
 }
 
-// Function to count liberties of a group
-int CountLiberties(int x, int y, Stone player, bool visited[BOARD_SIZE][BOARD_SIZE])
+// Function to shade the empty points by the latest influence map and show
+// its estimate
+void ShowInfluence(HWND hwnd)
 {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE)
-        return 0;
-    if (board[x][y] != player)
-        return 0;
-    if (visited[x][y])
-        return 0;
-
-    visited[x][y] = true;
+    GoInfluenceMap map = influenceWorker.Latest();
+    if (map.size != game->Size() || showingResult)
+        return;
 
-    int liberties = 0;
-    std::vector<std::pair<int, int>> directions = { {-1,0}, {1,0}, {0,-1}, {0,1} };
-    for (auto& dir : directions)
+    std::vector<int8_t> shading(map.influence.size());
+    for (std::size_t i = 0; i < shading.size(); ++i)
     {
-        int adjX = x + dir.first;
-        int adjY = y + dir.second;
-        if (adjX >= 0 && adjX < BOARD_SIZE && adjY >= 0 && adjY < BOARD_SIZE)
-        {
-            if (board[adjX][adjY] == EMPTY)
-                liberties += 1;
-            else if (board[adjX][adjY] == player && !visited[adjX][adjY])
-                liberties += CountLiberties(adjX, adjY, player, visited);
-        }
+        int level = map.influence[i] / INFLUENCE_PER_SHADE;
+        level = (std::max)(-GoBoardRenderer::SHADE_LEVELS, (std::min)(level, GoBoardRenderer::SHADE_LEVELS));
+        shading[i] = (int8_t)level;
     }
-    return liberties;
-}
-
-// Function to update the scores (simplified)
-void UpdateScore()
-{
-    // In a full implementation, this should calculate territory and subtract captured stones.
-    // Here, we keep track of captured stones during the game.
-
-    // Optionally, you can add additional scoring logic here.
+    boardRenderer.SetShading(shading);
+    RepaintBoard(hwnd);
+    UpdateScoreTexts(hwnd);
 }
 
 // Function to handle passing the turn
 void PassTurn(HWND hwnd)
 {
-    consecutivePasses += 1;
-    if (consecutivePasses >= 2)
+    game->Pass();
+    if (game->IsGameOver())
     {
         // End the game
         EndGame(hwnd);
     }
     else
     {
-        TogglePlayer();
-        InvalidateRect(hwnd, NULL, TRUE);
+        RefreshBoard(hwnd);
+        UpdateCurrentPlayerText(hwnd);
+        StartComputerMove(hwnd);
+    }
+}
+
+// Function to take back the last move, pass or skipped turn
+void UndoMove(HWND hwnd)
+{
+    if (game->Undo())
+    {
+        // Against the computer, take back its reply together with your move
+        if (IsDlgButtonChecked(hwnd, IDC_COMPUTER_WHITE_CHECK) == BST_CHECKED && game->CurrentPlayer() == WHITE)
+            game->Undo();
+
+        RefreshBoard(hwnd);
         UpdateCurrentPlayerText(hwnd);
+        UpdateScoreTexts(hwnd);
     }
 }
 
@@ -746,10 +779,10 @@ void PassTurn(HWND hwnd)
 void ResignGame(HWND hwnd)
 {
     std::wstring message = L"Player ";
-    message += (currentPlayer == BLACK) ? L"Black" : L"White";
+    message += (game->CurrentPlayer() == BLACK) ? L"Black" : L"White";
     message += L" has resigned.\n";
 
-    message += (currentPlayer == BLACK) ? L"White" : L"Black";
+    message += (game->CurrentPlayer() == BLACK) ? L"White" : L"Black";
     message += L" wins!";
 
     MessageBox(hwnd, message.c_str(), L"Game Over", MB_OK | MB_ICONINFORMATION);
@@ -759,26 +792,139 @@ void ResignGame(HWND hwnd)
 // Function to end the game
 void EndGame(HWND hwnd)
 {
-    // Final scoring (simplified)
-    UpdateScore();
-
-    // Determine the winner
-    std::wstring message = L"Final Scores:\n\n";
-    message += L"Black: " + std::to_wstring(blackScore) + L"\n";
-    message += L"White: " + std::to_wstring(whiteScore) + L"\n\n";
-
-    if (blackScore > whiteScore)
-        message += L"Black wins!";
-    else if (whiteScore > blackScore)
-        message += L"White wins!";
+    // Final scoring by area, with the stones that playouts from the final
+    // position capture taken off as dead; they stay on the board, faded,
+    // while the result is shown
+    GoOwnershipOptions options;
+    options.komi = KOMI;
+    GoOwnershipMap ownership = game->EstimateOwnership(options);
+    GoAreaScore score = ownership.score;
+    double margin = score.Margin();
+
+    showingResult = true;
+    boardRenderer.SetShading(std::vector<int8_t>());
+    boardRenderer.SetDeadStones(ownership.dead);
+    RepaintBoard(hwnd);
+    UpdateWindow(hwnd);
+
+    std::wostringstream message;
+    message << L"Final Scores:\n\n";
+    message << L"Black: " << score.blackArea << L"\n";
+    message << L"White: " << score.whiteArea << L" + " << KOMI << L" komi\n\n";
+    if (ownership.deadBlack > 0 || ownership.deadWhite > 0)
+    {
+        message << L"Dead stones removed: " << ownership.deadBlack << L" Black, " << ownership.deadWhite
+            << L" White\n\n";
+    }
+
+    if (margin > 0)
+        message << L"Black wins by " << margin << L"!";
+    else if (margin < 0)
+        message << L"White wins by " << -margin << L"!";
     else
-        message += L"It's a tie!";
+        message << L"It's a tie!";
 
-    MessageBox(hwnd, message.c_str(), L"Game Over", MB_OK | MB_ICONINFORMATION);
+    MessageBox(hwnd, message.str().c_str(), L"Game Over", MB_OK | MB_ICONINFORMATION);
 
     // Optionally, reset the game or close the application
     // Here, we'll reset the game
+    boardRenderer.SetDeadStones(std::vector<uint8_t>());
+    showingResult = false;
     ResetGame(hwnd);
-    InvalidateRect(hwnd, NULL, TRUE);
+    RefreshBoard(hwnd);
 }
 
+// Function to let the computer think about White's move on a worker
+// thread, if it plays White and it is White's turn
+void StartComputerMove(HWND hwnd)
+{
+    if (computerThinking || game->IsGameOver() || game->CurrentPlayer() != WHITE ||
+        IsDlgButtonChecked(hwnd, IDC_COMPUTER_WHITE_CHECK) != BST_CHECKED)
+        return;
+
+    GoSearchOptions options = game->SearchOptions();
+    options.threads = (int)std::thread::hardware_concurrency();
+    options.komi = KOMI;
+    game->SetSearchOptions(options);
+
+    computerThinking = true;
+    stopComputer.store(false);
+    computerThread = std::thread([hwnd]() {
+        GoSearchLimits limits;
+        limits.seconds = COMPUTER_SECONDS_PER_MOVE;
+        limits.stop = &stopComputer;
+        int move = game->BookMove();
+        if (move == PASS_MOVE)
+            move = game->SearchMove(limits);
+        PostMessage(hwnd, WM_COMPUTER_MOVE, (WPARAM)move, 0);
+    });
+}
+
+// Function to play the move the search thread has chosen
+void PlayComputerMove(HWND hwnd, int move)
+{
+    computerThread.join();
+    computerThinking = false;
+
+    if (move != PASS_MOVE && game->PlaceStone(game->PointX(move), game->PointY(move)))
+    {
+        RefreshBoard(hwnd);
+        UpdateCurrentPlayerText(hwnd);
+        UpdateScoreTexts(hwnd);
+    }
+    else
+    {
+        PassTurn(hwnd);
+    }
+}
+
+// Function to end a running search before the window goes away
+void StopComputer()
+{
+    if (computerThread.joinable())
+    {
+        stopComputer.store(true);
+        computerThread.join();
+    }
+    computerThinking = false;
+}
+
+// Function to start a new game on the size selected in the combo box
+void ChangeBoardSize(HWND hwnd)
+{
+    int index = (int)SendMessage(GetDlgItem(hwnd, IDC_BOARD_SIZE_COMBO), CB_GETCURSEL, 0, 0);
+    if (index < 0 || index >= (int)(sizeof(BOARD_SIZE_CHOICES) / sizeof(BOARD_SIZE_CHOICES[0])) ||
+        BOARD_SIZE_CHOICES[index] == game->Size())
+        return;
+
+    game = CreateGoGame(BOARD_SIZE_CHOICES[index]);
+    UseOpeningBook();
+    ResetGame(hwnd);
+
+    // Cells and side panel follow the new number of lines
+    SendMessage(hwnd, WM_SIZE, 0, 0);
+}
+
+// Function to open the opening books in the program's folder
+void LoadOpeningBooks()
+{
+    char path[MAX_PATH];
+    DWORD length = GetModuleFileNameA(NULL, path, MAX_PATH);
+    std::string folder(path, length);
+    folder.erase(folder.find_last_of("\\/") + 1);
+    for (int i = 0; i < 3; ++i)
+    {
+        std::string name = folder + "book" + std::to_string(BOARD_SIZE_CHOICES[i]) + ".gobook";
+        openingBooks[i].Open(name.c_str());
+    }
+}
+
+// Function to give the game the book of its size, if there is one
+void UseOpeningBook()
+{
+    for (const GoBook& book : openingBooks)
+    {
+        if (book.IsOpen() && book.Size() == game->Size())
+            game->SetOpeningBook(&book);
+    }
+}